@@ -17,9 +17,14 @@ AsynchFileWriter::AsynchFileWriter() //(t_object * maxObject) //: Timer(maxObjec
 	timerIntervalMilliseconds_ = 0; // invalid
 
 	writeBuffer_ = NULL;
+	writeBufferSize_ = 0;
+	dataBufferRequestedSize_ = 0;
 	fileWriter_ = NULL;
+	chunkCrcSizeBytes_ = 0;
 
 	writeIdxUnwrappedFrames_ = 0;
+	numItemsWritten_ = 0;
+	resetStats();
 }
 
 AsynchFileWriter::~AsynchFileWriter()
@@ -37,16 +42,32 @@ AsynchFileWriter::~AsynchFileWriter()
 
 // avgProductionConsumptionRate in items per second (average production rate and consumption rate are assumed to be equal)
 // peakProductionMaximum is maximum peak production per consumption interval, use 0 if not known or if there aren't any production peaks
+// if the sizes are the same as the previous call, the buffers are kept (emptied) rather than reallocated
+// (must not be called while disk writing, see isDiskWriting())
 void AsynchFileWriter::allocate(int consumptionIntervalMilliseconds, double avgProductionConsumptionRate, double toleranceFactor, int peakProductionMaximum)
 {
 	assert(fileWriter_ != NULL);
 
+	const int writeBufferSize = concat::ceil_int(toleranceFactor*avgProductionConsumptionRate*consumptionIntervalMilliseconds/1000.0);
+	const int dataBufferSize = std::max(writeBufferSize, peakProductionMaximum);
+	timerIntervalMilliseconds_ = consumptionIntervalMilliseconds;
+
+	if (writeBuffer_ != NULL && writeBufferSize == writeBufferSize_ && dataBufferSize == dataBufferRequestedSize_)
+	{
+		dataBuffer_.clearBySettingReadIdxToWriteIdx();
+		eventBuffer_.clearBySettingReadIdxToWriteIdx();
+		writeIdxUnwrappedFrames_ = 0;
+		resetStats();
+		return;
+	}
+
 	delete[] writeBuffer_;
 	writeBuffer_ = NULL;
 
-	writeBufferSize_ = concat::ceil_int(toleranceFactor*avgProductionConsumptionRate*consumptionIntervalMilliseconds/1000.0);
-	dataBuffer_.reserve(std::max(writeBufferSize_, peakProductionMaximum));
-	writeBuffer_ = new float[writeBufferSize_]; // <= dataBuffer_.capacity()
+	writeBufferSize_ = writeBufferSize;
+	dataBufferRequestedSize_ = dataBufferSize;
+	dataBuffer_.reserveMirrored(dataBufferSize);
+	writeBuffer_ = new float[writeBufferSize_]; // <= dataBuffer_.capacity() (only used if not mirrored)
 
 	eventBuffer_.reserve(2);
 	// Note:
@@ -54,7 +75,8 @@ void AsynchFileWriter::allocate(int consumptionIntervalMilliseconds, double avgP
 	// pending start-pending stop, not pending stop-pending start.
 	// See postStartDiskWriteEvent().
 
-	timerIntervalMilliseconds_ = consumptionIntervalMilliseconds;
+	writeIdxUnwrappedFrames_ = 0;
+	resetStats();
 }
 
 // ---------------------------------------------------------------------------------------
@@ -93,7 +115,17 @@ int AsynchFileWriter::writeData(const float *data, int sizeItems)
 	const int result = dataBuffer_.put(data, sizeItems);
 
 	if (result != sizeItems)
+	{
+		++numOverflows_;
+		numItemsDropped_ += sizeItems - result;
 		LOG_ERROR_N("asynch_file_writer", concat::formatStr("[r]ERROR: Data buffer underrun (%d samples).", sizeItems - result));
+	}
+
+	// (before the dummy read below, while not disk writing the buffer only holds what was 
+	// just put)
+	const LONG readAvail = dataBuffer_.getReadAvail();
+	if (readAvail > highWaterItems_)
+		highWaterItems_ = readAvail;
 
 	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 	// Do dummy read to empty buffer in case not writing to disk but only keeping history:
@@ -240,17 +272,66 @@ void AsynchFileWriter::timerCallback()
 	// Do disk writing if recording:
 	if (isConsumerDiskWriting_.isSet())
 	{
-		const int toWrite = dataBuffer_.get(writeBuffer_, writeBufferSize_);
+		if (!fileWriter_->isOpen())
+		{
+			if (dataBuffer_.get(writeBuffer_, writeBufferSize_) > 0)
+				LOG_ERROR_N("asynch_file_writer", "[r]ERROR: No file open to write to.");
+		}
+		else
+		{
+			writeDataFromBufferToFile(writeBufferSize_);
+		}
+	}
+//END_IGNORE_EXCEPTIONS("AsynchFileWriter::timerCallback()")
+}
 
-		if (toWrite > 0)
+int AsynchFileWriter::drain()
+{
+	int numItemsWritten = 0;
+
+	// (a start event may be followed by a stop event, the data between both belongs to the 
+	// recording the start event opens, see timerCallback())
+	do
+	{
+		handleFirstOfPendingEvents();
+
+		if (isConsumerDiskWriting_.isSet())
 		{
 			if (!fileWriter_->isOpen())
-				LOG_ERROR_N("asynch_file_writer", "[r]ERROR: No file open to write to.");
+			{
+				if (dataBuffer_.get(writeBuffer_, writeBufferSize_) > 0)
+					LOG_ERROR_N("asynch_file_writer", "[r]ERROR: No file open to write to.");
+			}
 			else
-				fileWriter_->writeItems(writeBuffer_, toWrite);
+			{
+				int numItems;
+				while ((numItems = writeDataFromBufferToFile(dataBuffer_.getCapacity())) > 0)
+					numItemsWritten += numItems;
+			}
 		}
 	}
-//END_IGNORE_EXCEPTIONS("AsynchFileWriter::timerCallback()")
+	while (eventBuffer_.getReadAvail() > 0);
+
+	return numItemsWritten;
+}
+
+float AsynchFileWriter::getFillLevel() const
+{
+	const int capacity = dataBuffer_.getCapacity();
+	return (capacity > 0) ? (float)dataBuffer_.getReadAvail()/(float)capacity : 0.0f;
+}
+
+float AsynchFileWriter::getHighWaterLevel() const
+{
+	const int capacity = dataBuffer_.getCapacity();
+	return (capacity > 0) ? (float)highWaterItems_/(float)capacity : 0.0f;
+}
+
+void AsynchFileWriter::resetStats()
+{
+	highWaterItems_ = 0;
+	numOverflows_ = 0;
+	numItemsDropped_ = 0;
 }
 
 // ---------------------------------------------------------------------------------------
@@ -260,18 +341,44 @@ void AsynchFileWriter::writeRemainingDataInBufferToFileAndClose()
 	if (fileWriter_ != NULL && fileWriter_->isOpen())
 	{
 		// Write all remaining data in buffer:
-		while (1)
+		while (writeDataFromBufferToFile(dataBuffer_.getCapacity()) > 0)
 		{
-			int toWrite = dataBuffer_.get(writeBuffer_, writeBufferSize_);
-			if (toWrite <= 0)
-				break;
-
-			fileWriter_->writeItems(writeBuffer_, toWrite);
 		}
 
 		// Close file:
 		fileWriter_->closeFile();
+		chunkCrcWriter_.close();
+	}
+}
+
+// Writes up to maxItems items of the data buffer to the (open) file in a single write 
+// (at most writeBufferSize_ if not mirrored), returns the number of items written.
+int AsynchFileWriter::writeDataFromBufferToFile(int maxItems)
+{
+	if (dataBuffer_.isMirrored())
+	{
+		// Write straight from the data buffer (contiguous across its wrap point):
+		const int toWrite = std::min((int)dataBuffer_.getReadAvail(), maxItems);
+		if (toWrite > 0)
+		{
+			fileWriter_->writeItems(dataBuffer_.getReadPtr(), toWrite);
+			if (chunkCrcWriter_.isOpen())
+				chunkCrcWriter_.update(dataBuffer_.getReadPtr(), toWrite*sizeof(float));
+			dataBuffer_.advanceReadIdx(toWrite);
+			numItemsWritten_ += toWrite;
+		}
+		return toWrite;
+	}
+
+	const int toWrite = dataBuffer_.get(writeBuffer_, std::min(maxItems, writeBufferSize_));
+	if (toWrite > 0)
+	{
+		fileWriter_->writeItems(writeBuffer_, toWrite);
+		if (chunkCrcWriter_.isOpen())
+			chunkCrcWriter_.update(writeBuffer_, toWrite*sizeof(float));
+		numItemsWritten_ += toWrite;
 	}
+	return toWrite;
 }
 
 void AsynchFileWriter::handleFirstOfPendingEvents()
@@ -288,12 +395,15 @@ void AsynchFileWriter::handleFirstOfPendingEvents()
 				// Note: Shouldn't happen normally, but may when for instance two 
 				// subsequent start events are posted.
 				fileWriter_->closeFile();
+				chunkCrcWriter_.close();
 
 				LOG_ERROR_N("asynch_file_writer", "[r]ERROR: Starting new recording without ending previous.");
 			}
 
 			// Open new file:
 			fileWriter_->openFile(curEvent_.filename);
+			if (chunkCrcSizeBytes_ > 0 && fileWriter_->isOpen() && !chunkCrcWriter_.open(curEvent_.filename, chunkCrcSizeBytes_))
+				LOG_ERROR_N("asynch_file_writer", "[r]ERROR: Failed to open CRC file.");
 
 			// Set isDiskWriting flag for consumer thread:
 			isConsumerDiskWriting_.set(true);
@@ -9,6 +9,7 @@
 
 #include "AtomicFlag.hxx"
 #include "AtomicPtr.hxx"
+#include "ChunkCrcFile.hxx"
 
 //#include "ViolinRecordingPlugInConfig.hxx"
 #define DISABLE_TIMERS 1
@@ -107,6 +108,11 @@ public:
 
 	//void setFullnessMeter(class HorizontalBarMeter *fullnessMeter) { fullnessMeter_ = fullnessMeter; }
 
+	// Per-chunk CRC32 records of the written data in a sidecar file (see ChunkCrcWriter), 
+	// 0 for none (only while not disk writing, from the next recording on):
+	void setChunkCrcSize(int numBytes) { chunkCrcSizeBytes_ = numBytes; }
+	int getChunkCrcSize() const { return chunkCrcSizeBytes_; }
+
 	// Starting/stopping (timer):
 	void startConsumerThread();
 	void stopConsumerThread();
@@ -118,17 +124,36 @@ public:
 	void postStartDiskWriteEvent(const char *filename, int numFramesToGoBackInHistory);
 	void postStopDiskWriteEvent();
 
+	// Whether a recording is open or a start/stop event is still to be handled (by the 
+	// consumer, see timerCallback()):
+	bool isDiskWriting() const { return isConsumerDiskWriting_.isSet() || eventBuffer_.getReadAvail() > 0; }
+
 	// Clearing (thread-safe):
 	void clearDataAndResetUnwrappedWriteIdxCount();
 
 	// Computing rewind:
 	unsigned int getUnwrappedWriteIdxFrames() const { return writeIdxUnwrappedFrames_; }
 	void timerCallback();
+
+	// Consuming everything pending at once (see AsynchFileWriterService): handles all 
+	// pending events and writes all buffered data in as few (large) writes as possible, 
+	// returns the number of items written:
+	int drain();
+
+	// Statistics (approximate, may be read from any thread):
+	float getFillLevel() const; // [0;1] of the data buffer
+	float getHighWaterLevel() const; // max. fill level since resetStats()
+	unsigned int getNumItemsWritten() const { return numItemsWritten_; } // (wraps around)
+	unsigned int getNumOverflows() const { return numOverflows_; } // writeData() calls that lost data
+	unsigned int getNumItemsDropped() const { return numItemsDropped_; }
+	void resetStats();
+	int getFrameSize() const { return (fileWriter_ != NULL) ? fileWriter_->getFrameSize() : 0; }
 private:
 	//void timerCallback2(t_object *polhemusSoundRec);
 
 
 	void writeRemainingDataInBufferToFileAndClose();
+	int writeDataFromBufferToFile(int maxItems);
 	void handleFirstOfPendingEvents();
 
 private:
@@ -140,8 +165,13 @@ private:
 
 	float *writeBuffer_;
 	int writeBufferSize_;
+	int dataBufferRequestedSize_; // (see allocate())
 	FileEvent curEvent_;
 	unsigned int writeIdxUnwrappedFrames_;
+	volatile unsigned int numItemsWritten_;
+	volatile LONG highWaterItems_; // (only written by the producer, except for resetStats())
+	volatile unsigned int numOverflows_;
+	volatile unsigned int numItemsDropped_;
 
 	AtomicFlag isProducerDiskWriting_;
 	AtomicFlag isConsumerDiskWriting_; // (doesn't have to be atomic, but so both flags use same syntax)
@@ -149,6 +179,9 @@ private:
 
 	FileWriterInterface *fileWriter_;
 
+	ChunkCrcWriter chunkCrcWriter_; // (consumer thread)
+	int chunkCrcSizeBytes_;
+
 	//AtomicPtr<HorizontalBarMeter> fullnessMeter_;
 };
 
@@ -0,0 +1,257 @@
+#include "AsynchFileWriterService.hxx"
+
+#include <cstring>
+#include <algorithm>
+
+#include "AsynchFileWriter.hxx"
+
+#include "concat/Utilities/Logging.hxx"
+
+// ---------------------------------------------------------------------------------------
+
+namespace
+{
+	const DWORD statsUpdateIntervalMilliseconds = 1000;
+}
+
+// ---------------------------------------------------------------------------------------
+
+AsynchFileWriterService::AsynchFileWriterService()
+{
+	numWriters_ = 0;
+	::InitializeCriticalSection(&lock_);
+
+	thread_ = NULL;
+	wakeEvent_ = ::CreateEventA(NULL, FALSE, FALSE, NULL); // (auto-reset)
+	intervalMilliseconds_ = 100;
+	isAdaptiveInterval_ = false;
+	currentIntervalMilliseconds_ = intervalMilliseconds_;
+	lastMaxFillLevel_ = 0.0f;
+	lastStatsUpdateTime_ = 0;
+	::QueryPerformanceFrequency(&counterFrequency_);
+}
+
+AsynchFileWriterService::~AsynchFileWriterService()
+{
+	stop();
+
+	if (wakeEvent_ != NULL)
+		::CloseHandle(wakeEvent_);
+	::DeleteCriticalSection(&lock_);
+}
+
+// ---------------------------------------------------------------------------------------
+
+bool AsynchFileWriterService::addWriter(AsynchFileWriter *writer, const char *name)
+{
+	ScopedLock lock(*this);
+
+	if (writer == NULL || hasWriter(writer))
+		return false;
+	if (numWriters_ == maxNumWriters)
+	{
+		LOG_ERROR_N("asynch_file_writer", "[r]ERROR: Too many writers for the file writer service.");
+		return false;
+	}
+
+	Stream &stream = streams_[numWriters_];
+	stream.writer = writer;
+	memset(&stream.stats, 0, sizeof(stream.stats));
+	strncpy(stream.stats.name, (name != NULL) ? name : "", sizeof(stream.stats.name) - 1);
+	stream.numItemsAtLastUpdate = writer->getNumItemsWritten();
+	++numWriters_;
+
+	return true;
+}
+
+void AsynchFileWriterService::removeWriter(AsynchFileWriter *writer)
+{
+	ScopedLock lock(*this);
+
+	for (int i = 0; i < numWriters_; ++i)
+	{
+		if (streams_[i].writer == writer)
+		{
+			for (int j = i + 1; j < numWriters_; ++j)
+				streams_[j - 1] = streams_[j];
+			--numWriters_;
+			return;
+		}
+	}
+}
+
+bool AsynchFileWriterService::hasWriter(const AsynchFileWriter *writer) const
+{
+	for (int i = 0; i < numWriters_; ++i)
+	{
+		if (streams_[i].writer == writer)
+			return true;
+	}
+	return false;
+}
+
+// ---------------------------------------------------------------------------------------
+
+bool AsynchFileWriterService::start(int intervalMilliseconds)
+{
+	if (thread_ != NULL)
+		return true;
+	if (wakeEvent_ == NULL)
+		return false;
+
+	intervalMilliseconds_ = (intervalMilliseconds > 0) ? intervalMilliseconds : 100;
+	currentIntervalMilliseconds_ = intervalMilliseconds_;
+	lastStatsUpdateTime_ = ::GetTickCount();
+
+	stopRequested_.set(false);
+	thread_ = ::CreateThread(NULL, 0, &AsynchFileWriterService::threadEntry, this, 0, NULL);
+	if (thread_ == NULL)
+	{
+		LOG_ERROR_N("asynch_file_writer", "[r]ERROR: Failed to create file writer thread.");
+		return false;
+	}
+	::SetThreadPriority(thread_, THREAD_PRIORITY_ABOVE_NORMAL);
+
+	return true;
+}
+
+void AsynchFileWriterService::stop()
+{
+	if (thread_ == NULL)
+		return;
+
+	stopRequested_.set(true);
+	::SetEvent(wakeEvent_);
+	::WaitForSingleObject(thread_, INFINITE);
+	::CloseHandle(thread_);
+	thread_ = NULL;
+}
+
+void AsynchFileWriterService::wake()
+{
+	if (thread_ != NULL)
+		::SetEvent(wakeEvent_);
+}
+
+// ---------------------------------------------------------------------------------------
+
+void AsynchFileWriterService::drainAll()
+{
+	ScopedLock lock(*this);
+
+	// Fullest first (so a writer close to overrunning isn't kept waiting by the others):
+	int order[maxNumWriters];
+	for (int i = 0; i < numWriters_; ++i)
+	{
+		const float fillLevel = streams_[i].writer->getFillLevel();
+		streams_[i].stats.fillLevel = fillLevel;
+		if (fillLevel > streams_[i].stats.maxFillLevel)
+			streams_[i].stats.maxFillLevel = fillLevel;
+
+		int j = i;
+		for (; j > 0 && streams_[order[j - 1]].stats.fillLevel < fillLevel; --j)
+			order[j] = order[j - 1];
+		order[j] = i;
+	}
+
+	lastMaxFillLevel_ = (numWriters_ > 0) ? streams_[order[0]].stats.fillLevel : 0.0f;
+
+	for (int i = 0; i < numWriters_; ++i)
+	{
+		StreamStats &stats = streams_[order[i]].stats;
+
+		LARGE_INTEGER startTime, endTime;
+		::QueryPerformanceCounter(&startTime);
+		streams_[order[i]].writer->drain();
+		::QueryPerformanceCounter(&endTime);
+
+		stats.drainMilliseconds = (float)((endTime.QuadPart - startTime.QuadPart)*1000.0/counterFrequency_.QuadPart);
+		if (stats.drainMilliseconds > stats.maxDrainMilliseconds)
+			stats.maxDrainMilliseconds = stats.drainMilliseconds;
+	}
+}
+
+bool AsynchFileWriterService::getStreamStats(int i, StreamStats &stats)
+{
+	ScopedLock lock(*this);
+
+	if (i < 0 || i >= numWriters_)
+		return false;
+	stats = streams_[i].stats;
+	return true;
+}
+
+void AsynchFileWriterService::resetStats()
+{
+	ScopedLock lock(*this);
+
+	for (int i = 0; i < numWriters_; ++i)
+	{
+		StreamStats &stats = streams_[i].stats;
+		stats.maxFillLevel = 0.0f;
+		stats.maxDrainMilliseconds = 0.0f;
+		streams_[i].writer->resetStats();
+		stats.highWaterLevel = 0.0f;
+		stats.numOverflows = 0;
+		stats.numItemsDropped = 0;
+	}
+}
+
+// ---------------------------------------------------------------------------------------
+
+DWORD WINAPI AsynchFileWriterService::threadEntry(LPVOID arg)
+{
+	static_cast<AsynchFileWriterService *>(arg)->run();
+	return 0;
+}
+
+void AsynchFileWriterService::run()
+{
+	while (!stopRequested_.isSet())
+	{
+		currentIntervalMilliseconds_ = getWaitMilliseconds(lastMaxFillLevel_);
+		::WaitForSingleObject(wakeEvent_, currentIntervalMilliseconds_);
+
+		drainAll();
+
+		const DWORD now = ::GetTickCount();
+		if (now - lastStatsUpdateTime_ >= statsUpdateIntervalMilliseconds)
+			updateStats(now);
+	}
+
+	// (data posted until stop())
+	drainAll();
+}
+
+void AsynchFileWriterService::updateStats(DWORD now)
+{
+	ScopedLock lock(*this);
+
+	const float seconds = (now - lastStatsUpdateTime_)/1000.0f;
+	for (int i = 0; i < numWriters_; ++i)
+	{
+		Stream &stream = streams_[i];
+		const unsigned int numItemsWritten = stream.writer->getNumItemsWritten();
+		const unsigned int delta = numItemsWritten - stream.numItemsAtLastUpdate; // (wrap-around safe)
+
+		stream.stats.itemsPerSecond = delta/seconds;
+		stream.stats.numItemsWritten += delta;
+		stream.numItemsAtLastUpdate = numItemsWritten;
+
+		stream.stats.highWaterLevel = stream.writer->getHighWaterLevel();
+		stream.stats.numOverflows = stream.writer->getNumOverflows();
+		stream.stats.numItemsDropped = stream.writer->getNumItemsDropped();
+	}
+	lastStatsUpdateTime_ = now;
+}
+
+// The interval, or in adaptive mode linearly less as the fullest buffer fills up, down to 
+// minIntervalMilliseconds at half full:
+int AsynchFileWriterService::getWaitMilliseconds(float maxFillLevel) const
+{
+	if (!isAdaptiveInterval_ || intervalMilliseconds_ <= minIntervalMilliseconds)
+		return intervalMilliseconds_;
+
+	const float t = std::min(2.0f*maxFillLevel, 1.0f);
+	return intervalMilliseconds_ - (int)(t*(intervalMilliseconds_ - minIntervalMilliseconds));
+}
@@ -0,0 +1,130 @@
+#ifndef INCLUDED_ASYNCHFILEWRITERSERVICE_HXX
+#define INCLUDED_ASYNCHFILEWRITERSERVICE_HXX
+
+#define NOMINMAX // avoid min/max macros from windows.h
+#include <windows.h> // CreateThread(), CRITICAL_SECTION
+
+#include "AtomicFlag.hxx"
+
+class AsynchFileWriter;
+
+// Single consumer thread for all asynchronous file writers of a take (audio channels,
+// tracker, ...).
+//
+// Instead of every AsynchFileWriter being consumed separately (and their small writes
+// interleaving on the disk), one above normal priority thread wakes up every interval,
+// and drains the registered writers one after the other, the fullest buffer first (see
+// AsynchFileWriter::drain()): each writer's pending data goes to its file in one large
+// sequential write (or a few, when the buffer isn't mirrored).
+//
+// In adaptive mode (see setAdaptiveInterval()) the thread wakes up sooner as the fullest
+// buffer fills up, down to minIntervalMilliseconds from half full, so a slow disk or a
+// production peak is drained before the buffer overflows rather than at the next interval.
+//
+// The writers stay lock-free for their producers (writeData(), posting events); only the
+// consumer side is serialized: configuring a registered writer (allocate(),
+// setFileWriter()) or draining it from another thread has to hold the service lock (see
+// ScopedLock).
+class AsynchFileWriterService
+{
+public:
+	enum
+	{
+		maxNumWriters = 8,
+		minIntervalMilliseconds = 5 // (adaptive mode)
+	};
+
+	// Per registered writer, updated by the thread about once per second (levels, 
+	// overflows and high-water mark since resetStats()):
+	struct StreamStats
+	{
+		char name[32];
+		float itemsPerSecond; // written to disk
+		float fillLevel; // [0;1] of the data buffer, at the last drain
+		float maxFillLevel; // at drains
+		float highWaterLevel; // after writes (see AsynchFileWriter::getHighWaterLevel())
+		unsigned int numOverflows; // writes that lost data
+		unsigned int numItemsDropped;
+		float drainMilliseconds; // last drain
+		float maxDrainMilliseconds;
+		unsigned int numItemsWritten; // since registered (wraps around)
+	};
+
+	class ScopedLock
+	{
+	public:
+		explicit ScopedLock(AsynchFileWriterService &service) : service_(service) { service_.lock(); }
+		~ScopedLock() { service_.unlock(); }
+	private:
+		AsynchFileWriterService &service_;
+		ScopedLock(const ScopedLock &); // non-copyable
+		ScopedLock &operator=(const ScopedLock &); // non-copyable
+	};
+
+	AsynchFileWriterService();
+	~AsynchFileWriterService();
+
+	// Registering writers (not owned, also while running):
+	bool addWriter(AsynchFileWriter *writer, const char *name);
+	void removeWriter(AsynchFileWriter *writer);
+	bool hasWriter(const AsynchFileWriter *writer) const;
+
+	// Starting/stopping the writer thread (stop() drains all writers a last time):
+	bool start(int intervalMilliseconds);
+	void stop();
+	bool isRunning() const { return thread_ != NULL; }
+
+	// Draining without waiting for the interval (e.g. after posting stop events):
+	void wake();
+
+	// Shortening the wait as buffers fill up (see above):
+	void setAdaptiveInterval(bool isAdaptive) { isAdaptiveInterval_ = isAdaptive; }
+	bool isAdaptiveInterval() const { return isAdaptiveInterval_; }
+	int getCurrentIntervalMilliseconds() const { return currentIntervalMilliseconds_; }
+
+	// Draining all writers from the calling thread (e.g. to finish a take before
+	// reconfiguring the writers):
+	void drainAll();
+
+	// Exclusive access to the registered writers' consumer side (recursive):
+	void lock() { ::EnterCriticalSection(&lock_); }
+	void unlock() { ::LeaveCriticalSection(&lock_); }
+
+	// Statistics:
+	int getNumWriters() const { return numWriters_; }
+	bool getStreamStats(int i, StreamStats &stats);
+	void resetStats();
+
+private:
+	static DWORD WINAPI threadEntry(LPVOID arg);
+	void run();
+	void updateStats(DWORD now);
+	int getWaitMilliseconds(float maxFillLevel) const;
+
+private:
+	struct Stream
+	{
+		AsynchFileWriter *writer;
+		StreamStats stats;
+		unsigned int numItemsAtLastUpdate;
+	};
+
+	Stream streams_[maxNumWriters];
+	int numWriters_;
+	CRITICAL_SECTION lock_;
+
+	HANDLE thread_;
+	HANDLE wakeEvent_;
+	AtomicFlag stopRequested_;
+	int intervalMilliseconds_;
+	volatile bool isAdaptiveInterval_;
+	volatile int currentIntervalMilliseconds_;
+	float lastMaxFillLevel_; // (of the last drainAll())
+	DWORD lastStatsUpdateTime_;
+	LARGE_INTEGER counterFrequency_;
+
+	AsynchFileWriterService(const AsynchFileWriterService &); // non-copyable
+	AsynchFileWriterService &operator=(const AsynchFileWriterService &); // non-copyable
+};
+
+#endif
@@ -2,25 +2,35 @@
 
 #include <stdio.h>
 #include <malloc.h>
-#include "LibertyTracker.hxx"
+#include "TrackerSample.hxx"
 
 class CBuffer
 {
 private:
 
     int         size;   /* maximum number of elements           */
+    int         capacity; /* allocated number of elements (>= size) */
     int         start;  /* index of oldest element              */
     int			count;
-    LibertyTracker::ItemData   *elems;  /* vector of elements                   */
+    TrackerSample   *elems;  /* vector of elements                   */
 	
 public:
 	CBuffer(int size) 
 	{
 		this->size  = size;
+		capacity = size;
 		start = 0;
 		count = 0;
-		elems = (LibertyTracker::ItemData *)calloc(size, sizeof(LibertyTracker::ItemData));
+		elems = (TrackerSample *)calloc(size, sizeof(TrackerSample));
 	}
+
+	/* set the size to newSize elements and empty it, only reallocates when growing beyond capacity */
+	void cbResize(int newSize) {
+		if (newSize > capacity) {
+			free(elems);
+			elems = (TrackerSample *)calloc(newSize, sizeof(TrackerSample));
+			capacity = newSize; }
+		size = newSize; start = 0; count = 0; }
  
 	void cbFree() {
 		free(elems); /* OK if null */start=0; count=0; }
@@ -34,7 +44,7 @@ public:
 	int cbIsEmpty() {
 		return count == 0; }
 
-	void cbWrite(LibertyTracker::ItemData *elem) {
+	void cbWrite(const TrackerSample *elem) {
 		int end = (start + count) % size;
 		elems[end] = *elem;
 		if (count == size)
@@ -43,11 +53,17 @@ public:
 			++ count;
 	}
 	 
-	void cbRead(LibertyTracker::ItemData *elem) {
+	void cbRead(TrackerSample *elem) {
 		*elem = elems[start];
 		start = (start + 1) % size;
 		-- count;
 	}
+
+	/* consume n elements without copying them (n <= count) */
+	void cbSkip(int n) {
+		start = (start + n) % size;
+		count -= n;
+	}
 	
 	int getSize()
 	{ return size;}
@@ -58,7 +74,7 @@ public:
 	int getCount()
 	{ return count;}
 
-	LibertyTracker::ItemData* cbGetBuffer()
+	TrackerSample* cbGetBuffer()
 	{
 		return elems;
 	}
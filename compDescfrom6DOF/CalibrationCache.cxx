@@ -0,0 +1,173 @@
+#include "CalibrationCache.hxx"
+
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+#include "Crc32.hxx"
+
+// ---------------------------------------------------------------------------------------
+
+namespace
+{
+	const int readBlockSizeBytes = 65536;
+
+	class ScopedCriticalSection
+	{
+	public:
+		explicit ScopedCriticalSection(CRITICAL_SECTION &cs) : cs_(cs) { ::EnterCriticalSection(&cs_); }
+		~ScopedCriticalSection() { ::LeaveCriticalSection(&cs_); }
+	private:
+		CRITICAL_SECTION &cs_;
+		ScopedCriticalSection(const ScopedCriticalSection &); // non-copyable
+		ScopedCriticalSection &operator=(const ScopedCriticalSection &); // non-copyable
+	};
+
+	bool hasSameKey(const CalibrationCacheEntry &a, const CalibrationCacheEntry &b)
+	{
+		return (_stricmp(a.path.c_str(), b.path.c_str()) == 0 &&
+			a.lastWriteTime.dwLowDateTime == b.lastWriteTime.dwLowDateTime &&
+			a.lastWriteTime.dwHighDateTime == b.lastWriteTime.dwHighDateTime &&
+			a.fileSize == b.fileSize && a.contentCrc == b.contentCrc);
+	}
+
+	// Betas in the layout of the descriptor geometry (see computeDerived3dData()):
+	void packBetas(const TrackerCalibration &calibration, int violin, InstrumentKeyPointsT<double> &betas)
+	{
+		for (int k = 0; k < 4; ++k)
+		{
+			betas.strBridge[k] = calibration.getBeta(violin, TrackerCalibration::STR1_BRIDGE + k);
+			betas.strFb[k] = calibration.getBeta(violin, TrackerCalibration::STR1_FB + k);
+		}
+		betas.bowFrogLhs = calibration.getBeta(violin, TrackerCalibration::BOW_FROG_LHS);
+		betas.bowFrogRhs = calibration.getBeta(violin, TrackerCalibration::BOW_FROG_RHS);
+		betas.bowTipLhs = calibration.getBeta(violin, TrackerCalibration::BOW_TIP_LHS);
+		betas.bowTipRhs = calibration.getBeta(violin, TrackerCalibration::BOW_TIP_RHS);
+	}
+}
+
+// ---------------------------------------------------------------------------------------
+
+CalibrationCache::CalibrationCache()
+{
+	::InitializeCriticalSection(&lock_);
+	concat::computeCrc32Tables8(crcTables8_);
+	numHits_ = 0;
+	numMisses_ = 0;
+}
+
+CalibrationCache::~CalibrationCache()
+{
+	for (size_t i = 0; i < entries_.size(); ++i)
+		delete entries_[i];
+	::DeleteCriticalSection(&lock_);
+}
+
+// ---------------------------------------------------------------------------------------
+
+const CalibrationCacheEntry *CalibrationCache::acquire(const char *filename)
+{
+	// (outside of the lock, only the key of a new entry is written)
+	CalibrationCacheEntry *entry = new CalibrationCacheEntry();
+	if (!readFileKey(filename, *entry))
+	{
+		delete entry;
+		return NULL;
+	}
+
+	{
+		ScopedCriticalSection lock(lock_);
+		CalibrationCacheEntry *cached = findEntry(*entry);
+		if (cached != NULL)
+		{
+			delete entry;
+			++cached->refCount;
+			++numHits_;
+			return cached;
+		}
+	}
+
+	// Parsing takes the time, don't hold the lock meanwhile (another thread may parse
+	// the same file, the first one inserted is used):
+	if (!entry->calibration.loadFrom6DOFXMLFile(entry->path.c_str()))
+	{
+		delete entry;
+		return NULL;
+	}
+	entry->numViolins = std::min((int)entry->calibration.getNumberViolins(), (int)MAX_NUM_VIOLINS);
+	for (int v = 0; v < entry->numViolins; ++v)
+		packBetas(entry->calibration, v, entry->betas[v]);
+	entry->refCount = 1;
+
+	ScopedCriticalSection lock(lock_);
+	CalibrationCacheEntry *cached = findEntry(*entry);
+	if (cached != NULL)
+	{
+		delete entry;
+		++cached->refCount;
+		++numHits_;
+		return cached;
+	}
+	entries_.push_back(entry);
+	++numMisses_;
+	return entry;
+}
+
+void CalibrationCache::release(const CalibrationCacheEntry *entry)
+{
+	if (entry == NULL)
+		return;
+
+	ScopedCriticalSection lock(lock_);
+	std::vector<CalibrationCacheEntry *>::iterator it = std::find(entries_.begin(), entries_.end(), entry);
+	if (it == entries_.end())
+		return;
+
+	if (--(*it)->refCount == 0)
+	{
+		delete *it;
+		entries_.erase(it);
+	}
+}
+
+// ---------------------------------------------------------------------------------------
+
+CalibrationCacheEntry *CalibrationCache::findEntry(const CalibrationCacheEntry &key)
+{
+	for (size_t i = 0; i < entries_.size(); ++i)
+	{
+		if (hasSameKey(*entries_[i], key))
+			return entries_[i];
+	}
+	return NULL;
+}
+
+// Path, last write time, size and CRC32 of the contents of filename:
+bool CalibrationCache::readFileKey(const char *filename, CalibrationCacheEntry &key)
+{
+	char fullPath[MAX_PATH];
+	const DWORD n = ::GetFullPathNameA(filename, MAX_PATH, fullPath, NULL);
+	key.path = (n > 0 && n < MAX_PATH) ? fullPath : filename;
+
+	WIN32_FILE_ATTRIBUTE_DATA attributes;
+	if (!::GetFileAttributesExA(key.path.c_str(), GetFileExInfoStandard, &attributes))
+		return false;
+	key.lastWriteTime = attributes.ftLastWriteTime;
+	key.fileSize = ((unsigned __int64)attributes.nFileSizeHigh << 32) | attributes.nFileSizeLow;
+
+	// (the time stamp alone misses a file replaced within its resolution)
+	FILE *file = fopen(key.path.c_str(), "rb");
+	if (file == NULL)
+		return false;
+
+	std::vector<concat::byte> block(readBlockSizeBytes);
+	concat::uint32_t crc = 0;
+	size_t numBytes;
+	while ((numBytes = fread(&block[0], 1, block.size(), file)) > 0)
+		crc = concat::computeCrc32Sliced8(crcTables8_, &block[0], (int)numBytes, crc);
+	fclose(file);
+
+	key.contentCrc = crc;
+	key.refCount = 0;
+	return true;
+}
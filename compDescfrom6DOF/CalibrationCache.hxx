@@ -0,0 +1,66 @@
+#ifndef INCLUDED_CALIBRATIONCACHE_HXX
+#define INCLUDED_CALIBRATIONCACHE_HXX
+
+#define NOMINMAX // avoid min/max macros from windows.h
+#include <windows.h> // CRITICAL_SECTION, FILETIME
+#include <string>
+#include <vector>
+
+#include "concat/Utilities/StdInt.hxx"
+#include "ViolinRecordingPlugInConfig.hxx"
+#include "TrackerCalibration.hxx"
+#include "DescriptorGeometry.hxx"
+
+// A calibration file parsed once, shared read-only by all instances (see CalibrationCache).
+// Nothing in an entry changes after acquire() returned it, so it's read without locking.
+struct CalibrationCacheEntry
+{
+	std::string path; // full path
+	FILETIME lastWriteTime;
+	unsigned __int64 fileSize;
+	concat::uint32_t contentCrc; // CRC32 of the file contents
+
+	TrackerCalibration calibration;
+	int numViolins; // (at most MAX_NUM_VIOLINS)
+	InstrumentKeyPointsT<double> betas[MAX_NUM_VIOLINS]; // calibration.getBeta(), per violin
+
+	int refCount; // (guarded by the cache lock)
+};
+
+// Process-wide cache of parsed 6DOF calibration files (see TrackerCalibration::loadFrom6DOFXMLFile()).
+//
+// An entry is keyed by the full path, last write time and size of the file, and the
+// CRC32 of its contents: starting again with an unchanged file (or a second instance
+// with the same file) takes the parsed calibration from the cache instead of parsing
+// the XML again, while an edited file is parsed anew. Entries are reference counted and
+// deleted when the last user releases them.
+class CalibrationCache
+{
+public:
+	CalibrationCache();
+	~CalibrationCache();
+
+	// The parsed calibration of filename, NULL if it can't be loaded (to be released):
+	const CalibrationCacheEntry *acquire(const char *filename);
+	void release(const CalibrationCacheEntry *entry); // (NULL is ignored)
+
+	int getNumEntries() const { return (int)entries_.size(); }
+	int getNumHits() const { return numHits_; }
+	int getNumMisses() const { return numMisses_; }
+
+private:
+	bool readFileKey(const char *filename, CalibrationCacheEntry &key);
+	CalibrationCacheEntry *findEntry(const CalibrationCacheEntry &key); // (lock held)
+
+private:
+	std::vector<CalibrationCacheEntry *> entries_;
+	CRITICAL_SECTION lock_;
+	concat::uint32_t crcTables8_[8*256];
+	int numHits_;
+	int numMisses_;
+
+	CalibrationCache(const CalibrationCache &); // non-copyable
+	CalibrationCache &operator=(const CalibrationCache &); // non-copyable
+};
+
+#endif
@@ -0,0 +1,326 @@
+#define NOMINMAX // avoid min/max macros from windows.h
+#include <windows.h> // CreateThread(), FindFirstFileA()
+#include "ChunkCrcFile.hxx"
+
+#include <cstring>
+#include <algorithm>
+
+#include "Crc32.hxx"
+#include "libsndfile/sndfile.h"
+#include "concat/FileFormats/MatrixDataFile.hxx"
+
+// ---------------------------------------------------------------------------------------
+
+namespace
+{
+	const concat::uint32_t crcKey = 0x04c11db7;
+	const char crcFileId[4] = { 'C', 'R', 'C', '1' };
+	const char *const crcFileExtension = ".crc";
+	const int verifyBlockSizeFloats = 65536;
+
+	std::string getCrcFilename(const char *dataFilename)
+	{
+		return std::string(dataFilename) + crcFileExtension;
+	}
+
+	bool hasExtension(const std::string &filename, const char *extension)
+	{
+		const size_t n = strlen(extension);
+		return (filename.size() >= n && _stricmp(filename.c_str() + filename.size() - n, extension) == 0);
+	}
+
+	// Compares the chunks of the take file data with the records of the sidecar file:
+	class ChunkCrcChecker : public ChunkCrcStream
+	{
+	public:
+		ChunkCrcChecker(FILE *crcFile, ChunkCrcVerifyResult &result) : crcFile_(crcFile), result_(result)
+		{
+		}
+
+	private:
+		void onChunk(concat::uint32_t numBytes, concat::uint32_t crc)
+		{
+			concat::uint32_t record[2];
+			if (fread(record, sizeof(record), 1, crcFile_) != 1 || record[0] != numBytes)
+			{
+				result_.status = ChunkCrcVerifyResult::LENGTH_MISMATCH;
+				return;
+			}
+
+			if (record[1] != crc)
+			{
+				if (result_.numBadChunks == 0)
+					result_.firstBadChunk = result_.numChunks;
+				++result_.numBadChunks;
+			}
+			++result_.numChunks;
+		}
+
+		FILE *crcFile_;
+		ChunkCrcVerifyResult &result_;
+	};
+}
+
+// ---------------------------------------------------------------------------------------
+
+ChunkCrcStream::ChunkCrcStream()
+{
+	concat::computeCrc32Tables8(tables8_, crcKey);
+	chunkSizeBytes_ = 0;
+	numBytesInChunk_ = 0;
+	crc_ = 0;
+}
+
+void ChunkCrcStream::reset(int chunkSizeBytes)
+{
+	chunkSizeBytes_ = chunkSizeBytes;
+	numBytesInChunk_ = 0;
+	crc_ = 0;
+}
+
+void ChunkCrcStream::update(const void *data, int numBytes)
+{
+	const concat::byte *p = (const concat::byte *)data;
+
+	while (numBytes > 0)
+	{
+		const int n = std::min(numBytes, chunkSizeBytes_ - numBytesInChunk_);
+		crc_ = concat::computeCrc32Sliced8(tables8_, p, n, crc_);
+		numBytesInChunk_ += n;
+		p += n;
+		numBytes -= n;
+
+		if (numBytesInChunk_ == chunkSizeBytes_)
+		{
+			onChunk(numBytesInChunk_, crc_);
+			numBytesInChunk_ = 0;
+			crc_ = 0;
+		}
+	}
+}
+
+void ChunkCrcStream::flush()
+{
+	if (numBytesInChunk_ > 0)
+		onChunk(numBytesInChunk_, crc_);
+	numBytesInChunk_ = 0;
+	crc_ = 0;
+}
+
+// ---------------------------------------------------------------------------------------
+
+ChunkCrcWriter::ChunkCrcWriter()
+{
+	file_ = NULL;
+}
+
+ChunkCrcWriter::~ChunkCrcWriter()
+{
+	close();
+}
+
+bool ChunkCrcWriter::open(const char *dataFilename, int chunkSizeBytes)
+{
+	close();
+	if (chunkSizeBytes <= 0)
+		return false;
+
+	file_ = fopen(getCrcFilename(dataFilename).c_str(), "wb");
+	if (file_ == NULL)
+		return false;
+
+	const concat::uint32_t header[2] = { (concat::uint32_t)chunkSizeBytes, crcKey };
+	fwrite(crcFileId, sizeof(crcFileId), 1, file_);
+	fwrite(header, sizeof(header), 1, file_);
+
+	reset(chunkSizeBytes);
+	return true;
+}
+
+void ChunkCrcWriter::close()
+{
+	if (file_ == NULL)
+		return;
+
+	flush();
+	fclose(file_);
+	file_ = NULL;
+}
+
+void ChunkCrcWriter::onChunk(concat::uint32_t numBytes, concat::uint32_t crc)
+{
+	const concat::uint32_t record[2] = { numBytes, crc };
+	fwrite(record, sizeof(record), 1, file_);
+}
+
+// ---------------------------------------------------------------------------------------
+
+bool verifyChunkCrcs(const char *dataFilename, ChunkCrcVerifyResult &result)
+{
+	result.filename = dataFilename;
+	result.status = ChunkCrcVerifyResult::OK;
+	result.chunkSizeBytes = 0;
+	result.numChunks = 0;
+	result.numBadChunks = 0;
+	result.firstBadChunk = -1;
+
+	FILE *crcFile = fopen(getCrcFilename(dataFilename).c_str(), "rb");
+	char id[4];
+	concat::uint32_t header[2];
+	if (crcFile == NULL || fread(id, sizeof(id), 1, crcFile) != 1 || memcmp(id, crcFileId, sizeof(id)) != 0 ||
+		fread(header, sizeof(header), 1, crcFile) != 1 || header[0] == 0 || header[1] != crcKey)
+	{
+		if (crcFile != NULL)
+			fclose(crcFile);
+		result.status = ChunkCrcVerifyResult::NO_CRC_FILE;
+		return false;
+	}
+
+	result.chunkSizeBytes = (int)header[0];
+	ChunkCrcChecker checker(crcFile, result);
+	checker.reset(result.chunkSizeBytes);
+	std::vector<float> block(verifyBlockSizeFloats);
+
+	if (hasExtension(result.filename, ".wav"))
+	{
+		SF_INFO info;
+		memset(&info, 0, sizeof(info));
+		SNDFILE *file = sf_open(dataFilename, SFM_READ, &info);
+		if (file == NULL || info.channels <= 0)
+		{
+			result.status = ChunkCrcVerifyResult::UNREADABLE;
+		}
+		else
+		{
+			const sf_count_t blockSizeFrames = verifyBlockSizeFloats/info.channels;
+			sf_count_t numFrames;
+			while ((numFrames = sf_readf_float(file, &block[0], blockSizeFrames)) > 0)
+				checker.update(&block[0], (int)(numFrames*info.channels*sizeof(float)));
+		}
+		if (file != NULL)
+			sf_close(file);
+	}
+	else if (hasExtension(result.filename, ".dat"))
+	{
+		concat::MatrixDataFileRead file(dataFilename);
+		const int numValuesPerFrame = file.isOpen() ? (int)file.getNumValuesPerFrame() : 0;
+		if (!file.isOk() || numValuesPerFrame <= 0 || file.hasNonConstantNumValuesPerFrame())
+		{
+			result.status = ChunkCrcVerifyResult::UNREADABLE;
+		}
+		else
+		{
+			const int blockSizeFrames = std::max(verifyBlockSizeFloats/numValuesPerFrame, 1);
+			block.resize(blockSizeFrames*numValuesPerFrame);
+			int numFloats;
+			while ((numFloats = file.read(&block[0], blockSizeFrames)) > 0)
+				checker.update(&block[0], numFloats*sizeof(float));
+		}
+	}
+	else
+	{
+		result.status = ChunkCrcVerifyResult::UNREADABLE;
+	}
+
+	if (result.status == ChunkCrcVerifyResult::OK)
+	{
+		checker.flush();
+
+		// (records left: the take file is shorter than when it was written)
+		concat::uint32_t record[2];
+		if (fread(record, sizeof(record), 1, crcFile) == 1)
+			result.status = ChunkCrcVerifyResult::LENGTH_MISMATCH;
+	}
+	if (result.status == ChunkCrcVerifyResult::OK && result.numBadChunks > 0)
+		result.status = ChunkCrcVerifyResult::CORRUPT;
+
+	fclose(crcFile);
+	return (result.status == ChunkCrcVerifyResult::OK);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+namespace
+{
+	struct VerifyJob
+	{
+		std::vector<ChunkCrcVerifyResult> *results;
+		volatile LONG nextIdx; // (next file to take, shared by the threads)
+	};
+
+	DWORD WINAPI verifyThreadEntry(LPVOID arg)
+	{
+		VerifyJob *job = static_cast<VerifyJob *>(arg);
+		const LONG numFiles = (LONG)job->results->size();
+
+		LONG i;
+		while ((i = ::InterlockedIncrement(&job->nextIdx) - 1) < numFiles)
+		{
+			ChunkCrcVerifyResult &result = (*job->results)[i];
+			const std::string filename = result.filename;
+			verifyChunkCrcs(filename.c_str(), result);
+		}
+		return 0;
+	}
+}
+
+void verifyChunkCrcsParallel(std::vector<ChunkCrcVerifyResult> &results, int numThreads)
+{
+	VerifyJob job;
+	job.results = &results;
+	job.nextIdx = 0;
+
+	numThreads = std::min(std::max(numThreads, 1), std::max((int)results.size(), 1));
+	std::vector<HANDLE> threads;
+	for (int i = 1; i < numThreads; ++i) // (the calling thread is one of them)
+	{
+		HANDLE thread = ::CreateThread(NULL, 0, &verifyThreadEntry, &job, 0, NULL);
+		if (thread != NULL)
+			threads.push_back(thread);
+	}
+
+	verifyThreadEntry(&job);
+
+	for (size_t i = 0; i < threads.size(); ++i)
+	{
+		::WaitForSingleObject(threads[i], INFINITE);
+		::CloseHandle(threads[i]);
+	}
+}
+
+int findChunkCrcFiles(const char *dir, std::vector<std::string> &dataFilenames)
+{
+	std::string path(dir);
+	if (!path.empty() && path[path.size() - 1] != '\\' && path[path.size() - 1] != '/')
+		path += '\\';
+
+	WIN32_FIND_DATAA findData;
+	HANDLE find = ::FindFirstFileA((path + "*" + crcFileExtension).c_str(), &findData);
+	if (find == INVALID_HANDLE_VALUE)
+		return 0;
+
+	int numFound = 0;
+	do
+	{
+		const std::string crcFilename(findData.cFileName);
+		dataFilenames.push_back(path + crcFilename.substr(0, crcFilename.size() - strlen(crcFileExtension)));
+		++numFound;
+	}
+	while (::FindNextFileA(find, &findData));
+	::FindClose(find);
+
+	return numFound;
+}
+
+const char *getChunkCrcStatusName(ChunkCrcVerifyResult::Status status)
+{
+	switch (status)
+	{
+	case ChunkCrcVerifyResult::OK: return "ok";
+	case ChunkCrcVerifyResult::CORRUPT: return "corrupt";
+	case ChunkCrcVerifyResult::LENGTH_MISMATCH: return "length mismatch";
+	case ChunkCrcVerifyResult::NO_CRC_FILE: return "no crc file";
+	case ChunkCrcVerifyResult::UNREADABLE: return "unreadable";
+	}
+	return "?";
+}
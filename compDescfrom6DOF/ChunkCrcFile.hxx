@@ -0,0 +1,100 @@
+#ifndef INCLUDED_CHUNKCRCFILE_HXX
+#define INCLUDED_CHUNKCRCFILE_HXX
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "concat/Utilities/StdInt.hxx"
+
+// Per-chunk integrity records of recorded take files (see AsynchFileWriter::setChunkCrcSize()).
+//
+// The sample data of a take file (the floats as written through
+// AsynchFileWriter::FileWriterInterface::writeItems(), without the file header) is split
+// into chunks of a fixed number of bytes, and the CRC32 of each chunk (computeCrc32Sliced8(),
+// starting from 0) is written to a sidecar file <take file>.crc, as the data is written.
+// A damaged archive can so be checked chunk by chunk (see verifyChunkCrcs()), telling
+// where the data went bad rather than only that it did.
+//
+// Sidecar file format (little-endian uint32s): 'C', 'R', 'C', '1', chunk size (bytes), key
+// polynomial; then per chunk: number of bytes (the chunk size, except for a shorter last
+// chunk), CRC32.
+
+// Splits a byte stream into chunks and computes the CRC32 of each.
+class ChunkCrcStream
+{
+public:
+	ChunkCrcStream();
+	virtual ~ChunkCrcStream() {}
+
+	void reset(int chunkSizeBytes);
+	void update(const void *data, int numBytes);
+	void flush(); // (the last, shorter chunk)
+
+	int getChunkSize() const { return chunkSizeBytes_; }
+
+protected:
+	virtual void onChunk(concat::uint32_t numBytes, concat::uint32_t crc) = 0;
+
+private:
+	concat::uint32_t tables8_[8*256];
+	int chunkSizeBytes_;
+	int numBytesInChunk_;
+	concat::uint32_t crc_;
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// Writes the sidecar file of a take file (from the writer thread).
+class ChunkCrcWriter : public ChunkCrcStream
+{
+public:
+	ChunkCrcWriter();
+	~ChunkCrcWriter();
+
+	bool open(const char *dataFilename, int chunkSizeBytes);
+	void close();
+	bool isOpen() const { return (file_ != NULL); }
+
+private:
+	void onChunk(concat::uint32_t numBytes, concat::uint32_t crc);
+
+	FILE *file_;
+
+	ChunkCrcWriter(const ChunkCrcWriter &); // non-copyable
+	ChunkCrcWriter &operator=(const ChunkCrcWriter &); // non-copyable
+};
+
+// ---------------------------------------------------------------------------------------
+
+struct ChunkCrcVerifyResult
+{
+	enum Status
+	{
+		OK,
+		CORRUPT, // chunks with a wrong CRC
+		LENGTH_MISMATCH, // more or less data than recorded
+		NO_CRC_FILE,
+		UNREADABLE // take file can't be opened (only .wav and .dat are supported)
+	};
+
+	std::string filename; // take file
+	Status status;
+	int chunkSizeBytes;
+	int numChunks;
+	int numBadChunks;
+	int firstBadChunk; // -1 if none
+};
+
+// Checks a take file (.wav or .dat) against its sidecar file:
+bool verifyChunkCrcs(const char *dataFilename, ChunkCrcVerifyResult &result);
+
+// Checks the take files of results (filename set) on numThreads threads:
+void verifyChunkCrcsParallel(std::vector<ChunkCrcVerifyResult> &results, int numThreads);
+
+// Take files that have a sidecar file in directory dir:
+int findChunkCrcFiles(const char *dir, std::vector<std::string> &dataFilenames);
+
+const char *getChunkCrcStatusName(ChunkCrcVerifyResult::Status status);
+
+#endif
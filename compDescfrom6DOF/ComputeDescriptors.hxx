@@ -2,6 +2,7 @@
 #define INCLUDED_COMPUTEDESCRIPTORS_HXX
 
 #include "LibertyTracker.hxx"
+#include "TrackerSample.hxx"
 #include "TrackerCalibration.hxx"
 #include "ViolinRecordingPlugInConfig.hxx"
 #include "CalibrationAngles.hxx"
@@ -14,9 +15,10 @@
 #undef max
 #include <algorithm>
 
-#include "FilterFir.hxx"
+#include "FilterFirLinear.hxx"
 #include "WindowGen.hxx"
-#include "Derivative2.hxx"
+#include "FusedDerivativeSmoother.hxx"
+#include "DescriptorGeometry.hxx"
 
 //#define KSTICK 10
 //#define TENSIONHAIRS 1500
@@ -58,7 +60,7 @@ inline Matrix3x1 computeBeta(const Matrix3x1 &point, const Matrix3x1 &refSensPos
 {
 	Matrix3x1 result;
 	Matrix3x3 rot = Matrix3x3::rotation_matrix_zyx(refSensOrientation(0, 0), refSensOrientation(1, 0), refSensOrientation(2, 0));
-	Matrix3x3 invRot = inverse(rot);
+	Matrix3x3 invRot = transpose(rot); // (inverse of a rotation)
 	result = invRot*(point - refSensPos);
 	return result;
 }
@@ -114,6 +116,22 @@ struct Line3
 // performance descriptors
 struct Derived3dData
 {
+	// Optional fields (see ComputeViolinPeformanceDescriptors::setDerived3dFields()), the 
+	// rotation matrices, string (bridge and fingerboard) and bow points, inclination, played 
+	// string, StrRef and the interRef lines and flags are always computed:
+	enum Field
+	{
+		WOOD = 1 << 0,					// posStr1Wood..posStr4Wood (transformed betas)
+		FRAMES = 1 << 1,				// posBridgeMiddle, vecBridge*, vecFrog* (visualization)
+		INCLINATION_Z = 1 << 2,			// bowInclinationZDegrees, bowInclinationZSmoothDegrees
+		TILT = 1 << 3,					// bowTiltAngleDegrees, bowTiltAngleZDegrees
+		BOW_BRIDGE_ANGLE = 1 << 4,		// bowBridgeAngleDegrees
+		STRING_INTERSECTIONS = 1 << 5,	// inter2Lhs..inter4Rhs
+		DESCRIPTOR_INPUTS = 1 << 6,		// inter1Lhs, inter1Rhs, bowStickFrog, bowStickTip (needed by computeViolinPerformanceDescriptors())
+		ALL_FIELDS = (1 << 7) - 1
+	};
+	unsigned int fields; // computed optional fields
+
 	Matrix3x3 violinBodyRotMat;
 	Matrix3x3 bowRotMat;
 
@@ -180,6 +198,10 @@ struct Derived3dData
 
 	Matrix3x1 bowStickFrog; // rough approximation (for visualization and stream synchronization purposes)
 	Matrix3x1 bowStickTip;
+
+	bool isOutOfContact; // bow clearly away from the strings (see setContactGateDistance()): 
+						 // only the string and bow points, inclinations, bow stick and played 
+						 // string (0) are computed, the rest is not valid
 	//Line3 lineBetweenStickAndBridge; // XXX: TEMP
 
 	//------------------------------------------
@@ -266,7 +288,6 @@ public:
 	int compute(Derived3dData &ref_to_result, double deg_hyst, Matrix3x1 &v_up)
 	{
 		int playedString=0;
-		const double pi = 3.1415926535897932384626433832795;
 
 		Matrix3x1 v_43 = ref_to_result.posStr4Bridge - ref_to_result.posStr3Bridge;
 		Matrix3x1 v_32 = ref_to_result.posStr3Bridge - ref_to_result.posStr2Bridge;
@@ -275,9 +296,9 @@ public:
 		double bowAngleDegrees = (double)ref_to_result.bowInclinationSmoothDegrees;
 		
 		//double deg_hyst = anglesCalibration.getHysteresisDegrees();
-		double ang_43 = (double)(acos( dot(v_up, v_43)/(euclidean_length(v_up)*euclidean_length(v_43)) )/pi*180.0 - 90.0);
-		double ang_32 = (double)(acos( dot(v_up, v_32)/(euclidean_length(v_up)*euclidean_length(v_32)) )/pi*180.0 - 90.0);
-		double ang_21 = (double)(acos( dot(v_up, v_21)/(euclidean_length(v_up)*euclidean_length(v_21)) )/pi*180.0 - 90.0);
+		double ang_43 = angleDegrees(v_up, v_43) - 90.0;
+		double ang_32 = angleDegrees(v_up, v_32) - 90.0;
+		double ang_21 = angleDegrees(v_up, v_21) - 90.0;
 
 		//ROUGH CHANGE BY PANOS TO ACCOUNT FOR THE DIFFERENT BOW ORIENTATION IN CELLO
 		//This needs to be properly changed by adding an option to choose 'type of instrument'
@@ -399,6 +420,15 @@ struct RawSensorData
 	Matrix3x1 stylusSensPos;
 	Matrix3x1 stylusSensOrientation; // euler angles in radians
 	bool stylusButtonPressed;
+
+	// Rotation matrices of the violin body and bow orientations, computed for all violins 
+	// at once by trackerDataToRawSensorData(), used by computeDerived3dData() when valid 
+	// (set to false when filling in the orientations otherwise):
+	Matrix3x3 violinBodySensRotation[MAX_NUM_VIOLINS];
+	Matrix3x3 bowSensRotation[MAX_NUM_VIOLINS];
+	bool areRotationsValid;
+
+	RawSensorData() : areRotationsValid(false) {}
 };
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -431,6 +461,11 @@ public:
 	ComputeViolinPeformanceDescriptors();
 
 	RawSensorData trackerDataToRawSensorData(LibertyTracker::ItemDataIterator iter, int numViolins, bool isUsingStylus);
+	// Same, for compact frames (see TrackerSample), in place and only touching the slots 
+	// of the first numViolins violins:
+	void trackerDataToRawSensorData(TrackerSampleIterator iter, int numViolins, RawSensorData &result);
+	// Sets the rotation matrices of the first numViolins violins (see RawSensorData):
+	static void computeSensorRotations(RawSensorData &rawSensorData, int numViolins);
 
 	void computeSensorAccelerations(const RawSensorData &rawSensorData, double sampleRate, int numViolins);
 	void computeStylusAcceleration(const RawSensorData &rawSensorData, double sampleRate);
@@ -449,13 +484,39 @@ public:
 								 double ylhs /* pseudoforce distance */,
 								 double yrhs /* pseudoforce distance */,
 								 double l /* bowLength */ );
+	// Bow force from the displacement and the pseudo force distances (as 
+	// computeViolinPerformanceDescriptors() with computeForce, using the correction angle):
+	double computeBowForce(double bowDisplacement, double bowForceLhs, double bowForceRhs, double bowLength);
 
 
 	Derived3dData computeDerived3dData(const RawSensorData &rawSensorData, const TrackerCalibration &calibration, bool useAutoString, const CalibrationAngles &anglesCalibration, bool isCalibratingForce, const ForceCalibration *forceCalibration, int numViolins, int currViolin);
 	Derived3dData computeDerived3dData(const RawSensorData &rawSensorData, const TrackerCalibration &calibration, bool useAutoString, const CalibrationAngles &anglesCalibration, bool isCalibratingForce, const ForceCalibration *forceCalibration, int currViolin);
 
 
-	ViolinPerformanceDescriptors computeViolinPerformanceDescriptors(const RawSensorData &rawSensorData, const Derived3dData &derived3dData, bool zeroDescriptorsWhenNotPlaying = true, int numViolins=1, int iViolin=0, bool computeForce=false);
+	// (derivativeRate: rate of the frames, Hz, for bowVel and bowAccel)
+	ViolinPerformanceDescriptors computeViolinPerformanceDescriptors(const RawSensorData &rawSensorData, const Derived3dData &derived3dData, bool zeroDescriptorsWhenNotPlaying = true, int numViolins=1, int iViolin=0, bool computeForce=false, float derivativeRate=240.0f);
+
+	// Contact gating: when the bounding boxes of the bow hair and of the strings are more 
+	// than distanceCm apart, the bow can't be playing, so computeDerived3dData() skips the 
+	// bow/string intersections and angles (Derived3dData::isOutOfContact) and 
+	// computeViolinPerformanceDescriptors() skips bow-bridge distance and force, returning 
+	// the descriptors of a frame that's not played (without zeroDescriptorsWhenNotPlaying, 
+	// the skipped geometry is computed there after all). The bow displacement fed to the 
+	// velocity/acceleration smoother and the stick-bridge distance are still computed as 
+	// for a frame that isn't gated, and the played string hysteresis runs every frame, so 
+	// the output is the same as without the gate, also when contact resumes.
+	// distanceCm <= 0 disables the gate (default).
+	void setContactGateDistance(double distanceCm) { contactGateDistanceCm_ = distanceCm; }
+	double getContactGateDistance() const { return contactGateDistanceCm_; }
+	unsigned long getNumGatedFrames() const { return numGatedFrames_; } // (since construction)
+
+	// Optional Derived3dData fields computeDerived3dData() computes (Derived3dData::Field 
+	// flags, ALL_FIELDS by default), so consumers only pay for what they read. 
+	// DESCRIPTOR_INPUTS is always added, computeViolinPerformanceDescriptors() reads them. 
+	// The z inclination smoother only runs while INCLINATION_Z is set (it settles within 5 
+	// frames when set again).
+	void setDerived3dFields(unsigned int fields) { derived3dFields_ = (fields | Derived3dData::DESCRIPTOR_INPUTS) & Derived3dData::ALL_FIELDS; }
+	unsigned int getDerived3dFields() const { return derived3dFields_; }
 
 
 
@@ -467,27 +528,31 @@ private:
 	ComputeSensorVelocityAndAcceleration sens4VelAndAccel_;
 	ComputeSensorVelocityAndAcceleration sens5VelAndAccel_;
 
-	Derivative2 compBowVel_;
-	FilterFir bowVelSmoother_;
+	FusedDerivativeSmoother<> bowDerivatives_; // bow velocity and acceleration
 
-	Derivative2 compBowAccel_;
-	FilterFir bowAccelSmoother1_;
-	FilterFir bowAccelSmoother2_;
-	FilterFir bowAccelSmoother3_;
-
-	FilterFir inclinationSmoother_;
+	FilterFirLinear inclinationSmoother_;
 	ComputePlayedStringFromAngleWithHysteresis stringEstHysteresis_;
 
-	FilterFir inclinationZSmoother_;
+	FilterFirLinear inclinationZSmoother_;
 
 	double correctionAngle_, kost_, kstick_, b_;
 
+	double contactGateDistanceCm_;
+	unsigned long numGatedFrames_;
+	unsigned int derived3dFields_;
+
+	bool isBowOutOfContact(const Derived3dData &derived3dData) const;
+	bool gateOutOfContact(Derived3dData &result);
+	void computeContactGeometry(Derived3dData &result, bool isComputingDescriptorInputs);
+	void computeBowStick(Derived3dData &result);
+	double computeStickBridgeDistance(const Derived3dData &derived3dData);
 	Line3 smallestLineBetweenTwoLines(const Line3 &l1, const Line3 &l2);
 	bool isPointWithinLineSegment(const Matrix3x1 &p0, const Matrix3x1 &p1, const Matrix3x1 &p2);
 
 	double computeBowDisplacement(const Matrix3x1 &bowFrog, const Matrix3x1 &pointOnSmallestLineBetweenPlayedStringAndBowHairRibbonAtBowHairRibbon);
 
-	void initSmoothingFilter(FilterFir &filter, int size);
+	void initSmoothingFilter(FilterFirLinear &filter, int size);
+	static void computeSmoothingCoeffs(float *coeffs, int size);
 };
 
 // ---------------------------------------------------------------------------------------
@@ -496,10 +561,11 @@ private:
 
 inline ComputeViolinPeformanceDescriptors::ComputeViolinPeformanceDescriptors()
 {
-	initSmoothingFilter(bowVelSmoother_, 5);
-	initSmoothingFilter(bowAccelSmoother1_, 5);
-	initSmoothingFilter(bowAccelSmoother2_, 5);
-	initSmoothingFilter(bowAccelSmoother3_, 9); // XXX: was 10 in Esteban code, but needs to be odd for symmetric filter
+	float smoother5[5], smoother9[9]; // XXX: 9 was 10 in Esteban code, but needs to be odd for symmetric filter
+	computeSmoothingCoeffs(smoother5, 5);
+	computeSmoothingCoeffs(smoother9, 9);
+	bowDerivatives_.init(smoother5, smoother5, smoother5, smoother9);
+
 	initSmoothingFilter(inclinationSmoother_, 5);
 	initSmoothingFilter(inclinationZSmoother_, 5);
 
@@ -508,6 +574,10 @@ inline ComputeViolinPeformanceDescriptors::ComputeViolinPeformanceDescriptors()
 	kstick_ = 100.0;
 	b_ = 0.0;
 
+	contactGateDistanceCm_ = 0.0; // (off, see setContactGateDistance())
+	numGatedFrames_ = 0;
+	derived3dFields_ = Derived3dData::ALL_FIELDS;
+
 	//initSmoothingFilter(bowVelSmoother_v2_, 5);
 	//initSmoothingFilter(bowAccelSmoother1_v2_, 5);
 	//initSmoothingFilter(bowAccelSmoother2_v2_, 5);
@@ -535,13 +605,23 @@ inline void ComputeViolinPeformanceDescriptors::setB(double b)
 	b_ = b;
 }
 
-inline void ComputeViolinPeformanceDescriptors::initSmoothingFilter(FilterFir &filter, int size)
+inline void ComputeViolinPeformanceDescriptors::initSmoothingFilter(FilterFirLinear &filter, int size)
 {
 	if (size <= 0)
 		return;
 
 	float *coeffs = new float[size];
 
+	computeSmoothingCoeffs(coeffs, size);
+
+	// init fir filter:
+	filter.init(coeffs, size); // copies coeffs to internal memory
+
+	delete[] coeffs;
+}
+
+inline void ComputeViolinPeformanceDescriptors::computeSmoothingCoeffs(float *coeffs, int size)
+{
 	// compute gaussian window for n points:
 	computeGaussWindow(coeffs, size);
 
@@ -551,11 +631,6 @@ inline void ComputeViolinPeformanceDescriptors::initSmoothingFilter(FilterFir &f
 		sum += coeffs[i];
 	for (int i = 0; i < size; ++i)
 		coeffs[i] /= sum;
-
-	// init fir filter:
-	filter.init(coeffs, size); // copies coeffs to internal memory
-
-	delete[] coeffs;
 }
 
 
@@ -593,9 +668,55 @@ inline RawSensorData ComputeViolinPeformanceDescriptors::trackerDataToRawSensorD
 		result.stylusSensOrientation *= degreesToRadians;
 		result.stylusButtonPressed = (iter.item().isStylusButtonPressed == 1);
 	}
+
+	computeSensorRotations(result, numViolins);
 	return result;
 }
 
+inline void ComputeViolinPeformanceDescriptors::trackerDataToRawSensorData(TrackerSampleIterator iter, int numViolins, RawSensorData &result)
+{
+	const double pi = 3.1415926535897932384626433832795;
+	const double degreesToRadians = pi/180.0;
+
+	result.extSyncFlag = false;
+
+	for (int iviolin=0;iviolin<numViolins;iviolin++)
+	{
+		// sensor 1 (violin body):
+		result.violinBodySensPos[iviolin] = Matrix3x1(iter.item().position[0], iter.item().position[1], iter.item().position[2]);
+		result.violinBodySensOrientation[iviolin] = Matrix3x1(iter.item().orientation[0], iter.item().orientation[1], iter.item().orientation[2]);
+		result.violinBodySensOrientation[iviolin] *= degreesToRadians;
+		iter.next();
+
+		// sensor 2 (bow):
+		result.bowSensPos[iviolin] = Matrix3x1(iter.item().position[0], iter.item().position[1], iter.item().position[2]);
+		result.bowSensOrientation[iviolin] = Matrix3x1(iter.item().orientation[0], iter.item().orientation[1], iter.item().orientation[2]);
+		result.bowSensOrientation[iviolin] *= degreesToRadians;
+		iter.next();
+	}
+
+	computeSensorRotations(result, numViolins);
+}
+
+inline void ComputeViolinPeformanceDescriptors::computeSensorRotations(RawSensorData &rawSensorData, int numViolins)
+{
+	// Orientations of all sensors in one batch (violin bodies, then bows):
+	Matrix3x1 orientations[2*MAX_NUM_VIOLINS];
+	Matrix3x3 rotations[2*MAX_NUM_VIOLINS];
+	for (int iviolin=0;iviolin<numViolins;iviolin++)
+	{
+		orientations[iviolin] = rawSensorData.violinBodySensOrientation[iviolin];
+		orientations[numViolins + iviolin] = rawSensorData.bowSensOrientation[iviolin];
+	}
+	eulerZyxToRotationMatrices(orientations, 2*numViolins, rotations);
+	for (int iviolin=0;iviolin<numViolins;iviolin++)
+	{
+		rawSensorData.violinBodySensRotation[iviolin] = rotations[iviolin];
+		rawSensorData.bowSensRotation[iviolin] = rotations[numViolins + iviolin];
+	}
+	rawSensorData.areRotationsValid = true;
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 // needs to be called for each frame (memory)
@@ -618,9 +739,8 @@ inline void ComputeViolinPeformanceDescriptors::computeStylusAcceleration(const
 
 inline Derived3dData ComputeViolinPeformanceDescriptors::computeDerived3dData(const RawSensorData &rawSensorData, const TrackerCalibration &calibration, bool useAutoString, const CalibrationAngles &anglesCalibration, bool isCalibratingForce, const ForceCalibration *forceCalibration, int numViolins, int currViolin)
 {
-	const double pi = 3.1415926535897932384626433832795;
-
 	Derived3dData result;
+	result.fields = derived3dFields_;
 	//int currViolin=0;
 	// Aliases of betas:
 	const Matrix3x1 &betaStr1Bridge = calibration.getBeta(currViolin,TrackerCalibration::STR1_BRIDGE);
@@ -645,18 +765,29 @@ inline Derived3dData ComputeViolinPeformanceDescriptors::computeDerived3dData(co
 	Matrix3x3 &bowRotMat = result.bowRotMat;
 
 	// Compute rotation matrices:
-	violinBodyRotMat = Matrix3x3::rotation_matrix_zyx(rawSensorData.violinBodySensOrientation[currViolin](0, 0), rawSensorData.violinBodySensOrientation[currViolin](1, 0), rawSensorData.violinBodySensOrientation[currViolin](2, 0));
-	bowRotMat = Matrix3x3::rotation_matrix_zyx(rawSensorData.bowSensOrientation[currViolin](0, 0), rawSensorData.bowSensOrientation[currViolin](1, 0), rawSensorData.bowSensOrientation[currViolin](2, 0));
+	if (rawSensorData.areRotationsValid)
+	{
+		violinBodyRotMat = rawSensorData.violinBodySensRotation[currViolin];
+		bowRotMat = rawSensorData.bowSensRotation[currViolin];
+	}
+	else
+	{
+		violinBodyRotMat = Matrix3x3::rotation_matrix_zyx(rawSensorData.violinBodySensOrientation[currViolin](0, 0), rawSensorData.violinBodySensOrientation[currViolin](1, 0), rawSensorData.violinBodySensOrientation[currViolin](2, 0));
+		bowRotMat = Matrix3x3::rotation_matrix_zyx(rawSensorData.bowSensOrientation[currViolin](0, 0), rawSensorData.bowSensOrientation[currViolin](1, 0), rawSensorData.bowSensOrientation[currViolin](2, 0));
+	}
 
 	// Compute rotated and translated strings:
 	result.posStr1Bridge = violinBodyRotMat*betaStr1Bridge + rawSensorData.violinBodySensPos[currViolin];
 	result.posStr2Bridge = violinBodyRotMat*betaStr2Bridge + rawSensorData.violinBodySensPos[currViolin];
 	result.posStr3Bridge = violinBodyRotMat*betaStr3Bridge + rawSensorData.violinBodySensPos[currViolin];
 	result.posStr4Bridge = violinBodyRotMat*betaStr4Bridge + rawSensorData.violinBodySensPos[currViolin];
-	result.posStr1Wood = violinBodyRotMat*betaStr1Wood + rawSensorData.violinBodySensPos[currViolin];
-	result.posStr2Wood = violinBodyRotMat*betaStr2Wood + rawSensorData.violinBodySensPos[currViolin];
-	result.posStr3Wood = violinBodyRotMat*betaStr3Wood + rawSensorData.violinBodySensPos[currViolin];
-	result.posStr4Wood = violinBodyRotMat*betaStr4Wood + rawSensorData.violinBodySensPos[currViolin];
+	if (derived3dFields_ & Derived3dData::WOOD)
+	{
+		result.posStr1Wood = violinBodyRotMat*betaStr1Wood + rawSensorData.violinBodySensPos[currViolin];
+		result.posStr2Wood = violinBodyRotMat*betaStr2Wood + rawSensorData.violinBodySensPos[currViolin];
+		result.posStr3Wood = violinBodyRotMat*betaStr3Wood + rawSensorData.violinBodySensPos[currViolin];
+		result.posStr4Wood = violinBodyRotMat*betaStr4Wood + rawSensorData.violinBodySensPos[currViolin];
+	}
 	result.posStr1Fb = violinBodyRotMat*betaStr1Fb + rawSensorData.violinBodySensPos[currViolin];
 	result.posStr2Fb = violinBodyRotMat*betaStr2Fb + rawSensorData.violinBodySensPos[currViolin];
 	result.posStr3Fb = violinBodyRotMat*betaStr3Fb + rawSensorData.violinBodySensPos[currViolin];
@@ -689,30 +820,25 @@ inline Derived3dData ComputeViolinPeformanceDescriptors::computeDerived3dData(co
 	const Matrix3x1 &frog_lhs = result.posBowFrogLhs;
 	const Matrix3x1 &tip_lhs = result.posBowTipLhs;
 	const Matrix3x1 &frog_rhs = result.posBowFrogRhs;
-	const Matrix3x1 &tip_rhs = result.posBowTipRhs;
 
 	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 	// Compute bridge vectors:
 	Matrix3x1 m_br;							// center of bridge
-	Matrix3x1 m_fb;							// center of fingerboard
 	Matrix3x1 v_br_left;					// bridge vector pointing left
 	Matrix3x1 v_br_fwd;						// bridge vector pointing forward
 	Matrix3x1 v_br_up;						// bridge vector pointing up
 
-	m_br = (br2 + br3)/2;					// middle point on bridge, also origin of vectors
-	v_br_left = normalize(br4 - br1);		// vector pointing left from (0, 0, 0) (normalized)
-	m_fb = (fb2 + fb3)/2;					// middle point on finger board
-	v_br_fwd = normalize(m_fb - m_br);		// vector pointing forward from (0, 0, 0) (normalized)
-	v_br_up = cross(v_br_fwd, v_br_left);	// vector pointing up from (0, 0, 0) (normalized), according to right-hand rule for the cross-product
-											// NOTE: order of cross arguments determines up/down direction, left x fwd = up
-											// XXX: for some reason we need fwd x left to get up
+	computeBridgeFrame(br1, br2, br3, br4, fb2, fb3, m_br, v_br_left, v_br_fwd, v_br_up); // (see DescriptorGeometry.hxx)
 
 	// Store points for visualization:
-	result.posBridgeMiddle = m_br;
-	result.vecBridgeUp = v_br_up;
-	result.vecBridgeLeft = v_br_left;
-	result.vecBridgeFwd = v_br_fwd;
+	if (derived3dFields_ & Derived3dData::FRAMES)
+	{
+		result.posBridgeMiddle = m_br;
+		result.vecBridgeUp = v_br_up;
+		result.vecBridgeLeft = v_br_left;
+		result.vecBridgeFwd = v_br_fwd;
+	}
 
 	// Compute hair ribbon vector:
 	Matrix3x1 v_hr;
@@ -734,20 +860,23 @@ inline Derived3dData ComputeViolinPeformanceDescriptors::computeDerived3dData(co
 		v_fl_fwd = normalize(forceCalibration->getPoint(ForceCalibration::FLOOR_FWD) - forceCalibration->getPoint(ForceCalibration::FLOOR_ORIGIN));
 		v_fl_up = cross(v_fl_fwd, v_fl_left);
 
-		result.bowInclinationDegrees = (float)(acos( dot(v_fl_up, v_hr)/(euclidean_length(v_fl_up)*euclidean_length(v_hr)) )/pi*180.0 - 90.0); // so 90 degree angle between v_up and v_hr corresponds to 0 degree bow-angle
+		result.bowInclinationDegrees = (float)(angleDegrees(v_fl_up, v_hr) - 90.0); // so 90 degree angle between v_up and v_hr corresponds to 0 degree bow-angle
 		inclinationSmoother_.process(&result.bowInclinationDegrees, &result.bowInclinationSmoothDegrees, 1);
 	}
 	else
 	{
 		// Normal operation, use bridge up vector:
-		result.bowInclinationDegrees = (float)(acos( dot(v_br_up, v_hr)/(euclidean_length(v_br_up)*euclidean_length(v_hr)) )/pi*180.0 - 90.0); // so 90 degree angle between v_up and v_hr corresponds to 0 degree bow-angle
+		result.bowInclinationDegrees = (float)(angleDegrees(v_br_up, v_hr) - 90.0); // so 90 degree angle between v_up and v_hr corresponds to 0 degree bow-angle
 		inclinationSmoother_.process(&result.bowInclinationDegrees, &result.bowInclinationSmoothDegrees, 1);
 	}
 
 	// Compute bow inclination relative to z-axis of source (~gravity): NOTE THAT source-Z POINTS DOWNWARDS (~gravity)
 	Matrix3x1 v_z_up(0.0, 0.0, 1.0); // normalized
-	result.bowInclinationZDegrees = (float)(acos( dot(v_z_up, v_hr)/(euclidean_length(v_z_up)*euclidean_length(v_hr)) )/pi*180.0 - 90.0); // so 90 degree angle between v_z_up and v_hr corresponds to 0 degree bow-angle
-	inclinationZSmoother_.process(&result.bowInclinationZDegrees, &result.bowInclinationZSmoothDegrees, 1);
+	if (derived3dFields_ & Derived3dData::INCLINATION_Z)
+	{
+		result.bowInclinationZDegrees = (float)(angleDegrees(v_z_up, v_hr) - 90.0); // so 90 degree angle between v_z_up and v_hr corresponds to 0 degree bow-angle
+		inclinationZSmoother_.process(&result.bowInclinationZDegrees, &result.bowInclinationZSmoothDegrees, 1);
+	}
 
 	// Estimate played string (apply hysteresis, etc.):
 
@@ -796,30 +925,39 @@ inline Derived3dData ComputeViolinPeformanceDescriptors::computeDerived3dData(co
 		result.posStrRefFb = result.posStr4Fb;
 	}
 
+	// Skip the rest when the bow is clearly away from the strings (see setContactGateDistance()):
+	if (!(isCalibratingForce && forceCalibration != NULL) && gateOutOfContact(result))
+		return result;
+
 	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-	// Compute bow vectors:
-	Matrix3x1 v_fr_left;
-	Matrix3x1 v_fr_fwd;
-	Matrix3x1 v_fr_up;
-	const Matrix3x1 &frog_lhs_with_stick_top = frog_rhs;
-	const Matrix3x1 &frog_rhs_with_stick_top = frog_lhs;
-	v_fr_left = normalize(frog_lhs_with_stick_top - frog_rhs_with_stick_top);		// vector pointing left (with hair ribbon bottom, stick top)
-	v_fr_fwd = normalize(tip_lhs - frog_lhs);										// vector pointing forward
-	v_fr_up = cross(v_fr_fwd, v_fr_left);											// vector pointing up
+	// Compute bow vectors (for visualization and tilt):
+	if (derived3dFields_ & (Derived3dData::FRAMES | Derived3dData::TILT))
+	{
+		Matrix3x1 v_fr_left;
+		Matrix3x1 v_fr_fwd;
+		Matrix3x1 v_fr_up;
+		computeFrogFrame(frog_lhs, frog_rhs, tip_lhs, v_fr_left, v_fr_fwd, v_fr_up); // (see DescriptorGeometry.hxx)
 
-	// Store points for visualization:
-	result.vecFrogLeft = v_fr_left;
-	result.vecFrogFwd = v_fr_fwd;
-	result.vecFrogUp = v_fr_up;
+		// Store points for visualization:
+		if (derived3dFields_ & Derived3dData::FRAMES)
+		{
+			result.vecFrogLeft = v_fr_left;
+			result.vecFrogFwd = v_fr_fwd;
+			result.vecFrogUp = v_fr_up;
+		}
 
-	// Compute bow tilt angle:
-	Matrix3x1 v_str = result.posStrRefBridge - result.posStrRefFb;
-	result.bowTiltAngleDegrees = (float)(acos( dot(v_str, v_fr_up)/(euclidean_length(v_str)*euclidean_length(v_fr_up)) )/pi*180.0 - 90.0);
+		if (derived3dFields_ & Derived3dData::TILT)
+		{
+			// Compute bow tilt angle:
+			Matrix3x1 v_str = result.posStrRefBridge - result.posStrRefFb;
+			result.bowTiltAngleDegrees = (float)(angleDegrees(v_str, v_fr_up) - 90.0);
 
-	// Compute bow tilt angle Z:
-	Matrix3x1 v_froglh = frog_rhs - frog_lhs; // frog left to right vector
-	result.bowTiltAngleZDegrees = (float)(acos( dot(v_z_up, v_froglh)/(euclidean_length(v_z_up)*euclidean_length(v_froglh)) )/pi*180.0 - 90.0);
+			// Compute bow tilt angle Z:
+			Matrix3x1 v_froglh = frog_rhs - frog_lhs; // frog left to right vector
+			result.bowTiltAngleZDegrees = (float)(angleDegrees(v_z_up, v_froglh) - 90.0);
+		}
+	}
 
 	//// Compute bowup angle Z
 	//Matrix3x1 v_bowup = cross(v_froglh, v_hr);
@@ -827,88 +965,33 @@ inline Derived3dData ComputeViolinPeformanceDescriptors::computeDerived3dData(co
 
 	// Compute bow-bridge angle (angle between hair-ribbon and bridge, thus around 0 degrees 
 	// when playing normally):
-	result.bowBridgeAngleDegrees = (float)(acos( dot(v_br_left, v_hr)/(euclidean_length(v_br_left)*euclidean_length(v_hr)) )/pi*180.0);
+	if (derived3dFields_ & Derived3dData::BOW_BRIDGE_ANGLE)
+		result.bowBridgeAngleDegrees = (float)angleDegrees(v_br_left, v_hr);
 
 	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-	// Compute smallest line between any point on bow line and string 1 line:
-	
-	result.inter1Lhs = smallestLineBetweenTwoLines(Line3(result.posStr1Bridge, result.posStr1Fb), Line3(result.posBowFrogLhs, result.posBowTipLhs));
-	result.inter1Rhs = smallestLineBetweenTwoLines(Line3(result.posStr1Bridge, result.posStr1Fb), Line3(result.posBowFrogRhs, result.posBowTipRhs));
-
-	result.inter2Lhs = smallestLineBetweenTwoLines(Line3(result.posStr2Bridge, result.posStr2Fb), Line3(result.posBowFrogLhs, result.posBowTipLhs));
-	result.inter2Rhs = smallestLineBetweenTwoLines(Line3(result.posStr2Bridge, result.posStr2Fb), Line3(result.posBowFrogRhs, result.posBowTipRhs));
-
-	result.inter3Lhs = smallestLineBetweenTwoLines(Line3(result.posStr3Bridge, result.posStr3Fb), Line3(result.posBowFrogLhs, result.posBowTipLhs));
-	result.inter3Rhs = smallestLineBetweenTwoLines(Line3(result.posStr3Bridge, result.posStr3Fb), Line3(result.posBowFrogRhs, result.posBowTipRhs));
-
-	result.inter4Lhs = smallestLineBetweenTwoLines(Line3(result.posStr4Bridge, result.posStr4Fb), Line3(result.posBowFrogLhs, result.posBowTipLhs));
-	result.inter4Rhs = smallestLineBetweenTwoLines(Line3(result.posStr4Bridge, result.posStr4Fb), Line3(result.posBowFrogRhs, result.posBowTipRhs));
-
-	// Compute smallest line between any point on bow line and reference string line:
-	result.interRefLhs = smallestLineBetweenTwoLines(Line3(result.posStrRefBridge, result.posStrRefFb), Line3(result.posBowFrogLhs, result.posBowTipLhs));
-	result.interRefRhs = smallestLineBetweenTwoLines(Line3(result.posStrRefBridge, result.posStrRefFb), Line3(result.posBowFrogRhs, result.posBowTipRhs));
-	// NOTE:
-	// inter.p1 is intersection point on ref. string vector
-	// inter.p2 is intersection point on bow vector
-
-	// Check if smallest line between string/bow actually lie inside string/bow lines (with 
-	// tolerance to avoid descriptors going to 0 at extrema when there is some inaccuracy with 
-	// the calibration):
-	Matrix3x1 strRefVectorNorm = normalize(result.posStrRefFb - result.posStrRefBridge); // bridge pointing towards fb
-	Matrix3x1 bowVectorNormLhs = normalize(result.posBowTipLhs - result.posBowFrogLhs); // frog pointing towards tip (left)
-	Matrix3x1 bowVectorNormRhs = normalize(result.posBowTipRhs - result.posBowFrogRhs); // frog pointing towards tip (right)
-	double stringVectorToleranceCm = 3.0;
-	double bowVectorToleranceCm = 2.0;
-	result.isInterRefLhsInsideStringAndBow = (isPointWithinLineSegment(result.interRefLhs.p1, result.posStrRefBridge - stringVectorToleranceCm*strRefVectorNorm, result.posStrRefFb + stringVectorToleranceCm*strRefVectorNorm) &&
-		isPointWithinLineSegment(result.interRefLhs.p2, result.posBowFrogLhs - bowVectorToleranceCm*bowVectorNormLhs, result.posBowTipLhs + bowVectorToleranceCm*bowVectorNormLhs));
-	result.isInterRefRhsInsideStringAndBow = (isPointWithinLineSegment(result.interRefRhs.p1, result.posStrRefBridge - stringVectorToleranceCm*strRefVectorNorm, result.posStrRefFb + stringVectorToleranceCm*strRefVectorNorm) &&
-		isPointWithinLineSegment(result.interRefRhs.p2, result.posBowFrogRhs - bowVectorToleranceCm*bowVectorNormRhs, result.posBowTipRhs + bowVectorToleranceCm*bowVectorNormRhs));
-
-	if (!result.isInterRefLhsInsideStringAndBow && !result.isInterRefRhsInsideStringAndBow)
-	{
-		result.playedString = 0; // no string being played
-	}
-
-	// Compute approximation of bow stick:
+	// (and the other strings):
+	if (derived3dFields_ & Derived3dData::STRING_INTERSECTIONS)
 	{
-		Matrix3x1 v_left;
-		Matrix3x1 v_fwd;
-		Matrix3x1 v_up;
-
-		const Matrix3x1 &frog_lhs_with_stick_top = frog_rhs;
-		const Matrix3x1 &frog_rhs_with_stick_top = frog_lhs;
-		const Matrix3x1 &tip_lhs_with_stick_top = tip_rhs;
-		const Matrix3x1 &tip_rhs_with_stick_top = tip_lhs;
-		
-		// vector pointing left (with hair ribbon bottom, stick top)
-		// note: left - right means right pointing to left
-		v_left = normalize(frog_lhs_with_stick_top - frog_rhs_with_stick_top);
-		// vector pointing forward
-		// note: using lhs or rhs shouldn't really matter
-		v_fwd = normalize(tip_rhs_with_stick_top - frog_rhs_with_stick_top);
-		// vector pointing downward
-		// note: cross product of two normalized vector is a normalized vector
-		v_up = cross(v_fwd, v_left);
-
-		Matrix3x1 frog_center = (frog_lhs_with_stick_top + frog_rhs_with_stick_top)*0.5;
-		Matrix3x1 tip_center = (tip_lhs_with_stick_top + tip_rhs_with_stick_top)*0.5;
+		result.inter2Lhs = smallestLineBetweenTwoLines(Line3(result.posStr2Bridge, result.posStr2Fb), Line3(result.posBowFrogLhs, result.posBowTipLhs));
+		result.inter2Rhs = smallestLineBetweenTwoLines(Line3(result.posStr2Bridge, result.posStr2Fb), Line3(result.posBowFrogRhs, result.posBowTipRhs));
 
-		double stickHairDistanceCm = 1.0; // at most narrow part, conservative approximation (we don't want absolute distance wrapping when hitting bridge)
-
-		result.bowStickFrog = frog_center + stickHairDistanceCm*v_up;
-		result.bowStickTip = tip_center + stickHairDistanceCm*v_up;
+		result.inter3Lhs = smallestLineBetweenTwoLines(Line3(result.posStr3Bridge, result.posStr3Fb), Line3(result.posBowFrogLhs, result.posBowTipLhs));
+		result.inter3Rhs = smallestLineBetweenTwoLines(Line3(result.posStr3Bridge, result.posStr3Fb), Line3(result.posBowFrogRhs, result.posBowTipRhs));
 
+		result.inter4Lhs = smallestLineBetweenTwoLines(Line3(result.posStr4Bridge, result.posStr4Fb), Line3(result.posBowFrogLhs, result.posBowTipLhs));
+		result.inter4Rhs = smallestLineBetweenTwoLines(Line3(result.posStr4Bridge, result.posStr4Fb), Line3(result.posBowFrogRhs, result.posBowTipRhs));
 	}
 
+	computeContactGeometry(result, (derived3dFields_ & Derived3dData::DESCRIPTOR_INPUTS) != 0);
+
 	return result;
 }
 
 inline Derived3dData ComputeViolinPeformanceDescriptors::computeDerived3dData(const RawSensorData &rawSensorData, const TrackerCalibration &calibration, bool useAutoString, const CalibrationAngles &anglesCalibration, bool isCalibratingForce, const ForceCalibration *forceCalibration, int currViolin)
 {
-	const double pi = 3.1415926535897932384626433832795;
-
 	Derived3dData result;
+	result.fields = derived3dFields_;
 	//int currViolin=0;
 	// Aliases of betas:
 	const Matrix3x1 &betaStr1Bridge = calibration.getBeta(0,TrackerCalibration::STR1_BRIDGE);
@@ -933,18 +1016,29 @@ inline Derived3dData ComputeViolinPeformanceDescriptors::computeDerived3dData(co
 	Matrix3x3 &bowRotMat = result.bowRotMat;
 
 	// Compute rotation matrices:
-	violinBodyRotMat = Matrix3x3::rotation_matrix_zyx(rawSensorData.violinBodySensOrientation[currViolin](0, 0), rawSensorData.violinBodySensOrientation[currViolin](1, 0), rawSensorData.violinBodySensOrientation[currViolin](2, 0));
-	bowRotMat = Matrix3x3::rotation_matrix_zyx(rawSensorData.bowSensOrientation[currViolin](0, 0), rawSensorData.bowSensOrientation[currViolin](1, 0), rawSensorData.bowSensOrientation[currViolin](2, 0));
+	if (rawSensorData.areRotationsValid)
+	{
+		violinBodyRotMat = rawSensorData.violinBodySensRotation[currViolin];
+		bowRotMat = rawSensorData.bowSensRotation[currViolin];
+	}
+	else
+	{
+		violinBodyRotMat = Matrix3x3::rotation_matrix_zyx(rawSensorData.violinBodySensOrientation[currViolin](0, 0), rawSensorData.violinBodySensOrientation[currViolin](1, 0), rawSensorData.violinBodySensOrientation[currViolin](2, 0));
+		bowRotMat = Matrix3x3::rotation_matrix_zyx(rawSensorData.bowSensOrientation[currViolin](0, 0), rawSensorData.bowSensOrientation[currViolin](1, 0), rawSensorData.bowSensOrientation[currViolin](2, 0));
+	}
 
 	// Compute rotated and translated strings:
 	result.posStr1Bridge = violinBodyRotMat*betaStr1Bridge + rawSensorData.violinBodySensPos[currViolin];
 	result.posStr2Bridge = violinBodyRotMat*betaStr2Bridge + rawSensorData.violinBodySensPos[currViolin];
 	result.posStr3Bridge = violinBodyRotMat*betaStr3Bridge + rawSensorData.violinBodySensPos[currViolin];
 	result.posStr4Bridge = violinBodyRotMat*betaStr4Bridge + rawSensorData.violinBodySensPos[currViolin];
-	result.posStr1Wood = violinBodyRotMat*betaStr1Wood + rawSensorData.violinBodySensPos[currViolin];
-	result.posStr2Wood = violinBodyRotMat*betaStr2Wood + rawSensorData.violinBodySensPos[currViolin];
-	result.posStr3Wood = violinBodyRotMat*betaStr3Wood + rawSensorData.violinBodySensPos[currViolin];
-	result.posStr4Wood = violinBodyRotMat*betaStr4Wood + rawSensorData.violinBodySensPos[currViolin];
+	if (derived3dFields_ & Derived3dData::WOOD)
+	{
+		result.posStr1Wood = violinBodyRotMat*betaStr1Wood + rawSensorData.violinBodySensPos[currViolin];
+		result.posStr2Wood = violinBodyRotMat*betaStr2Wood + rawSensorData.violinBodySensPos[currViolin];
+		result.posStr3Wood = violinBodyRotMat*betaStr3Wood + rawSensorData.violinBodySensPos[currViolin];
+		result.posStr4Wood = violinBodyRotMat*betaStr4Wood + rawSensorData.violinBodySensPos[currViolin];
+	}
 	result.posStr1Fb = violinBodyRotMat*betaStr1Fb + rawSensorData.violinBodySensPos[currViolin];
 	result.posStr2Fb = violinBodyRotMat*betaStr2Fb + rawSensorData.violinBodySensPos[currViolin];
 	result.posStr3Fb = violinBodyRotMat*betaStr3Fb + rawSensorData.violinBodySensPos[currViolin];
@@ -977,30 +1071,25 @@ inline Derived3dData ComputeViolinPeformanceDescriptors::computeDerived3dData(co
 	const Matrix3x1 &frog_lhs = result.posBowFrogLhs;
 	const Matrix3x1 &tip_lhs = result.posBowTipLhs;
 	const Matrix3x1 &frog_rhs = result.posBowFrogRhs;
-	const Matrix3x1 &tip_rhs = result.posBowTipRhs;
 
 	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 	// Compute bridge vectors:
 	Matrix3x1 m_br;							// center of bridge
-	Matrix3x1 m_fb;							// center of fingerboard
 	Matrix3x1 v_br_left;					// bridge vector pointing left
 	Matrix3x1 v_br_fwd;						// bridge vector pointing forward
 	Matrix3x1 v_br_up;						// bridge vector pointing up
 
-	m_br = (br2 + br3)/2;					// middle point on bridge, also origin of vectors
-	v_br_left = normalize(br4 - br1);		// vector pointing left from (0, 0, 0) (normalized)
-	m_fb = (fb2 + fb3)/2;					// middle point on finger board
-	v_br_fwd = normalize(m_fb - m_br);		// vector pointing forward from (0, 0, 0) (normalized)
-	v_br_up = cross(v_br_fwd, v_br_left);	// vector pointing up from (0, 0, 0) (normalized), according to right-hand rule for the cross-product
-											// NOTE: order of cross arguments determines up/down direction, left x fwd = up
-											// XXX: for some reason we need fwd x left to get up
+	computeBridgeFrame(br1, br2, br3, br4, fb2, fb3, m_br, v_br_left, v_br_fwd, v_br_up); // (see DescriptorGeometry.hxx)
 
 	// Store points for visualization:
-	result.posBridgeMiddle = m_br;
-	result.vecBridgeUp = v_br_up;
-	result.vecBridgeLeft = v_br_left;
-	result.vecBridgeFwd = v_br_fwd;
+	if (derived3dFields_ & Derived3dData::FRAMES)
+	{
+		result.posBridgeMiddle = m_br;
+		result.vecBridgeUp = v_br_up;
+		result.vecBridgeLeft = v_br_left;
+		result.vecBridgeFwd = v_br_fwd;
+	}
 
 	// Compute hair ribbon vector:
 	Matrix3x1 v_hr;
@@ -1022,20 +1111,23 @@ inline Derived3dData ComputeViolinPeformanceDescriptors::computeDerived3dData(co
 		v_fl_fwd = normalize(forceCalibration->getPoint(ForceCalibration::FLOOR_FWD) - forceCalibration->getPoint(ForceCalibration::FLOOR_ORIGIN));
 		v_fl_up = cross(v_fl_fwd, v_fl_left);
 
-		result.bowInclinationDegrees = (float)(acos( dot(v_fl_up, v_hr)/(euclidean_length(v_fl_up)*euclidean_length(v_hr)) )/pi*180.0 - 90.0); // so 90 degree angle between v_up and v_hr corresponds to 0 degree bow-angle
+		result.bowInclinationDegrees = (float)(angleDegrees(v_fl_up, v_hr) - 90.0); // so 90 degree angle between v_up and v_hr corresponds to 0 degree bow-angle
 		inclinationSmoother_.process(&result.bowInclinationDegrees, &result.bowInclinationSmoothDegrees, 1);
 	}
 	else
 	{
 		// Normal operation, use bridge up vector:
-		result.bowInclinationDegrees = (float)(acos( dot(v_br_up, v_hr)/(euclidean_length(v_br_up)*euclidean_length(v_hr)) )/pi*180.0 - 90.0); // so 90 degree angle between v_up and v_hr corresponds to 0 degree bow-angle
+		result.bowInclinationDegrees = (float)(angleDegrees(v_br_up, v_hr) - 90.0); // so 90 degree angle between v_up and v_hr corresponds to 0 degree bow-angle
 		inclinationSmoother_.process(&result.bowInclinationDegrees, &result.bowInclinationSmoothDegrees, 1);
 	}
 
 	// Compute bow inclination relative to z-axis of source (~gravity): NOTE THAT source-Z POINTS DOWNWARDS (~gravity)
 	Matrix3x1 v_z_up(0.0, 0.0, 1.0); // normalized
-	result.bowInclinationZDegrees = (float)(acos( dot(v_z_up, v_hr)/(euclidean_length(v_z_up)*euclidean_length(v_hr)) )/pi*180.0 - 90.0); // so 90 degree angle between v_z_up and v_hr corresponds to 0 degree bow-angle
-	inclinationZSmoother_.process(&result.bowInclinationZDegrees, &result.bowInclinationZSmoothDegrees, 1);
+	if (derived3dFields_ & Derived3dData::INCLINATION_Z)
+	{
+		result.bowInclinationZDegrees = (float)(angleDegrees(v_z_up, v_hr) - 90.0); // so 90 degree angle between v_z_up and v_hr corresponds to 0 degree bow-angle
+		inclinationZSmoother_.process(&result.bowInclinationZDegrees, &result.bowInclinationZSmoothDegrees, 1);
+	}
 
 	// Estimate played string (apply hysteresis, etc.):
 	if (currViolin == 3) stringEstHysteresis_.setCelloEnabled(true);
@@ -1083,30 +1175,39 @@ inline Derived3dData ComputeViolinPeformanceDescriptors::computeDerived3dData(co
 		result.posStrRefFb = result.posStr4Fb;
 	}
 
+	// Skip the rest when the bow is clearly away from the strings (see setContactGateDistance()):
+	if (!(isCalibratingForce && forceCalibration != NULL) && gateOutOfContact(result))
+		return result;
+
 	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-	// Compute bow vectors:
-	Matrix3x1 v_fr_left;
-	Matrix3x1 v_fr_fwd;
-	Matrix3x1 v_fr_up;
-	const Matrix3x1 &frog_lhs_with_stick_top = frog_rhs;
-	const Matrix3x1 &frog_rhs_with_stick_top = frog_lhs;
-	v_fr_left = normalize(frog_lhs_with_stick_top - frog_rhs_with_stick_top);		// vector pointing left (with hair ribbon bottom, stick top)
-	v_fr_fwd = normalize(tip_lhs - frog_lhs);										// vector pointing forward
-	v_fr_up = cross(v_fr_fwd, v_fr_left);											// vector pointing up
+	// Compute bow vectors (for visualization and tilt):
+	if (derived3dFields_ & (Derived3dData::FRAMES | Derived3dData::TILT))
+	{
+		Matrix3x1 v_fr_left;
+		Matrix3x1 v_fr_fwd;
+		Matrix3x1 v_fr_up;
+		computeFrogFrame(frog_lhs, frog_rhs, tip_lhs, v_fr_left, v_fr_fwd, v_fr_up); // (see DescriptorGeometry.hxx)
 
-	// Store points for visualization:
-	result.vecFrogLeft = v_fr_left;
-	result.vecFrogFwd = v_fr_fwd;
-	result.vecFrogUp = v_fr_up;
+		// Store points for visualization:
+		if (derived3dFields_ & Derived3dData::FRAMES)
+		{
+			result.vecFrogLeft = v_fr_left;
+			result.vecFrogFwd = v_fr_fwd;
+			result.vecFrogUp = v_fr_up;
+		}
 
-	// Compute bow tilt angle:
-	Matrix3x1 v_str = result.posStrRefBridge - result.posStrRefFb;
-	result.bowTiltAngleDegrees = (float)(acos( dot(v_str, v_fr_up)/(euclidean_length(v_str)*euclidean_length(v_fr_up)) )/pi*180.0 - 90.0);
+		if (derived3dFields_ & Derived3dData::TILT)
+		{
+			// Compute bow tilt angle:
+			Matrix3x1 v_str = result.posStrRefBridge - result.posStrRefFb;
+			result.bowTiltAngleDegrees = (float)(angleDegrees(v_str, v_fr_up) - 90.0);
 
-	// Compute bow tilt angle Z:
-	Matrix3x1 v_froglh = frog_rhs - frog_lhs; // frog left to right vector
-	result.bowTiltAngleZDegrees = (float)(acos( dot(v_z_up, v_froglh)/(euclidean_length(v_z_up)*euclidean_length(v_froglh)) )/pi*180.0 - 90.0);
+			// Compute bow tilt angle Z:
+			Matrix3x1 v_froglh = frog_rhs - frog_lhs; // frog left to right vector
+			result.bowTiltAngleZDegrees = (float)(angleDegrees(v_z_up, v_froglh) - 90.0);
+		}
+	}
 
 	//// Compute bowup angle Z
 	//Matrix3x1 v_bowup = cross(v_froglh, v_hr);
@@ -1114,23 +1215,42 @@ inline Derived3dData ComputeViolinPeformanceDescriptors::computeDerived3dData(co
 
 	// Compute bow-bridge angle (angle between hair-ribbon and bridge, thus around 0 degrees 
 	// when playing normally):
-	result.bowBridgeAngleDegrees = (float)(acos( dot(v_br_left, v_hr)/(euclidean_length(v_br_left)*euclidean_length(v_hr)) )/pi*180.0);
+	if (derived3dFields_ & Derived3dData::BOW_BRIDGE_ANGLE)
+		result.bowBridgeAngleDegrees = (float)angleDegrees(v_br_left, v_hr);
 
 	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-	// Compute smallest line between any point on bow line and string 1 line:
-	
-	result.inter1Lhs = smallestLineBetweenTwoLines(Line3(result.posStr1Bridge, result.posStr1Fb), Line3(result.posBowFrogLhs, result.posBowTipLhs));
-	result.inter1Rhs = smallestLineBetweenTwoLines(Line3(result.posStr1Bridge, result.posStr1Fb), Line3(result.posBowFrogRhs, result.posBowTipRhs));
+	// (and the other strings):
+	if (derived3dFields_ & Derived3dData::STRING_INTERSECTIONS)
+	{
+		result.inter2Lhs = smallestLineBetweenTwoLines(Line3(result.posStr2Bridge, result.posStr2Fb), Line3(result.posBowFrogLhs, result.posBowTipLhs));
+		result.inter2Rhs = smallestLineBetweenTwoLines(Line3(result.posStr2Bridge, result.posStr2Fb), Line3(result.posBowFrogRhs, result.posBowTipRhs));
+
+		result.inter3Lhs = smallestLineBetweenTwoLines(Line3(result.posStr3Bridge, result.posStr3Fb), Line3(result.posBowFrogLhs, result.posBowTipLhs));
+		result.inter3Rhs = smallestLineBetweenTwoLines(Line3(result.posStr3Bridge, result.posStr3Fb), Line3(result.posBowFrogRhs, result.posBowTipRhs));
+
+		result.inter4Lhs = smallestLineBetweenTwoLines(Line3(result.posStr4Bridge, result.posStr4Fb), Line3(result.posBowFrogLhs, result.posBowTipLhs));
+		result.inter4Rhs = smallestLineBetweenTwoLines(Line3(result.posStr4Bridge, result.posStr4Fb), Line3(result.posBowFrogRhs, result.posBowTipRhs));
+	}
 
-	result.inter2Lhs = smallestLineBetweenTwoLines(Line3(result.posStr2Bridge, result.posStr2Fb), Line3(result.posBowFrogLhs, result.posBowTipLhs));
-	result.inter2Rhs = smallestLineBetweenTwoLines(Line3(result.posStr2Bridge, result.posStr2Fb), Line3(result.posBowFrogRhs, result.posBowTipRhs));
+	computeContactGeometry(result, (derived3dFields_ & Derived3dData::DESCRIPTOR_INPUTS) != 0);
+
+	return result;
+}
 
-	result.inter3Lhs = smallestLineBetweenTwoLines(Line3(result.posStr3Bridge, result.posStr3Fb), Line3(result.posBowFrogLhs, result.posBowTipLhs));
-	result.inter3Rhs = smallestLineBetweenTwoLines(Line3(result.posStr3Bridge, result.posStr3Fb), Line3(result.posBowFrogRhs, result.posBowTipRhs));
 
-	result.inter4Lhs = smallestLineBetweenTwoLines(Line3(result.posStr4Bridge, result.posStr4Fb), Line3(result.posBowFrogLhs, result.posBowTipLhs));
-	result.inter4Rhs = smallestLineBetweenTwoLines(Line3(result.posStr4Bridge, result.posStr4Fb), Line3(result.posBowFrogRhs, result.posBowTipRhs));
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// The bow/string lines, contact flags and bow stick of computeDerived3dData() (what a frame 
+// skipped by the contact gate lacks), from the string and bow points of result:
+inline void ComputeViolinPeformanceDescriptors::computeContactGeometry(Derived3dData &result, bool isComputingDescriptorInputs)
+{
+	// Compute smallest line between any point on bow line and string 1 line:
+	if (isComputingDescriptorInputs)
+	{
+		result.inter1Lhs = smallestLineBetweenTwoLines(Line3(result.posStr1Bridge, result.posStr1Fb), Line3(result.posBowFrogLhs, result.posBowTipLhs));
+		result.inter1Rhs = smallestLineBetweenTwoLines(Line3(result.posStr1Bridge, result.posStr1Fb), Line3(result.posBowFrogRhs, result.posBowTipRhs));
+	}
 
 	// Compute smallest line between any point on bow line and reference string line:
 	result.interRefLhs = smallestLineBetweenTwoLines(Line3(result.posStrRefBridge, result.posStrRefFb), Line3(result.posBowFrogLhs, result.posBowTipLhs));
@@ -1140,64 +1260,89 @@ inline Derived3dData ComputeViolinPeformanceDescriptors::computeDerived3dData(co
 	// inter.p2 is intersection point on bow vector
 
 	// Check if smallest line between string/bow actually lie inside string/bow lines (with 
-	// tolerance to avoid descriptors going to 0 at extrema when there is some inaccuracy with 
-	// the calibration):
-	Matrix3x1 strRefVectorNorm = normalize(result.posStrRefFb - result.posStrRefBridge); // bridge pointing towards fb
-	Matrix3x1 bowVectorNormLhs = normalize(result.posBowTipLhs - result.posBowFrogLhs); // frog pointing towards tip (left)
-	Matrix3x1 bowVectorNormRhs = normalize(result.posBowTipRhs - result.posBowFrogRhs); // frog pointing towards tip (right)
-	double stringVectorToleranceCm = 3.0;
-	double bowVectorToleranceCm = 2.0;
-	result.isInterRefLhsInsideStringAndBow = (isPointWithinLineSegment(result.interRefLhs.p1, result.posStrRefBridge - stringVectorToleranceCm*strRefVectorNorm, result.posStrRefFb + stringVectorToleranceCm*strRefVectorNorm) &&
-		isPointWithinLineSegment(result.interRefLhs.p2, result.posBowFrogLhs - bowVectorToleranceCm*bowVectorNormLhs, result.posBowTipLhs + bowVectorToleranceCm*bowVectorNormLhs));
-	result.isInterRefRhsInsideStringAndBow = (isPointWithinLineSegment(result.interRefRhs.p1, result.posStrRefBridge - stringVectorToleranceCm*strRefVectorNorm, result.posStrRefFb + stringVectorToleranceCm*strRefVectorNorm) &&
-		isPointWithinLineSegment(result.interRefRhs.p2, result.posBowFrogRhs - bowVectorToleranceCm*bowVectorNormRhs, result.posBowTipRhs + bowVectorToleranceCm*bowVectorNormRhs));
+	// tolerance, see DescriptorGeometry.hxx):
+	result.isInterRefLhsInsideStringAndBow = isInsideStringAndBow(result.interRefLhs.p1, result.interRefLhs.p2, result.posStrRefBridge, result.posStrRefFb, result.posBowFrogLhs, result.posBowTipLhs);
+	result.isInterRefRhsInsideStringAndBow = isInsideStringAndBow(result.interRefRhs.p1, result.interRefRhs.p2, result.posStrRefBridge, result.posStrRefFb, result.posBowFrogRhs, result.posBowTipRhs);
 
+	result.isOutOfContact = false;
 	if (!result.isInterRefLhsInsideStringAndBow && !result.isInterRefRhsInsideStringAndBow)
 	{
 		result.playedString = 0; // no string being played
 	}
 
 	// Compute approximation of bow stick:
-	{
-		Matrix3x1 v_left;
-		Matrix3x1 v_fwd;
-		Matrix3x1 v_up;
-
-		const Matrix3x1 &frog_lhs_with_stick_top = frog_rhs;
-		const Matrix3x1 &frog_rhs_with_stick_top = frog_lhs;
-		const Matrix3x1 &tip_lhs_with_stick_top = tip_rhs;
-		const Matrix3x1 &tip_rhs_with_stick_top = tip_lhs;
-		
-		// vector pointing left (with hair ribbon bottom, stick top)
-		// note: left - right means right pointing to left
-		v_left = normalize(frog_lhs_with_stick_top - frog_rhs_with_stick_top);
-		// vector pointing forward
-		// note: using lhs or rhs shouldn't really matter
-		v_fwd = normalize(tip_rhs_with_stick_top - frog_rhs_with_stick_top);
-		// vector pointing downward
-		// note: cross product of two normalized vector is a normalized vector
-		v_up = cross(v_fwd, v_left);
-
-		Matrix3x1 frog_center = (frog_lhs_with_stick_top + frog_rhs_with_stick_top)*0.5;
-		Matrix3x1 tip_center = (tip_lhs_with_stick_top + tip_rhs_with_stick_top)*0.5;
-
-		double stickHairDistanceCm = 1.0; // at most narrow part, conservative approximation (we don't want absolute distance wrapping when hitting bridge)
-
-		result.bowStickFrog = frog_center + stickHairDistanceCm*v_up;
-		result.bowStickTip = tip_center + stickHairDistanceCm*v_up;
-	}
+	if (isComputingDescriptorInputs)
+		computeBowStick(result);
+}
 
-	return result;
+// Approximation of the bow stick (bowStickFrog, bowStickTip) from the bow points of result:
+inline void ComputeViolinPeformanceDescriptors::computeBowStick(Derived3dData &result)
+{
+	::computeBowStick(result.posBowFrogLhs, result.posBowFrogRhs, result.posBowTipLhs, result.posBowTipRhs, result.bowStickFrog, result.bowStickTip); // (see DescriptorGeometry.hxx)
+}
+
+// Marks result as a frame skipped by the contact gate if the bow is out of contact (see 
+// setContactGateDistance()), with the values of a frame that isn't played. Only the bow 
+// stick is computed (for the stick-bridge distance, see computeViolinPerformanceDescriptors()).
+inline bool ComputeViolinPeformanceDescriptors::gateOutOfContact(Derived3dData &result)
+{
+	if (!isBowOutOfContact(result))
+		return false;
+
+	++numGatedFrames_;
+	result.isOutOfContact = true;
+	result.isInterRefLhsInsideStringAndBow = false;
+	result.isInterRefRhsInsideStringAndBow = false;
+	result.playedString = 0;
+	result.bowTiltAngleDegrees = 0.0f;
+	result.bowTiltAngleZDegrees = 0.0f;
+	result.bowBridgeAngleDegrees = 0.0f;
+	if (derived3dFields_ & Derived3dData::DESCRIPTOR_INPUTS)
+		computeBowStick(result);
+	return true;
 }
 
+// Length of the smallest line between the bow stick and the top of the bridge (strings 2 
+// and 3 at the bridge):
+inline double ComputeViolinPeformanceDescriptors::computeStickBridgeDistance(const Derived3dData &derived3dData)
+{
+	return ::computeStickBridgeDistance(derived3dData.posStr2Bridge, derived3dData.posStr3Bridge, derived3dData.bowStickFrog, derived3dData.bowStickTip); // (see DescriptorGeometry.hxx)
+}
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-inline ViolinPerformanceDescriptors ComputeViolinPeformanceDescriptors::computeViolinPerformanceDescriptors(const RawSensorData &rawSensorData, const Derived3dData &derived3dData, bool zeroDescriptorsWhenNotPlaying, int numViolins, int iViolin, bool computeForce)
+inline ViolinPerformanceDescriptors ComputeViolinPeformanceDescriptors::computeViolinPerformanceDescriptors(const RawSensorData &rawSensorData, const Derived3dData &derived3dData, bool zeroDescriptorsWhenNotPlaying, int numViolins, int iViolin, bool computeForce, float derivativeRate)
 {
 	ViolinPerformanceDescriptors result;
 	const double pesudoForceOffset=0.0; //cm
 
+	if (derived3dData.isOutOfContact && !zeroDescriptorsWhenNotPlaying)
+	{
+		// The caller wants the values of frames that aren't played, complete the geometry the gate skipped:
+		Derived3dData completed = derived3dData;
+		computeContactGeometry(completed, true);
+		return computeViolinPerformanceDescriptors(rawSensorData, completed, false, numViolins, iViolin, computeForce, derivativeRate);
+	}
+
+	if (derived3dData.isOutOfContact)
+	{
+		// Not played (as below). The smoother is fed the same bow displacement and the 
+		// stick-bridge distance is the same as for a frame that isn't gated:
+		const Line3 interRefLhs = smallestLineBetweenTwoLines(Line3(derived3dData.posStrRefBridge, derived3dData.posStrRefFb), Line3(derived3dData.posBowFrogLhs, derived3dData.posBowTipLhs));
+		result.bowForceLhs = -1000.0;
+		result.bowForceRhs = -1000.0;
+		result.bowForce = -1000.0;
+		result.bowDisplacement = 0.0;
+		result.bowBridgeDistance = 0.0;
+		result.stickBridgeDistance = computeStickBridgeDistance(derived3dData);
+		const float bowDisplacement = (float)computeBowDisplacement(derived3dData.posBowFrogLhs, interRefLhs.p2);
+		float bowVelSmooth, bowAccelSmooth;
+		bowDerivatives_.process(&bowDisplacement, derivativeRate, &bowVelSmooth, &bowAccelSmooth);
+		result.bowVel = 0.0;
+		result.bowAccel = 0.0;
+		return result;
+	}
+
 	// Aliases of variables in structs:
 	const Line3 &inter1Lhs = derived3dData.inter1Lhs;
 	const Line3 &inter1Rhs = derived3dData.inter1Rhs;
@@ -1217,17 +1362,13 @@ inline ViolinPerformanceDescriptors ComputeViolinPeformanceDescriptors::computeV
 	// Compute bow force:
 	double bowLength = euclidean_length(derived3dData.posBowTipLhs - derived3dData.posBowFrogLhs);
 
-	result.bowForceLhs = euclidean_length(interRefLhs.p2 - interRefLhs.p1)+pesudoForceOffset; // absolute length
-	if (euclidean_length(interRefLhs.p1 - violinBodySensPos) < euclidean_length(interRefLhs.p2 - violinBodySensPos)+pesudoForceOffset) // bow is farther away than string, assume not playing
-		result.bowForceLhs = -result.bowForceLhs;
-
-	result.bowForceRhs = euclidean_length(interRefRhs.p2 - interRefRhs.p1)+pesudoForceOffset; // absolute length
-	if (euclidean_length(interRefRhs.p1 - violinBodySensPos) < euclidean_length(interRefRhs.p2 - violinBodySensPos)+pesudoForceOffset) // bow is farther away than string, assume not playing
-		result.bowForceRhs = -result.bowForceRhs;
+	// (absolute length, negative when the bow is farther away than string, assume not playing):
+	result.bowForceLhs = computePseudoForce(interRefLhs.p1, interRefLhs.p2, violinBodySensPos, pesudoForceOffset);
+	result.bowForceRhs = computePseudoForce(interRefRhs.p1, interRefRhs.p2, violinBodySensPos, pesudoForceOffset);
 
 	//result.bowForce = bowForceHairRibbon(result.bowDisplacement,result.bowForceLhs,result.bowForceRhs,bowLength);
 	if (computeForce)
-		result.bowForce = HairStickForce(result.bowDisplacement,b_ + cos(correctionAngle_)*result.bowForceLhs + sin(correctionAngle_)*result.bowDisplacement,b_ + cos(correctionAngle_)*result.bowForceRhs + sin(correctionAngle_)*result.bowDisplacement, bowLength);
+		result.bowForce = computeBowForce(result.bowDisplacement, result.bowForceLhs, result.bowForceRhs, bowLength);
 		//result.bowForce = HairStickForce(result.bowDisplacement,result.bowForceLhs,result.bowForceRhs,bowLength);
 
 	/****OLD FORCE CALCULATION*********************
@@ -1241,27 +1382,17 @@ inline ViolinPerformanceDescriptors ComputeViolinPeformanceDescriptors::computeV
 	result.bowBridgeDistance = euclidean_length(inter1Rhs.p1 - posStr1Bridge); // rhs because it is closest to bridge
 
 	// Compute bow stick-bridge (top) distance:
-	Line3 lineBridgeTop = Line3(derived3dData.posStr2Bridge, derived3dData.posStr3Bridge);
-	Line3 lineBowStick = Line3(derived3dData.bowStickTip, derived3dData.bowStickFrog);
-	Line3 lineBetweenStickAndBridge = smallestLineBetweenTwoLines(lineBridgeTop, lineBowStick);
-	result.stickBridgeDistance = euclidean_length(lineBetweenStickAndBridge.p1 - lineBetweenStickAndBridge.p2);
+	result.stickBridgeDistance = computeStickBridgeDistance(derived3dData);
 
 //	if (!isPointWithinLineSegment(lineBetweenStickAndBridge.p1, lineBridgeTop.p1, lineBridgeTop.p2) ||
 //		!isPointWithinLineSegment(lineBetweenStickAndBridge.p2, lineBowStick.p1, lineBowStick.p2))
 //		result.stickBridgeDistance = 1000.0; // very big (outside of display's range)
 
-	// Compute bow velocity:
-	float bowVel = compBowVel_.compute((float)result.bowDisplacement, 240.0f);
-	float bowVelSmooth;
-	bowVelSmoother_.process(&bowVel, &bowVelSmooth, 1);
+	// Compute bow velocity and acceleration:
+	const float bowDisplacement = (float)result.bowDisplacement;
+	float bowVelSmooth, bowAccelSmooth;
+	bowDerivatives_.process(&bowDisplacement, derivativeRate, &bowVelSmooth, &bowAccelSmooth);
 	result.bowVel = bowVelSmooth;
-
-	// Compute bow acceleration:
-	float bowAccel = compBowAccel_.compute(bowVel, 240.0f);
-	float bowAccelSmooth;
-	bowAccelSmoother1_.process(&bowAccel, &bowAccelSmooth, 1);
-	bowAccelSmoother2_.process(&bowAccelSmooth, &bowAccelSmooth, 1);
-	bowAccelSmoother3_.process(&bowAccelSmooth, &bowAccelSmooth, 1);
 	result.bowAccel = bowAccelSmooth;
 
 	// Check if descriptors are valid:
@@ -1282,40 +1413,46 @@ inline ViolinPerformanceDescriptors ComputeViolinPeformanceDescriptors::computeV
 
 // ---------------------------------------------------------------------------------------
 
-// note that lines defined by l1 and l2 are extended to an infinite length 
-// so result may not be inside line segments defined by l1 and l2
-inline Line3 ComputeViolinPeformanceDescriptors::smallestLineBetweenTwoLines(const Line3 &l1, const Line3 &l2)
+// Separating axis test of the axis aligned bounding boxes of the bow hair (frog/tip, lhs and 
+// rhs) and of the strings (bridge/fingerboard ends of all strings): a lower bound of the 
+// distance between bow and strings, from 12 points and no square roots.
+inline bool ComputeViolinPeformanceDescriptors::isBowOutOfContact(const Derived3dData &derived3dData) const
 {
-	const Matrix3x1 p13 = l1.p1 - l2.p1;
-
-	const Matrix3x1 p43 = l2.p2 - l2.p1; // length of line 2
-	// XXX: check if not very small (<- especially this one, because div zero below)
-	
-	const Matrix3x1 p21 = l1.p2 - l1.p1; // length of line 1
-	// XXX: check if not very small
-
-	// XXX: if p21 or p43 is really small, probably change to case of distance between 
-	// line and point or between point and point
-
-	const double d1343 = dot(p13, p43);//sum(times(p13, p43));
-	const double d4321 = dot(p43, p21);//sum(times(p43, p21));
-	const double d1321 = dot(p13, p21);//sum(times(p13, p21));
-	const double d4343 = dot(p43, p43);//sum(times(p43, p43));
-	const double d2121 = dot(p21, p21);//sum(times(p21, p21));
-
-	const double denom = d2121*d4343 - d4321*d4321;
-	// XXX: check if not very small
+	if (contactGateDistanceCm_ <= 0.0)
+		return false;
 
-	const double numer = d1343*d4321 - d1321*d4343;
+	const Matrix3x1 *bowPoints[4] = { &derived3dData.posBowFrogLhs, &derived3dData.posBowTipLhs, &derived3dData.posBowFrogRhs, &derived3dData.posBowTipRhs };
+	const Matrix3x1 *stringPoints[8] = { &derived3dData.posStr1Bridge, &derived3dData.posStr2Bridge, &derived3dData.posStr3Bridge, &derived3dData.posStr4Bridge, 
+		&derived3dData.posStr1Fb, &derived3dData.posStr2Fb, &derived3dData.posStr3Fb, &derived3dData.posStr4Fb };
 
-	const double mu1 = numer/denom;
-	const double mu2 = (d1343 + d4321*mu1)/d4343;
-	// NOTE: if p43 isn't very small d4343 can't be very small either
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		double bowMin = (*bowPoints[0])(axis, 0), bowMax = bowMin;
+		for (int i = 1; i < 4; ++i)
+		{
+			const double v = (*bowPoints[i])(axis, 0);
+			bowMin = (v < bowMin) ? v : bowMin;
+			bowMax = (v > bowMax) ? v : bowMax;
+		}
+		double stringMin = (*stringPoints[0])(axis, 0), stringMax = stringMin;
+		for (int i = 1; i < 8; ++i)
+		{
+			const double v = (*stringPoints[i])(axis, 0);
+			stringMin = (v < stringMin) ? v : stringMin;
+			stringMax = (v > stringMax) ? v : stringMax;
+		}
+		if (bowMin > stringMax + contactGateDistanceCm_ || stringMin > bowMax + contactGateDistanceCm_)
+			return true;
+	}
+	return false;
+}
 
+// note that lines defined by l1 and l2 are extended to an infinite length 
+// so result may not be inside line segments defined by l1 and l2
+inline Line3 ComputeViolinPeformanceDescriptors::smallestLineBetweenTwoLines(const Line3 &l1, const Line3 &l2)
+{
 	Line3 result;
-	result.p1 = l1.p1 + p21*mu1; // point on line 1
-	result.p2 = l2.p1 + p43*mu2; // point on line 2
-
+	closestPointsBetweenLines(l1.p1, l1.p2, l2.p1, l2.p2, result.p1, result.p2); // (see DescriptorGeometry.hxx)
 	return result;
 }
 
@@ -1323,23 +1460,7 @@ inline Line3 ComputeViolinPeformanceDescriptors::smallestLineBetweenTwoLines(con
 // whether p0 lies within segment defined by p1 and p2 or lies outside of that segment
 inline bool ComputeViolinPeformanceDescriptors::isPointWithinLineSegment(const Matrix3x1 &p0, const Matrix3x1 &p1, const Matrix3x1 &p2)
 {
-	const double xMin = std::min(p1(0, 0), p2(0, 0));
-	const double xMax = std::max(p1(0, 0), p2(0, 0));
-	const double yMin = std::min(p1(1, 0), p2(1, 0));
-	const double yMax = std::max(p1(1, 0), p2(1, 0));
-	const double zMin = std::min(p1(2, 0), p2(2, 0));
-	const double zMax = std::max(p1(2, 0), p2(2, 0));
-
-	if (p0(0, 0) >= xMin && p0(0, 0) <= xMax &&
-		p0(1, 0) >= yMin && p0(1, 0) <= yMax &&
-		p0(2, 0) >= zMin && p0(2, 0) <= zMax)
-	{
-		return true;
-	}
-	else
-	{
-		return false;
-	}
+	return ::isPointWithinLineSegment(p0, p1, p2); // (see DescriptorGeometry.hxx)
 }
 
 inline double ComputeViolinPeformanceDescriptors::bowForceHairRibbon(double x /*Bow Displacement*/, 
@@ -1434,6 +1555,11 @@ inline double ComputeViolinPeformanceDescriptors::HairStickForce(double x /*Bow
 	return force;
 }
 
+inline double ComputeViolinPeformanceDescriptors::computeBowForce(double bowDisplacement, double bowForceLhs, double bowForceRhs, double bowLength)
+{
+	return HairStickForce(bowDisplacement, b_ + cos(correctionAngle_)*bowForceLhs + sin(correctionAngle_)*bowDisplacement, b_ + cos(correctionAngle_)*bowForceRhs + sin(correctionAngle_)*bowDisplacement, bowLength);
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 //inline void ComputeViolinPeformanceDescriptors::computeBowForce()
@@ -1443,8 +1569,7 @@ inline double ComputeViolinPeformanceDescriptors::HairStickForce(double x /*Bow
 inline double ComputeViolinPeformanceDescriptors::computeBowDisplacement(const Matrix3x1 &bowFrog, const Matrix3x1 &pointOnSmallestLineBetweenPlayedStringAndBowHairRibbonAtBowHairRibbon)
 {
 	// compute distance (in cm) between point of line on bow to bow frog:
-	Matrix3x1 tmp = pointOnSmallestLineBetweenPlayedStringAndBowHairRibbonAtBowHairRibbon - bowFrog;
-	return euclidean_length(tmp);
+	return ::computeBowDisplacement(bowFrog, pointOnSmallestLineBetweenPlayedStringAndBowHairRibbonAtBowHairRibbon); // (see DescriptorGeometry.hxx)
 }
 
 // ---------------------------------------------------------------------------------------
@@ -14,7 +14,7 @@
 #undef max
 #include <algorithm>
 
-#include "FilterFir.hxx"
+#include "FilterFirLinear.hxx"
 #include "WindowGen.hxx"
 #include "Derivative2.hxx"
 #include "utils.h"
@@ -47,7 +47,7 @@ inline Matrix3x1 computeBeta(const Matrix3x1 &point, const Matrix3x1 &refSensPos
 {
 	Matrix3x1 result;
 	Matrix3x3 rot = Matrix3x3::rotation_matrix_zyx(refSensOrientation(0, 0), refSensOrientation(1, 0), refSensOrientation(2, 0));
-	Matrix3x3 invRot = inverse(rot);
+	Matrix3x3 invRot = transpose(rot); // (inverse of a rotation)
 	result = invRot*(point - refSensPos);
 	return result;
 }
@@ -314,24 +314,24 @@ private:
 	ComputeSensorVelocityAndAcceleration sens3VelAndAccel_;
 
 	Derivative2 compBowVel_;
-	FilterFir bowVelSmoother_;
+	FilterFirLinear bowVelSmoother_;
 
 	Derivative2 compBowAccel_;
-	FilterFir bowAccelSmoother1_;
-	FilterFir bowAccelSmoother2_;
-	FilterFir bowAccelSmoother3_;
+	FilterFirLinear bowAccelSmoother1_;
+	FilterFirLinear bowAccelSmoother2_;
+	FilterFirLinear bowAccelSmoother3_;
 
-	FilterFir inclinationSmoother_;
+	FilterFirLinear inclinationSmoother_;
 	ComputePlayedStringFromAngleWithHysteresis stringEstHysteresis_;
 
-	FilterFir inclinationZSmoother_;
+	FilterFirLinear inclinationZSmoother_;
 
 	Line3 smallestLineBetweenTwoLines(const Line3 &l1, const Line3 &l2);
 	bool isPointWithinLineSegment(const Matrix3x1 &p0, const Matrix3x1 &p1, const Matrix3x1 &p2);
 
 	double computeBowDisplacement(const Matrix3x1 &bowFrog, const Matrix3x1 &pointOnSmallestLineBetweenPlayedStringAndBowHairRibbonAtBowHairRibbon);
 
-	void initSmoothingFilter(FilterFir &filter, int size);
+	void initSmoothingFilter(FilterFirLinear &filter, int size);
 };
 
 // ---------------------------------------------------------------------------------------
@@ -348,7 +348,7 @@ inline ComputeViolinPeformanceDescriptors::ComputeViolinPeformanceDescriptors()
 	initSmoothingFilter(inclinationZSmoother_, 5);
 }
 
-inline void ComputeViolinPeformanceDescriptors::initSmoothingFilter(FilterFir &filter, int size)
+inline void ComputeViolinPeformanceDescriptors::initSmoothingFilter(FilterFirLinear &filter, int size)
 {
 	if (size <= 0)
 		return;
@@ -0,0 +1,257 @@
+#ifndef INCLUDED_DESCRIPTORGEOMETRY_HXX
+#define INCLUDED_DESCRIPTORGEOMETRY_HXX
+
+#include "SimpleMatrix.hxx"
+#include <cmath>
+
+#define NOMINMAX // avoid min/max macros from windows.h
+#include <algorithm>
+
+// The stateless geometry of the descriptor computations (see ComputeViolinPeformanceDescriptors),
+// templated on the scalar type so it can run in single precision (Matrix3x1f etc.): key
+// points from the sensor poses, the smallest lines between the bow hair and the played
+// string, the contact test, bow displacement, pseudo force distances, bow-bridge and
+// stick-bridge distances and the bow angles. Smoothers, string estimation (hysteresis)
+// and the force solver are stateful or scalar and stay in ComputeViolinPeformanceDescriptors,
+// which computes its geometry in double precision through the same helpers below.
+
+// ---------------------------------------------------------------------------------------
+
+// Closest points of the lines through a1, a2 and through b1, b2 (extended to an infinite
+// length, so they may be outside of the segments):
+template <typename T>
+inline void closestPointsBetweenLines(const Matrix3x1T<T> &a1, const Matrix3x1T<T> &a2, const Matrix3x1T<T> &b1, const Matrix3x1T<T> &b2, Matrix3x1T<T> &onA, Matrix3x1T<T> &onB)
+{
+	const Matrix3x1T<T> p13 = a1 - b1;
+
+	const Matrix3x1T<T> p43 = b2 - b1; // length of line 2
+	// XXX: check if not very small (<- especially this one, because div zero below)
+
+	const Matrix3x1T<T> p21 = a2 - a1; // length of line 1
+	// XXX: check if not very small
+
+	const T d1343 = dot(p13, p43);
+	const T d4321 = dot(p43, p21);
+	const T d1321 = dot(p13, p21);
+	const T d4343 = dot(p43, p43);
+	const T d2121 = dot(p21, p21);
+
+	const T denom = d2121*d4343 - d4321*d4321;
+	// XXX: check if not very small
+
+	const T numer = d1343*d4321 - d1321*d4343;
+
+	const T mu1 = numer/denom;
+	const T mu2 = (d1343 + d4321*mu1)/d4343;
+	// NOTE: if p43 isn't very small d4343 can't be very small either
+
+	onA = a1 + p21*mu1;
+	onB = b1 + p43*mu2;
+}
+
+// Assuming p0 is on the (infinite length) line through p1 and p2, whether it lies within
+// the segment between p1 and p2:
+template <typename T>
+inline bool isPointWithinLineSegment(const Matrix3x1T<T> &p0, const Matrix3x1T<T> &p1, const Matrix3x1T<T> &p2)
+{
+	for (int i = 0; i < 3; ++i)
+	{
+		if (p0(i, 0) < (std::min)(p1(i, 0), p2(i, 0)) || p0(i, 0) > (std::max)(p1(i, 0), p2(i, 0)))
+			return false;
+	}
+	return true;
+}
+
+// Angle (degrees) between two vectors:
+template <typename T>
+inline T angleDegrees(const Matrix3x1T<T> &v1, const Matrix3x1T<T> &v2)
+{
+	const T pi = (T)3.1415926535897932384626433832795;
+	return std::acos(dot(v1, v2)/(euclidean_length(v1)*euclidean_length(v2)))/pi*(T)180;
+}
+
+// ---------------------------------------------------------------------------------------
+
+// Bridge frame: middle of the bridge (strings 2 and 3) and the normalized vectors pointing
+// left (string 1 to 4), forward (towards the fingerboard) and up:
+template <typename T>
+inline void computeBridgeFrame(const Matrix3x1T<T> &str1Bridge, const Matrix3x1T<T> &str2Bridge, const Matrix3x1T<T> &str3Bridge, const Matrix3x1T<T> &str4Bridge,
+	const Matrix3x1T<T> &str2Fb, const Matrix3x1T<T> &str3Fb, Matrix3x1T<T> &middle, Matrix3x1T<T> &left, Matrix3x1T<T> &fwd, Matrix3x1T<T> &up)
+{
+	middle = (str2Bridge + str3Bridge)/2;
+	left = normalize(str4Bridge - str1Bridge);
+	fwd = normalize((str2Fb + str3Fb)/2 - middle);
+	up = cross(fwd, left); // NOTE: fwd x left gives up
+}
+
+// Frog frame (hair ribbon bottom, stick top): normalized vectors pointing left (frog lhs to
+// rhs), forward (towards the tip) and up (towards the stick):
+template <typename T>
+inline void computeFrogFrame(const Matrix3x1T<T> &bowFrogLhs, const Matrix3x1T<T> &bowFrogRhs, const Matrix3x1T<T> &bowTipLhs, 
+	Matrix3x1T<T> &left, Matrix3x1T<T> &fwd, Matrix3x1T<T> &up)
+{
+	left = normalize(bowFrogRhs - bowFrogLhs);
+	fwd = normalize(bowTipLhs - bowFrogLhs);
+	up = cross(fwd, left);
+}
+
+// Approximation of the bow stick, 1 cm above the middle of the hair ribbon (at most narrow
+// part, conservative approximation: we don't want absolute distance wrapping when hitting
+// the bridge):
+template <typename T>
+inline void computeBowStick(const Matrix3x1T<T> &bowFrogLhs, const Matrix3x1T<T> &bowFrogRhs, const Matrix3x1T<T> &bowTipLhs, const Matrix3x1T<T> &bowTipRhs, 
+	Matrix3x1T<T> &stickFrog, Matrix3x1T<T> &stickTip)
+{
+	Matrix3x1T<T> left, fwd, up;
+	computeFrogFrame(bowFrogLhs, bowFrogRhs, bowTipLhs, left, fwd, up);
+
+	const T stickHairDistanceCm = 1;
+	stickFrog = (bowFrogRhs + bowFrogLhs)*(T)0.5 + stickHairDistanceCm*up;
+	stickTip = (bowTipRhs + bowTipLhs)*(T)0.5 + stickHairDistanceCm*up;
+}
+
+// Whether the smallest line between a string and the bow hair (closest points onString and
+// onBow) lies inside both, with tolerance to avoid descriptors going to 0 at extrema when
+// there is some inaccuracy with the calibration:
+template <typename T>
+inline bool isInsideStringAndBow(const Matrix3x1T<T> &onString, const Matrix3x1T<T> &onBow, 
+	const Matrix3x1T<T> &strBridge, const Matrix3x1T<T> &strFb, const Matrix3x1T<T> &bowFrog, const Matrix3x1T<T> &bowTip)
+{
+	const T stringVectorToleranceCm = 3;
+	const T bowVectorToleranceCm = 2;
+	const Matrix3x1T<T> strVectorNorm = normalize(strFb - strBridge); // bridge pointing towards fb
+	const Matrix3x1T<T> bowVectorNorm = normalize(bowTip - bowFrog); // frog pointing towards tip
+	return isPointWithinLineSegment(onString, strBridge - stringVectorToleranceCm*strVectorNorm, strFb + stringVectorToleranceCm*strVectorNorm) &&
+		isPointWithinLineSegment(onBow, bowFrog - bowVectorToleranceCm*bowVectorNorm, bowTip + bowVectorToleranceCm*bowVectorNorm);
+}
+
+// Bow displacement (cm): distance from the frog to the closest point on the bow hair:
+template <typename T>
+inline T computeBowDisplacement(const Matrix3x1T<T> &bowFrog, const Matrix3x1T<T> &onBow)
+{
+	return euclidean_length(onBow - bowFrog);
+}
+
+// Pseudo force distance (cm, see ViolinPerformanceDescriptors): length of the smallest line
+// between string and bow hair, negative when the bow is farther away from the violin body
+// sensor than the string (not playing):
+template <typename T>
+inline T computePseudoForce(const Matrix3x1T<T> &onString, const Matrix3x1T<T> &onBow, const Matrix3x1T<T> &violinBodyPos, T offsetCm)
+{
+	const T result = euclidean_length(onBow - onString) + offsetCm;
+	if (euclidean_length(onString - violinBodyPos) < euclidean_length(onBow - violinBodyPos) + offsetCm)
+		return -result;
+	return result;
+}
+
+// Length of the smallest line between the bow stick and the top of the bridge (strings 2
+// and 3 at the bridge):
+template <typename T>
+inline T computeStickBridgeDistance(const Matrix3x1T<T> &str2Bridge, const Matrix3x1T<T> &str3Bridge, const Matrix3x1T<T> &stickFrog, const Matrix3x1T<T> &stickTip)
+{
+	Matrix3x1T<T> onBridge, onStick;
+	closestPointsBetweenLines(str2Bridge, str3Bridge, stickTip, stickFrog, onBridge, onStick);
+	return euclidean_length(onBridge - onStick);
+}
+
+// ---------------------------------------------------------------------------------------
+
+// Key points of an instrument: calibrated betas (relative to the violin body and bow
+// sensors), or the same points rotated and translated by the sensor poses (cm).
+template <typename T>
+struct InstrumentKeyPointsT
+{
+	Matrix3x1T<T> strBridge[4]; // string 1 to 4
+	Matrix3x1T<T> strFb[4];
+	Matrix3x1T<T> bowFrogLhs;
+	Matrix3x1T<T> bowFrogRhs;
+	Matrix3x1T<T> bowTipLhs;
+	Matrix3x1T<T> bowTipRhs;
+};
+
+template <typename T>
+struct DescriptorGeometryT
+{
+	InstrumentKeyPointsT<T> points;
+
+	T bowInclinationDegrees; // (not smoothed)
+	T bowTiltAngleDegrees;
+	T bowBridgeAngleDegrees;
+
+	// Smallest lines between the played string and the bow hair are inside both (lhs or
+	// rhs), see Derived3dData::isInterRefLhsInsideStringAndBow:
+	bool isInContact;
+
+	T bowDisplacement; // cm
+	T bowForceLhs; // pseudo force distances (cm, see ViolinPerformanceDescriptors)
+	T bowForceRhs;
+	T bowBridgeDistance; // cm
+	T stickBridgeDistance; // cm
+	T bowLength; // cm (force solver input)
+};
+
+// Geometry of a frame from the violin body and bow sensor poses (positions in cm, zyx
+// euler angles in radians) for the given played string (1 to 4), as
+// ComputeViolinPeformanceDescriptors::computeDerived3dData() and
+// computeViolinPerformanceDescriptors() compute it while not calibrating force.
+template <typename T>
+inline void computeDescriptorGeometry(const InstrumentKeyPointsT<T> &betas,
+	const Matrix3x1T<T> &violinPos, const Matrix3x1T<T> &violinOrientation,
+	const Matrix3x1T<T> &bowPos, const Matrix3x1T<T> &bowOrientation,
+	int playedString, DescriptorGeometryT<T> &result)
+{
+	InstrumentKeyPointsT<T> &p = result.points;
+
+	// Key points:
+	const Matrix3x3T<T> violinRotMat = Matrix3x3T<T>::rotation_matrix_zyx(violinOrientation(0, 0), violinOrientation(1, 0), violinOrientation(2, 0));
+	const Matrix3x3T<T> bowRotMat = Matrix3x3T<T>::rotation_matrix_zyx(bowOrientation(0, 0), bowOrientation(1, 0), bowOrientation(2, 0));
+	for (int i = 0; i < 4; ++i)
+	{
+		p.strBridge[i] = violinRotMat*betas.strBridge[i] + violinPos;
+		p.strFb[i] = violinRotMat*betas.strFb[i] + violinPos;
+	}
+	p.bowFrogLhs = bowRotMat*betas.bowFrogLhs + bowPos;
+	p.bowFrogRhs = bowRotMat*betas.bowFrogRhs + bowPos;
+	p.bowTipLhs = bowRotMat*betas.bowTipLhs + bowPos;
+	p.bowTipRhs = bowRotMat*betas.bowTipRhs + bowPos;
+
+	const int iRef = (std::min)((std::max)(playedString, 1), 4) - 1;
+	const Matrix3x1T<T> &strRefBridge = p.strBridge[iRef];
+	const Matrix3x1T<T> &strRefFb = p.strFb[iRef];
+
+	// Bridge and hair ribbon vectors, angles:
+	Matrix3x1T<T> m_br, v_br_left, v_br_fwd, v_br_up;
+	computeBridgeFrame(p.strBridge[0], p.strBridge[1], p.strBridge[2], p.strBridge[3], p.strFb[1], p.strFb[2], m_br, v_br_left, v_br_fwd, v_br_up);
+	const Matrix3x1T<T> v_hr = p.bowTipLhs - p.bowFrogLhs;
+	result.bowInclinationDegrees = angleDegrees(v_br_up, v_hr) - (T)90;
+
+	Matrix3x1T<T> v_fr_left, v_fr_fwd, v_fr_up;
+	computeFrogFrame(p.bowFrogLhs, p.bowFrogRhs, p.bowTipLhs, v_fr_left, v_fr_fwd, v_fr_up);
+	result.bowTiltAngleDegrees = angleDegrees(strRefBridge - strRefFb, v_fr_up) - (T)90;
+	result.bowBridgeAngleDegrees = angleDegrees(v_br_left, v_hr);
+
+	// Smallest lines between the bow hair and the played string (and string 1 for the
+	// bow-bridge distance), first point on the string:
+	Matrix3x1T<T> interRefLhs1, interRefLhs2, interRefRhs1, interRefRhs2, inter1Rhs1, inter1Rhs2;
+	closestPointsBetweenLines(strRefBridge, strRefFb, p.bowFrogLhs, p.bowTipLhs, interRefLhs1, interRefLhs2);
+	closestPointsBetweenLines(strRefBridge, strRefFb, p.bowFrogRhs, p.bowTipRhs, interRefRhs1, interRefRhs2);
+	closestPointsBetweenLines(p.strBridge[0], p.strFb[0], p.bowFrogRhs, p.bowTipRhs, inter1Rhs1, inter1Rhs2);
+
+	// Contact:
+	result.isInContact = isInsideStringAndBow(interRefLhs1, interRefLhs2, strRefBridge, strRefFb, p.bowFrogLhs, p.bowTipLhs) || 
+		isInsideStringAndBow(interRefRhs1, interRefRhs2, strRefBridge, strRefFb, p.bowFrogRhs, p.bowTipRhs);
+
+	// Descriptors:
+	result.bowDisplacement = computeBowDisplacement(p.bowFrogLhs, interRefLhs2);
+	result.bowForceLhs = computePseudoForce(interRefLhs1, interRefLhs2, violinPos, (T)0);
+	result.bowForceRhs = computePseudoForce(interRefRhs1, interRefRhs2, violinPos, (T)0);
+	result.bowBridgeDistance = euclidean_length(inter1Rhs1 - p.strBridge[0]);
+	result.bowLength = euclidean_length(p.bowTipLhs - p.bowFrogLhs);
+
+	// Bow stick to the top of the bridge:
+	Matrix3x1T<T> stickFrog, stickTip;
+	computeBowStick(p.bowFrogLhs, p.bowFrogRhs, p.bowTipLhs, p.bowTipRhs, stickFrog, stickTip);
+	result.stickBridgeDistance = computeStickBridgeDistance(p.strBridge[1], p.strBridge[2], stickFrog, stickTip);
+}
+
+#endif
@@ -0,0 +1,334 @@
+#define NOMINMAX // avoid min/max macros from windows.h
+#include "DescriptorRing.hxx"
+
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+// ---------------------------------------------------------------------------------------
+
+namespace
+{
+	const int maxCapacity = 1 << 20;
+
+	int roundUpToPowerOfTwo(int n)
+	{
+		int result = 1;
+		while (result < n && result < maxCapacity)
+			result *= 2;
+		return result;
+	}
+
+	DWORD mappingSize(DWORD capacity)
+	{
+		return (DWORD)(sizeof(DescriptorRingHeader) + capacity*sizeof(DescriptorRingSlot));
+	}
+
+	LONG completedSequence(LONG recordNumber)
+	{
+		return (LONG)(2*(DWORD)recordNumber + 2);
+	}
+
+	LONGLONG getTicks()
+	{
+		LARGE_INTEGER ticks;
+		::QueryPerformanceCounter(&ticks);
+		return ticks.QuadPart;
+	}
+}
+
+// ---------------------------------------------------------------------------------------
+
+DescriptorRingWriter::DescriptorRingWriter()
+{
+	mapping_ = NULL;
+	header_ = NULL;
+	slots_ = NULL;
+	curSlot_ = NULL;
+}
+
+DescriptorRingWriter::~DescriptorRingWriter()
+{
+	close();
+}
+
+bool DescriptorRingWriter::open(const char *name, int capacity)
+{
+	close();
+
+	const DWORD numSlots = (DWORD)roundUpToPowerOfTwo(std::max(capacity, 2));
+	mapping_ = ::CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, mappingSize(numSlots), name);
+	if (mapping_ == NULL)
+		return false;
+	const bool isExisting = (::GetLastError() == ERROR_ALREADY_EXISTS);
+
+	void *view = ::MapViewOfFile(mapping_, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+	if (view == NULL)
+	{
+		::CloseHandle(mapping_);
+		mapping_ = NULL;
+		return false;
+	}
+	header_ = (DescriptorRingHeader *)view;
+	slots_ = (DescriptorRingSlot *)(header_ + 1);
+
+	if (isExisting)
+	{
+		// Continue the sequence if the layout is the same (existing readers keep following):
+		MEMORY_BASIC_INFORMATION info;
+		::VirtualQuery(view, &info, sizeof(info));
+		const bool isCompatible = header_->magic == DescriptorRingHeader::MAGIC && header_->version == DescriptorRingHeader::VERSION
+			&& header_->recordSize == sizeof(DescriptorRingRecord) && info.RegionSize >= mappingSize(header_->capacity);
+		if (!isCompatible)
+		{
+			close();
+			return false;
+		}
+	}
+	else
+	{
+		// (new mappings are zero-filled)
+		header_->magic = DescriptorRingHeader::MAGIC;
+		header_->version = DescriptorRingHeader::VERSION;
+		header_->recordSize = sizeof(DescriptorRingRecord);
+		header_->capacity = numSlots;
+		::InterlockedExchange(&header_->numPublished, 0);
+	}
+
+	return true;
+}
+
+void DescriptorRingWriter::close()
+{
+	if (header_ != NULL)
+		::UnmapViewOfFile(header_);
+	if (mapping_ != NULL)
+		::CloseHandle(mapping_);
+	mapping_ = NULL;
+	header_ = NULL;
+	slots_ = NULL;
+	curSlot_ = NULL;
+}
+
+DescriptorRingRecord &DescriptorRingWriter::beginRecord()
+{
+	const LONG n = header_->numPublished; // (only written by this thread)
+	curSlot_ = &slots_[(DWORD)n & (header_->capacity - 1)];
+	::InterlockedExchange(&curSlot_->sequence, completedSequence(n) - 1); // odd: being written
+	return curSlot_->record;
+}
+
+void DescriptorRingWriter::publish()
+{
+	const LONG n = header_->numPublished;
+	curSlot_->record.publishTime = getTicks();
+	::InterlockedExchange(&curSlot_->sequence, completedSequence(n));
+	::InterlockedExchange(&header_->numPublished, (LONG)((DWORD)n + 1));
+	curSlot_ = NULL;
+}
+
+// ---------------------------------------------------------------------------------------
+
+DescriptorRingReader::DescriptorRingReader()
+{
+	mapping_ = NULL;
+	header_ = NULL;
+	slots_ = NULL;
+	next_ = 0;
+	numLost_ = 0;
+
+	LARGE_INTEGER frequency;
+	::QueryPerformanceFrequency(&frequency);
+	secondsPerTick_ = 1.0/(double)frequency.QuadPart;
+}
+
+DescriptorRingReader::~DescriptorRingReader()
+{
+	close();
+}
+
+bool DescriptorRingReader::open(const char *name)
+{
+	close();
+
+	mapping_ = ::OpenFileMappingA(FILE_MAP_READ, FALSE, name);
+	if (mapping_ == NULL)
+		return false;
+	const void *view = ::MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+	if (view == NULL)
+	{
+		::CloseHandle(mapping_);
+		mapping_ = NULL;
+		return false;
+	}
+	header_ = (const DescriptorRingHeader *)view;
+	slots_ = (const DescriptorRingSlot *)(header_ + 1);
+
+	MEMORY_BASIC_INFORMATION info;
+	::VirtualQuery(view, &info, sizeof(info));
+	const bool isCompatible = header_->magic == DescriptorRingHeader::MAGIC && header_->version == DescriptorRingHeader::VERSION
+		&& header_->recordSize == sizeof(DescriptorRingRecord) && info.RegionSize >= mappingSize(header_->capacity);
+	if (!isCompatible)
+	{
+		close();
+		return false;
+	}
+
+	next_ = header_->numPublished;
+	numLost_ = 0;
+	return true;
+}
+
+void DescriptorRingReader::close()
+{
+	if (header_ != NULL)
+		::UnmapViewOfFile(header_);
+	if (mapping_ != NULL)
+		::CloseHandle(mapping_);
+	mapping_ = NULL;
+	header_ = NULL;
+	slots_ = NULL;
+}
+
+int DescriptorRingReader::getNumAvailable() const
+{
+	if (header_ == NULL)
+		return 0;
+	const DWORD numAvailable = (DWORD)header_->numPublished - (DWORD)next_;
+	return (int)std::min(numAvailable, header_->capacity);
+}
+
+bool DescriptorRingReader::read(DescriptorRingRecord &record)
+{
+	if (header_ == NULL)
+		return false;
+
+	for (;;)
+	{
+		const LONG numPublished = header_->numPublished;
+		DWORD numAvailable = (DWORD)numPublished - (DWORD)next_;
+		if (numAvailable == 0)
+			return false;
+		if (numAvailable > header_->capacity)
+		{
+			// Overrun (or a writer restarted the ring, see DescriptorRingWriter::open()):
+			numLost_ += numAvailable - header_->capacity;
+			next_ = (LONG)((DWORD)numPublished - header_->capacity);
+		}
+
+		const DescriptorRingSlot &slot = slots_[(DWORD)next_ & (header_->capacity - 1)];
+		const LONG expected = completedSequence(next_);
+		next_ = (LONG)((DWORD)next_ + 1);
+
+		if (slot.sequence != expected)
+		{
+			++numLost_; // already overwritten
+			continue;
+		}
+		::MemoryBarrier();
+		std::memcpy(&record, (const void *)&slot.record, sizeof(record));
+		::MemoryBarrier();
+		if (slot.sequence != expected)
+		{
+			++numLost_; // overwritten while copying
+			continue;
+		}
+		return true;
+	}
+}
+
+double DescriptorRingReader::getAge(const DescriptorRingRecord &record) const
+{
+	return (double)(getTicks() - record.publishTime)*secondsPerTick_;
+}
+
+// ---------------------------------------------------------------------------------------
+
+namespace
+{
+	struct BenchmarkReaderContext
+	{
+		DescriptorRingReader *reader;
+		int numRecords;
+		volatile LONG isWriterDone;
+		DescriptorRingBenchmarkResult *result;
+	};
+
+	DWORD WINAPI benchmarkReaderThread(LPVOID arg)
+	{
+		BenchmarkReaderContext &context = *(BenchmarkReaderContext *)arg;
+		DescriptorRingRecord record;
+		double sumLatency = 0.0;
+		double maxLatency = 0.0;
+		unsigned int numRead = 0;
+		const LONGLONG startTime = getTicks();
+
+		while (numRead + context.reader->getNumLost() < (unsigned int)context.numRecords)
+		{
+			if (!context.reader->read(record))
+			{
+				if (context.isWriterDone && context.reader->getNumAvailable() == 0)
+					break; // (nothing left)
+				::Sleep(0);
+				continue;
+			}
+			const double latency = context.reader->getAge(record);
+			sumLatency += latency;
+			maxLatency = std::max(maxLatency, latency);
+			++numRead;
+		}
+
+		LARGE_INTEGER frequency;
+		::QueryPerformanceFrequency(&frequency);
+		const double seconds = (double)(getTicks() - startTime)/(double)frequency.QuadPart;
+		context.result->readRate = (seconds > 0.0) ? numRead/seconds : 0.0;
+		context.result->numRead = numRead;
+		context.result->numLost = context.reader->getNumLost();
+		context.result->meanLatency = (numRead > 0) ? sumLatency/numRead : 0.0;
+		context.result->maxLatency = maxLatency;
+		return 0;
+	}
+}
+
+bool runDescriptorRingBenchmark(int numRecords, int capacity, double rate, DescriptorRingBenchmarkResult &result)
+{
+	char name[64];
+	sprintf(name, "DescriptorRingBenchmark%lu", ::GetCurrentProcessId());
+
+	DescriptorRingWriter writer;
+	DescriptorRingReader reader;
+	if (!writer.open(name, capacity) || !reader.open(name))
+		return false;
+
+	std::memset(&result, 0, sizeof(result));
+	BenchmarkReaderContext context;
+	context.reader = &reader;
+	context.numRecords = numRecords;
+	context.isWriterDone = 0;
+	context.result = &result;
+	HANDLE thread = ::CreateThread(NULL, 0, benchmarkReaderThread, &context, 0, NULL);
+	if (thread == NULL)
+		return false;
+
+	LARGE_INTEGER frequency;
+	::QueryPerformanceFrequency(&frequency);
+	const LONGLONG startTime = getTicks();
+	const double ticksPerRecord = (rate > 0.0) ? (double)frequency.QuadPart/rate : 0.0;
+	for (int i = 0; i < numRecords; ++i)
+	{
+		while ((double)(getTicks() - startTime) < i*ticksPerRecord)
+			::Sleep(0);
+		DescriptorRingRecord &record = writer.beginRecord();
+		record.frameNumber = (DWORD)i;
+		record.instrument = 0;
+		record.descriptors[0] = (float)i;
+		writer.publish();
+	}
+	const double seconds = (double)(getTicks() - startTime)/(double)frequency.QuadPart;
+	result.writeRate = (seconds > 0.0) ? numRecords/seconds : 0.0;
+	::InterlockedExchange(&context.isWriterDone, 1);
+
+	::WaitForSingleObject(thread, INFINITE);
+	::CloseHandle(thread);
+	return true;
+}
@@ -0,0 +1,157 @@
+#ifndef INCLUDED_DESCRIPTORRING_HXX
+#define INCLUDED_DESCRIPTORRING_HXX
+
+#define NOMINMAX // avoid min/max macros from windows.h
+#include <windows.h>
+
+// Publishing computed frames to other local processes (visualizers, models) through a
+// named shared memory ring, instead of re-sending them over OSC from Max per consumer.
+//
+// One writer publishes records in place into a ring of slots in a named file mapping;
+// any number of readers (in any process that opens the same name) follow it on their own,
+// without the writer knowing about them, so there is no per-consumer cost. A slot's
+// sequence number is odd while it's being written and 2*(record number + 1) once written
+// (as a seqlock): a reader copies a record and checks the number didn't change, so a
+// record overwritten while read (reader too slow, ring wrapped) is detected and counted
+// as lost instead of returned torn. Readers never block the writer.
+//
+// Only depends on windows.h and this record layout, so consumers can compile this header
+// and DescriptorRing.cxx on their own (the reader library). Sequence numbers continue
+// when a writer reopens a ring that still exists (readers keep following it).
+
+// Everything about one instrument in one tracker frame (plain data, fixed layout).
+struct DescriptorRingRecord
+{
+	enum { NUM_KEY_POINT_VALUES = 48, NUM_DESCRIPTORS = 7 };
+
+	DWORD frameNumber; // tracker frame (of the violin body sample)
+	int instrument;
+	LONGLONG publishTime; // QueryPerformanceCounter() when published
+
+	// Raw poses (cm, euler angles in radians, see RawSensorData):
+	float violinPosition[3];
+	float violinOrientation[3];
+	float bowPosition[3];
+	float bowOrientation[3];
+
+	// Derived3dData key points (cm), 3 coordinates each: strings 1-4 at the bridge, the
+	// wood and the fingerboard end, bow frog lhs/rhs, bow tip lhs/rhs (as the transformed
+	// betas outlet):
+	float keyPoints[NUM_KEY_POINT_VALUES];
+	int playedString;
+
+	// ViolinPerformanceDescriptors:
+	float bowForceLhs;
+	float bowForceRhs;
+	float bowForce;
+	float bowDisplacement;
+	float bowBridgeDistance;
+	float stickBridgeDistance;
+	float bowVel;
+	float bowAccel;
+
+	// As output by compDescfrom6DOF (string, position, bbd, vel, acc, force, tilt):
+	float descriptors[NUM_DESCRIPTORS];
+};
+
+// Layout of the mapping: header followed by capacity slots.
+struct DescriptorRingHeader
+{
+	enum { MAGIC = 0x52444643, VERSION = 1 }; // 'CFDR'
+
+	DWORD magic;
+	DWORD version;
+	DWORD recordSize;
+	DWORD capacity; // slots (power of two)
+	volatile LONG numPublished; // records (wraps around)
+};
+
+struct DescriptorRingSlot
+{
+	volatile LONG sequence; // see above
+	DescriptorRingRecord record;
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+class DescriptorRingWriter
+{
+public:
+	enum { DEFAULT_CAPACITY = 4096 };
+
+	DescriptorRingWriter();
+	~DescriptorRingWriter();
+
+	// Creates (or reopens) the named mapping, capacity is rounded up to a power of two.
+	bool open(const char *name, int capacity = DEFAULT_CAPACITY);
+	void close();
+	bool isOpen() const { return header_ != NULL; }
+	int getCapacity() const { return (header_ != NULL) ? (int)header_->capacity : 0; }
+
+	// Record to fill in place (only valid until publish()), then publish it.
+	DescriptorRingRecord &beginRecord();
+	void publish();
+
+	unsigned int getNumPublished() const { return (header_ != NULL) ? (unsigned int)header_->numPublished : 0; }
+
+private:
+	HANDLE mapping_;
+	DescriptorRingHeader *header_;
+	DescriptorRingSlot *slots_;
+	DescriptorRingSlot *curSlot_;
+
+	DescriptorRingWriter(const DescriptorRingWriter &); // non-copyable
+	DescriptorRingWriter &operator=(const DescriptorRingWriter &); // non-copyable
+};
+
+class DescriptorRingReader
+{
+public:
+	DescriptorRingReader();
+	~DescriptorRingReader();
+
+	// Opens an existing ring (fails if no writer created it, or its layout differs), reading
+	// starts at the next record published.
+	bool open(const char *name);
+	void close();
+	bool isOpen() const { return header_ != NULL; }
+
+	// Copies the next record, returns false if none is available. Records that were
+	// overwritten before they could be read are skipped (see getNumLost()).
+	bool read(DescriptorRingRecord &record);
+	int getNumAvailable() const;
+
+	unsigned int getNumLost() const { return numLost_; }
+
+	// Seconds from a record's publishTime until now:
+	double getAge(const DescriptorRingRecord &record) const;
+
+private:
+	HANDLE mapping_;
+	const DescriptorRingHeader *header_;
+	const DescriptorRingSlot *slots_;
+	LONG next_; // record number
+	unsigned int numLost_;
+	double secondsPerTick_;
+
+	DescriptorRingReader(const DescriptorRingReader &); // non-copyable
+	DescriptorRingReader &operator=(const DescriptorRingReader &); // non-copyable
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// Latency and throughput of a writer publishing numRecords records at rate records/s (as
+// fast as possible if <= 0) to a private ring, followed by a reader on another thread.
+struct DescriptorRingBenchmarkResult
+{
+	double writeRate; // records/s
+	double readRate; // records/s
+	unsigned int numRead;
+	unsigned int numLost;
+	double meanLatency; // s (publish to read)
+	double maxLatency; // s
+};
+
+bool runDescriptorRingBenchmark(int numRecords, int capacity, double rate, DescriptorRingBenchmarkResult &result);
+
+#endif
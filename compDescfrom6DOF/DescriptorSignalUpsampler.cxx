@@ -0,0 +1,147 @@
+#define NOMINMAX // avoid min/max macros from windows.h
+#include "DescriptorSignalUpsampler.hxx"
+
+#include <cmath>
+#include <algorithm>
+
+// ---------------------------------------------------------------------------------------
+
+DescriptorSignalUpsampler::DescriptorSignalUpsampler()
+{
+	numViolins_ = 0;
+	frameRate_ = 240.0;
+	latencyFrames_ = DEFAULT_LATENCY_FRAMES;
+	std::fill(frame_.values, frame_.values + MAX_NUM_VIOLINS*DescriptorSignalFrame::NUM_SIGNALS, 0.f);
+	step_ = 0.0;
+	phase_ = 0.0;
+	prev_ = frame_;
+	next_ = frame_;
+	hasFrame_ = false;
+	isPriming_ = true;
+	numFramesDropped_ = 0;
+	numFramesSkipped_ = 0;
+	numUnderruns_ = 0;
+}
+
+void DescriptorSignalUpsampler::init(int numViolins, double frameRate, int fifoCapacityFrames)
+{
+	numViolins_ = std::min(std::max(numViolins, 0), (int)MAX_NUM_VIOLINS);
+	frameRate_ = frameRate;
+	fifo_.reserve(std::max(fifoCapacityFrames, 2) + 1); // (+ 1, see LockFreeFifo notes)
+	setLatency(latencyFrames_);
+	step_ = frameRate_/44100.0; // (until setSampleRate())
+	phase_ = 0.0;
+	hasFrame_ = false;
+	isPriming_ = true;
+}
+
+bool DescriptorSignalUpsampler::postFrame()
+{
+	if (fifo_.put(frame_) == 0)
+	{
+		++numFramesDropped_;
+		return false;
+	}
+	return true;
+}
+
+void DescriptorSignalUpsampler::setSampleRate(double sampleRate)
+{
+	if (sampleRate > 0.0)
+		step_ = frameRate_/sampleRate;
+}
+
+void DescriptorSignalUpsampler::setLatency(int numFrames)
+{
+	// (room left to skip frames above twice the latency)
+	latencyFrames_ = std::min(std::max(numFrames, 1), std::max(fifo_.getCapacity()/2, 1));
+}
+
+void DescriptorSignalUpsampler::process(float **outputs, int numSamples)
+{
+	const int numSignals = getNumSignals();
+	const int latency = latencyFrames_;
+	int numAvail = fifo_.getReadAvail();
+
+	if (isPriming_)
+	{
+		if (numAvail < latency)
+		{
+			fillHold(outputs, 0, numSamples);
+			return;
+		}
+
+		// Ramp from the held value to the next frame (from the first frame on startup):
+		fifo_.get(next_);
+		--numAvail;
+		if (!hasFrame_)
+		{
+			prev_ = next_;
+			hasFrame_ = true;
+		}
+		phase_ = 0.0;
+		isPriming_ = false;
+	}
+	else if (numAvail > 2*latency)
+	{
+		const int numSkipped = numAvail - latency;
+		for (int i = 0; i < numSkipped; ++i)
+			fifo_.get(next_);
+		numFramesSkipped_ += numSkipped;
+	}
+
+	int offset = 0;
+	while (offset < numSamples)
+	{
+		// Samples until the next frame boundary:
+		int segment = std::max((int)std::ceil((1.0 - phase_)/step_), 1);
+		const bool reachesNext = (segment <= numSamples - offset);
+		if (!reachesNext)
+			segment = numSamples - offset;
+
+		for (int c = 0; c < numSignals; ++c)
+		{
+			const float delta = next_.values[c] - prev_.values[c];
+			const float slope = (float)(delta*step_);
+			float value = prev_.values[c] + (float)(delta*phase_);
+			float *out = outputs[c] + offset;
+			for (int k = 0; k < segment; ++k)
+			{
+				out[k] = value;
+				value += slope;
+			}
+		}
+		offset += segment;
+		phase_ += segment*step_;
+
+		if (reachesNext)
+		{
+			phase_ = std::min(std::max(phase_ - 1.0, 0.0), 1.0);
+			advance();
+			if (isPriming_)
+			{
+				fillHold(outputs, offset, numSamples - offset);
+				return;
+			}
+		}
+	}
+}
+
+// Moves on to the next frame, starts priming if there is none.
+void DescriptorSignalUpsampler::advance()
+{
+	prev_ = next_;
+	if (fifo_.get(next_) == 0)
+	{
+		next_ = prev_;
+		phase_ = 0.0;
+		isPriming_ = true;
+		++numUnderruns_;
+	}
+}
+
+void DescriptorSignalUpsampler::fillHold(float **outputs, int offset, int numSamples)
+{
+	for (int c = 0; c < getNumSignals(); ++c)
+		std::fill(outputs[c] + offset, outputs[c] + offset + numSamples, prev_.values[c]);
+}
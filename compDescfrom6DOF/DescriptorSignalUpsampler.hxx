@@ -0,0 +1,84 @@
+#ifndef INCLUDED_DESCRIPTORSIGNALUPSAMPLER_HXX
+#define INCLUDED_DESCRIPTORSIGNALUPSAMPLER_HXX
+
+#include "LockFreeFifo.hxx"
+#include "ViolinRecordingPlugInConfig.hxx" // MAX_NUM_VIOLINS
+
+// Descriptors of one tracker frame for the signal outlets.
+struct DescriptorSignalFrame
+{
+	enum { VEL, FORCE, BBD, POSITION, NUM_SIGNALS };
+
+	float values[MAX_NUM_VIOLINS*NUM_SIGNALS]; // violin index outermost
+};
+
+// Turns the frame rate descriptors computed by the scheduler task into audio rate signals
+// in the perform routine, so they reach synthesis sample-accurately instead of as lists
+// timed by the scheduler.
+//
+// The task posts a frame per tracker frame through a single reader, single writer
+// lock-free FIFO (never blocking either thread; frames are dropped and counted when it's
+// full). The perform routine consumes frames at the nominal tracker rate on the audio
+// clock and interpolates linearly between consecutive frames, so the task's jitter and
+// batching (e.g. 24 frames every 100 ms in periodic mode) don't show in the output as
+// long as the latency (frames kept in the FIFO) covers them. When the FIFO runs dry the
+// last value is held until the latency has been refilled; when frames pile up beyond
+// twice the latency (clock drift, or a burst after a stall) the oldest ones are skipped.
+// Between frame boundaries an outlet's block is a ramp, computed with one add per sample.
+class DescriptorSignalUpsampler
+{
+public:
+	enum { DEFAULT_LATENCY_FRAMES = 3 };
+
+	DescriptorSignalUpsampler();
+
+	// (not thread safe, before processing starts)
+	void init(int numViolins, double frameRate, int fifoCapacityFrames);
+	int getNumViolins() const { return numViolins_; }
+	int getNumSignals() const { return numViolins_*DescriptorSignalFrame::NUM_SIGNALS; }
+
+	// Producer (scheduler thread): sets values of the next frame, then posts it.
+	void setValue(int iViolin, int signal, float value) { frame_.values[iViolin*DescriptorSignalFrame::NUM_SIGNALS + signal] = value; }
+	bool postFrame();
+
+	// Consumer (audio thread, or the dsp method while audio is off):
+	void setSampleRate(double sampleRate);
+	void process(float **outputs, int numSamples); // getNumSignals() outputs
+
+	// Frames buffered before output starts (any thread).
+	void setLatency(int numFrames);
+	int getLatency() const { return latencyFrames_; }
+
+	// Statistics (approximate, may be read from any thread):
+	unsigned int getNumFramesDropped() const { return numFramesDropped_; }
+	unsigned int getNumFramesSkipped() const { return numFramesSkipped_; }
+	unsigned int getNumUnderruns() const { return numUnderruns_; }
+
+private:
+	void advance();
+	void fillHold(float **outputs, int offset, int numSamples);
+
+	int numViolins_;
+	double frameRate_;
+	volatile int latencyFrames_;
+
+	LockFreeFifo<DescriptorSignalFrame> fifo_;
+	DescriptorSignalFrame frame_; // being set by the producer
+
+	// Consumer state:
+	double step_; // frames per sample
+	double phase_; // [0;1[ from prev_ to next_
+	DescriptorSignalFrame prev_;
+	DescriptorSignalFrame next_;
+	bool hasFrame_; // (prev_ and next_ are valid)
+	bool isPriming_; // holding prev_ until latencyFrames_ are buffered
+
+	volatile unsigned int numFramesDropped_;
+	volatile unsigned int numFramesSkipped_;
+	volatile unsigned int numUnderruns_;
+
+	DescriptorSignalUpsampler(const DescriptorSignalUpsampler &); // non-copyable
+	DescriptorSignalUpsampler &operator=(const DescriptorSignalUpsampler &); // non-copyable
+};
+
+#endif
@@ -0,0 +1,131 @@
+#define NOMINMAX // avoid min/max macros from windows.h
+#include "EstimatorComparison.hxx"
+
+#include <cmath>
+#include <algorithm>
+
+// ---------------------------------------------------------------------------------------
+
+namespace
+{
+	const int estimatorSettleFrames = 24; // frames of valid input before an estimate is evaluated
+}
+
+// ---------------------------------------------------------------------------------------
+
+void EstimatorComparison::init(const std::vector<float> &signal, const std::vector<bool> &isValid, double sampleRate, const float *window, int windowLength, int maxLag)
+{
+	sampleRate_ = sampleRate;
+	window_.assign(window, window + windowLength);
+	maxLag_ = std::max(maxLag, 0);
+
+	// Reference:
+	std::vector<double> x(signal.begin(), signal.end());
+	std::vector<double> smoothed;
+	smooth(x, smoothed);
+	differentiate(smoothed, referenceVel_);
+	smooth(referenceVel_, smoothed);
+	differentiate(smoothed, referenceAccel_);
+
+	// Frames whose estimate and reference only depend on valid frames (window is applied
+	// twice, plus a central difference each time):
+	const int n = (int)signal.size();
+	const int halfSupport = 2*(windowLength/2 + 1);
+	const int before = maxLag_ + std::max(halfSupport, estimatorSettleFrames);
+	const int after = halfSupport;
+
+	std::vector<int> numValidUpTo(n + 1, 0); // number of valid frames before i
+	for (int i = 0; i < n; ++i)
+		numValidUpTo[i + 1] = numValidUpTo[i] + (isValid[i] ? 1 : 0);
+
+	isEvaluated_.assign(n, false);
+	for (int i = before; i + after < n; ++i)
+	{
+		const int first = i - before;
+		const int last = i + after;
+		isEvaluated_[i] = (numValidUpTo[last + 1] - numValidUpTo[first] == last - first + 1);
+	}
+}
+
+EstimatorComparison::Stats EstimatorComparison::evaluate(const std::vector<float> &estimate, const std::vector<double> &reference) const
+{
+	Stats stats;
+	stats.lag = 0;
+	stats.error = 0.0;
+	stats.roughness = 0.0;
+	stats.numFrames = 0;
+
+	const int n = std::min((int)estimate.size(), (int)isEvaluated_.size());
+	for (int i = 0; i < n; ++i)
+	{
+		if (isEvaluated_[i])
+			++stats.numFrames;
+	}
+	if (stats.numFrames == 0)
+		return stats;
+
+	// Lag:
+	double minSumSquares = -1.0;
+	for (int lag = 0; lag <= maxLag_; ++lag)
+	{
+		double sumSquares = 0.0;
+		for (int i = 0; i < n; ++i)
+		{
+			if (!isEvaluated_[i])
+				continue;
+			const double d = estimate[i] - reference[i - lag]; // (i >= maxLag_ when evaluated)
+			sumSquares += d*d;
+		}
+		if (minSumSquares < 0.0 || sumSquares < minSumSquares)
+		{
+			minSumSquares = sumSquares;
+			stats.lag = lag;
+		}
+	}
+	stats.error = std::sqrt(minSumSquares/stats.numFrames);
+
+	// Roughness:
+	double sumSquares = 0.0;
+	for (int i = 0; i < n; ++i)
+	{
+		if (!isEvaluated_[i] || i + 1 >= n)
+			continue;
+		const double d2 = (double)estimate[i + 1] - 2.0*estimate[i] + estimate[i - 1];
+		sumSquares += d2*d2;
+	}
+	stats.roughness = std::sqrt(sumSquares/stats.numFrames);
+
+	return stats;
+}
+
+// Centered (zero phase), edges use the nearest frame.
+void EstimatorComparison::smooth(const std::vector<double> &x, std::vector<double> &result) const
+{
+	const int n = (int)x.size();
+	const int half = (int)window_.size()/2;
+	result.assign(n, 0.0);
+	for (int i = 0; i < n; ++i)
+	{
+		double sum = 0.0;
+		for (int j = -half; j <= half; ++j)
+		{
+			const int k = std::min(std::max(i + j, 0), n - 1);
+			sum += window_[j + half]*x[k];
+		}
+		result[i] = sum;
+	}
+}
+
+// Central difference, one sided at the edges.
+void EstimatorComparison::differentiate(const std::vector<double> &x, std::vector<double> &result) const
+{
+	const int n = (int)x.size();
+	result.assign(n, 0.0);
+	if (n < 2)
+		return;
+
+	for (int i = 1; i < n - 1; ++i)
+		result[i] = (x[i + 1] - x[i - 1])*0.5*sampleRate_;
+	result[0] = (x[1] - x[0])*sampleRate_;
+	result[n - 1] = (x[n - 1] - x[n - 2])*sampleRate_;
+}
@@ -0,0 +1,54 @@
+#ifndef INCLUDED_ESTIMATORCOMPARISON_HXX
+#define INCLUDED_ESTIMATORCOMPARISON_HXX
+
+#include <vector>
+
+// Offline evaluation of causal derivative estimators (e.g. the FIR smoothing path against
+// KinematicKalmanFilter) on a recorded signal, such as the bow displacement of a take.
+//
+// The reference is non-causal (zero phase): the signal smoothed with a centered symmetric
+// window and differentiated with central differences, once for velocity and again (after
+// smoothing the velocity the same way) for acceleration. An estimate is compared with it
+// over the frames marked valid (e.g. bow on the string) whose neighbourhood is also valid,
+// so transients at contact changes are left out:
+// - lag: shift (frames) minimizing the RMS difference between estimate and reference
+// - error: that (minimum) RMS difference, i.e. noise and shape error without the lag
+// - roughness: RMS of the second difference of the estimate, a reference-free measure of
+//   its high frequency noise
+class EstimatorComparison
+{
+public:
+	struct Stats
+	{
+		int lag; // frames
+		double error;
+		double roughness;
+		int numFrames; // frames evaluated
+	};
+
+	// Window must be symmetric with an odd length. Signal and isValid have the same length.
+	void init(const std::vector<float> &signal, const std::vector<bool> &isValid, double sampleRate, const float *window, int windowLength, int maxLag);
+
+	const std::vector<double> &getReferenceVel() const { return referenceVel_; }
+	const std::vector<double> &getReferenceAccel() const { return referenceAccel_; }
+
+	// Estimate has one value per signal frame (estimate i computed up to frame i).
+	Stats evaluateVel(const std::vector<float> &estimate) const { return evaluate(estimate, referenceVel_); }
+	Stats evaluateAccel(const std::vector<float> &estimate) const { return evaluate(estimate, referenceAccel_); }
+
+private:
+	Stats evaluate(const std::vector<float> &estimate, const std::vector<double> &reference) const;
+
+	void smooth(const std::vector<double> &x, std::vector<double> &result) const;
+	void differentiate(const std::vector<double> &x, std::vector<double> &result) const;
+
+	double sampleRate_;
+	std::vector<double> window_;
+	int maxLag_;
+	std::vector<bool> isEvaluated_;
+
+	std::vector<double> referenceVel_;
+	std::vector<double> referenceAccel_;
+};
+
+#endif
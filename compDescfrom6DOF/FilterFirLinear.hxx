@@ -0,0 +1,141 @@
+#ifndef INCLUDED_FILTERFIRLINEAR_HXX
+#define INCLUDED_FILTERFIRLINEAR_HXX
+
+#include <cstddef>
+#include <cassert> // (WindowGen.hxx relies on it)
+
+#include "FilterFirN.hxx"
+
+// Apply a FIR filter b_i, with i=0..N-1, to input signal x(n), with
+// n=0..M-1.
+// Parameter inputStride should normally be 1. When set to 2 for instance 
+// every other input is skipped (useful for downsampling filter for
+// instance).
+//
+// A causal FIR filter is defined as, 
+// y(n) = \sum_{i=0}^{N-1} b_i x(n-i),                                (1)
+// which is equivalent to convolution of the input signal with the filter 
+// coefficients.
+//
+// From equation (1) it can be shown that to compute one output sample N-1
+// past input samples (plus the current input sample) are needed. The
+// unknown input samples x(n) with n < 0 are usually assumed to be zero.
+//
+// This function is equivalent to Matlab's built-in conv() function, but
+// truncates the filters output to the same length as the input. To obtain
+// the entire output append length(b)-1 zeros to the inputs end before
+// calling filter_fir(). This function is not optimized for Matlab but
+// closer to a possible real-time C implementation of a FIR filter (i.e. 
+// with buffering).
+//
+// Note: Variant of the ViolinRecordingPlugIn FilterFir with the same interface (a distinct 
+// name, both may be included in one build), implemented with the linear double-length 
+// buffer and symmetric coefficient kernel of FilterFirN (see FilterFirN.hxx). Use 
+// FilterFirN directly when the length is known at compile time. Unlike FilterFir, with 
+// inputStride > 1 an output is computed for every inputStride'th input of each call (from 
+// the length most recent inputs).
+class FilterFirLinear
+{
+public:
+	FilterFirLinear();
+	~FilterFirLinear();
+
+	void init(const float *b, unsigned int length); // b is copied
+	void deinit();
+
+	void process(const float *x, float *y, unsigned int n, unsigned int inputStride = 1, unsigned int outputOffset = 0, unsigned int outputStride = 1);
+
+private:
+	float *b_; // time-reversed
+	unsigned int length_;
+	bool isSymmetric_;
+
+	float *buffer_; // 2*length_, see firKernel
+	unsigned int pos_;
+
+	FilterFirLinear(const FilterFirLinear &); // non-copyable
+	FilterFirLinear &operator=(const FilterFirLinear &); // non-copyable
+};
+
+
+// ---------------------------------------------------------------------------------------
+
+inline FilterFirLinear::FilterFirLinear()
+{
+	b_ = NULL;
+	buffer_ = NULL;
+	length_ = 0;
+	isSymmetric_ = true;
+	pos_ = 0;
+}
+
+inline FilterFirLinear::~FilterFirLinear()
+{
+	deinit();
+}
+
+inline void FilterFirLinear::init(const float *b, unsigned int length)
+{
+	// Note: Doesn't deinit() first, filters may be members of Max object structs whose 
+	// constructors aren't called (call deinit() to re-init).
+	if (length == 0)
+		return;
+
+	length_ = length;
+
+	// Pre-time-reverse filter coefficients to avoid having to subtract indexes
+	// in inner loop, as y(n) = \sum_{i=0}^{N-1} b_i x(n-i), is equivalent to
+	// y(n) = \sum_{i=0}^{N-1} b_{(N-1)-i} x(n-(N-1)+i).
+	b_ = new float[length_];
+	for (unsigned int i = 0; i < length_; ++i)
+		b_[i] = b[length_ - 1 - i];
+	isSymmetric_ = firKernel::isSymmetric(b_, length_);
+
+	// Pre-zeropad input with zeros (input before n = 0 is assumed to be zero):
+	buffer_ = new float[2*length_];
+	for (unsigned int i = 0; i < 2*length_; ++i)
+		buffer_[i] = 0.f;
+	pos_ = 0;
+}
+
+inline void FilterFirLinear::deinit()
+{
+	delete[] b_;
+	b_ = NULL;
+	delete[] buffer_;
+	buffer_ = NULL;
+	length_ = 0;
+}
+
+inline void FilterFirLinear::process(const float *x, float *y, unsigned int n, unsigned int inputStride, unsigned int outputOffset, unsigned int outputStride)
+{
+	if (buffer_ == NULL)
+		return;
+
+	// Sample-by-sample (outer) loop:
+	unsigned int k = outputOffset;
+	for (unsigned int i = 0; i < n; ++i)
+	{
+		// Write input twice, so the most recent length_ inputs are contiguous:
+		buffer_[pos_] = x[i];
+		buffer_[pos_ + length_] = x[i];
+		++pos_;
+		if (pos_ >= length_)
+			pos_ = 0;
+
+		if ((i % inputStride) == 0)
+		{
+			float y_n;
+			if (isSymmetric_)
+				firKernel::convolveSymmetric(b_, buffer_ + pos_, length_, 1, &y_n);
+			else
+				firKernel::convolve(b_, buffer_ + pos_, length_, 1, &y_n);
+
+			// Copy to output array:
+			y[k] = y_n;
+			k += outputStride;
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,178 @@
+#ifndef INCLUDED_FILTERFIRN_HXX
+#define INCLUDED_FILTERFIRN_HXX
+
+#include <cstddef>
+
+// FIR filter engine shared by FilterFirN and FilterFirLinear.
+//
+// Buffering is done with a double-length linear buffer: every input is written twice, at
+// pos and pos + N, so the N most recent inputs are always contiguous (oldest first) at
+// pos + 1 and the inner loop never wraps. With time-reversed coefficients b'_j = b_{N-1-j}
+// equation (1) of FilterFirLinear becomes a plain dot product of b' and this window.
+//
+// Smoothing filters (Gaussian windows) have symmetric coefficients (b_i = b_{N-1-i}), in
+// which case pairs of inputs sharing a coefficient are added first, halving the number of
+// multiplies.
+//
+// Multiple independent channels are stored interleaved (channel index innermost), so the
+// per-channel loops are over contiguous memory and can be vectorized by the compiler (one
+// channel per SIMD lane).
+namespace firKernel
+{
+	inline bool isSymmetric(const float *b, unsigned int length)
+	{
+		for (unsigned int i = 0; i < length/2; ++i)
+		{
+			if (b[i] != b[length - 1 - i])
+				return false;
+		}
+		return true;
+	}
+
+	// y[c] = \sum_{j=0}^{N-1} b'_j w[j][c], for window w of N frames of numChannels samples.
+	inline void convolve(const float *b, const float *w, unsigned int length, unsigned int numChannels, float *y)
+	{
+		for (unsigned int c = 0; c < numChannels; ++c)
+			y[c] = 0.f;
+
+		for (unsigned int j = 0; j < length; ++j)
+		{
+			const float *wj = w + j*numChannels;
+			for (unsigned int c = 0; c < numChannels; ++c)
+				y[c] += b[j]*wj[c];
+		}
+	}
+
+	// Same, for symmetric coefficients.
+	inline void convolveSymmetric(const float *b, const float *w, unsigned int length, unsigned int numChannels, float *y)
+	{
+		const unsigned int half = length/2;
+
+		if (length & 1)
+		{
+			const float *wMid = w + half*numChannels;
+			for (unsigned int c = 0; c < numChannels; ++c)
+				y[c] = b[half]*wMid[c];
+		}
+		else
+		{
+			for (unsigned int c = 0; c < numChannels; ++c)
+				y[c] = 0.f;
+		}
+
+		for (unsigned int j = 0; j < half; ++j)
+		{
+			const float *wLo = w + j*numChannels;
+			const float *wHi = w + (length - 1 - j)*numChannels;
+			for (unsigned int c = 0; c < numChannels; ++c)
+				y[c] += b[j]*(wLo[c] + wHi[c]);
+		}
+	}
+
+	// Same, for antisymmetric coefficients (b'_j == -b'_{N-1-j}, e.g. differentiators).
+	inline void convolveAntisymmetric(const float *b, const float *w, unsigned int length, unsigned int numChannels, float *y)
+	{
+		for (unsigned int c = 0; c < numChannels; ++c)
+			y[c] = 0.f;
+
+		for (unsigned int j = 0; j < length/2; ++j)
+		{
+			const float *wLo = w + j*numChannels;
+			const float *wHi = w + (length - 1 - j)*numChannels;
+			for (unsigned int c = 0; c < numChannels; ++c)
+				y[c] += b[j]*(wLo[c] - wHi[c]);
+		}
+	}
+}
+
+// ---------------------------------------------------------------------------------------
+
+// Fixed length (N taps) FIR filter for NUM_CHANNELS independent channels with the same
+// coefficients. Storage is inline (no allocation) and loop bounds are compile-time
+// constants, so for the short smoothing filters the inner loops are fully unrolled.
+// Same output as FilterFirLinear (zero initial state, causal).
+template<unsigned int N, unsigned int NUM_CHANNELS = 1>
+class FilterFirN
+{
+public:
+	FilterFirN();
+
+	void init(const float *b); // N coefficients, copied (state is reset)
+	void reset();
+
+	bool isSymmetric() const { return isSymmetric_; }
+
+	// Filters n frames of NUM_CHANNELS interleaved samples (x and y may be the same):
+	void process(const float *x, float *y, unsigned int n);
+
+	// Filters a single frame:
+	void processFrame(const float *x, float *y);
+
+private:
+	float b_[N]; // time-reversed
+	bool isSymmetric_;
+
+	float buffer_[2*N*NUM_CHANNELS];
+	unsigned int pos_;
+};
+
+// ---------------------------------------------------------------------------------------
+
+template<unsigned int N, unsigned int NUM_CHANNELS>
+inline FilterFirN<N, NUM_CHANNELS>::FilterFirN()
+{
+	for (unsigned int i = 0; i < N; ++i)
+		b_[i] = 0.f;
+	isSymmetric_ = true;
+	reset();
+}
+
+template<unsigned int N, unsigned int NUM_CHANNELS>
+inline void FilterFirN<N, NUM_CHANNELS>::init(const float *b)
+{
+	for (unsigned int i = 0; i < N; ++i)
+		b_[i] = b[N - 1 - i];
+	isSymmetric_ = firKernel::isSymmetric(b_, N);
+	reset();
+}
+
+template<unsigned int N, unsigned int NUM_CHANNELS>
+inline void FilterFirN<N, NUM_CHANNELS>::reset()
+{
+	for (unsigned int i = 0; i < 2*N*NUM_CHANNELS; ++i)
+		buffer_[i] = 0.f;
+	pos_ = 0;
+}
+
+template<unsigned int N, unsigned int NUM_CHANNELS>
+inline void FilterFirN<N, NUM_CHANNELS>::processFrame(const float *x, float *y)
+{
+	// Write input twice (see firKernel):
+	float *w1 = buffer_ + pos_*NUM_CHANNELS;
+	float *w2 = buffer_ + (pos_ + N)*NUM_CHANNELS;
+	for (unsigned int c = 0; c < NUM_CHANNELS; ++c)
+	{
+		w1[c] = x[c];
+		w2[c] = x[c];
+	}
+
+	++pos_;
+	if (pos_ >= N)
+		pos_ = 0;
+
+	// N most recent frames, oldest first:
+	const float *w = buffer_ + pos_*NUM_CHANNELS;
+	if (isSymmetric_)
+		firKernel::convolveSymmetric(b_, w, N, NUM_CHANNELS, y);
+	else
+		firKernel::convolve(b_, w, N, NUM_CHANNELS, y);
+}
+
+template<unsigned int N, unsigned int NUM_CHANNELS>
+inline void FilterFirN<N, NUM_CHANNELS>::process(const float *x, float *y, unsigned int n)
+{
+	for (unsigned int i = 0; i < n; ++i)
+		processFrame(x + i*NUM_CHANNELS, y + i*NUM_CHANNELS); // (input frame is buffered before output is written)
+}
+
+#endif
@@ -0,0 +1,154 @@
+#ifndef INCLUDED_FUSEDDERIVATIVESMOOTHER_HXX
+#define INCLUDED_FUSEDDERIVATIVESMOOTHER_HXX
+
+#include "FilterFirN.hxx"
+
+// Smoothed first and second derivative (e.g. bow velocity and acceleration from bow
+// displacement), replacing the cascades:
+//   velocity:     Derivative2 -> 5 tap smoother
+//   acceleration: Derivative2 (of the unsmoothed velocity) -> 5, 5 and 9 tap smoothers
+//
+// All stages are linear and time-invariant, so each cascade is precomposed into a single
+// FIR filter on the input: a 7 tap differentiating smoother for velocity and a 21 tap
+// kernel for acceleration (Derivative2 is [1 0 -1]*fs/2, so the sample rate is applied
+// as a gain after filtering). Both are evaluated from one shared input history in a single
+// pass, instead of keeping the state of six filters and moving every sample through all
+// of them. With symmetric smoothers the velocity kernel is antisymmetric and the
+// acceleration kernel symmetric, so half of the multiplies are skipped (see firKernel).
+//
+// Output is the same as the cascade (up to float rounding) for a constant sample rate.
+// Storage is inline, so it can be a member of a Max object struct: init() sets all state.
+template<unsigned int NUM_CHANNELS = 1>
+class FusedDerivativeSmoother
+{
+public:
+	enum
+	{
+		VEL_SMOOTHER_LENGTH = 5,
+		ACCEL_SMOOTHER1_LENGTH = 5,
+		ACCEL_SMOOTHER2_LENGTH = 5,
+		ACCEL_SMOOTHER3_LENGTH = 9,
+		VEL_LENGTH = VEL_SMOOTHER_LENGTH + 2,
+		ACCEL_LENGTH = ACCEL_SMOOTHER1_LENGTH + ACCEL_SMOOTHER2_LENGTH + ACCEL_SMOOTHER3_LENGTH + 2
+	};
+
+	// Coefficients of the smoothers of the cascades (see *_LENGTH), state is reset.
+	void init(const float *velSmoother, const float *accelSmoother1, const float *accelSmoother2, const float *accelSmoother3);
+	void reset();
+
+	// One frame of NUM_CHANNELS inputs sampled at fs (Hz).
+	void process(const float *x, float fs, float *vel, float *accel);
+
+	const float *getVelKernel() const { return velKernel_; } // (time-reversed)
+	const float *getAccelKernel() const { return accelKernel_; }
+
+private:
+	static int convolve(const double *a, int aLength, const float *b, int bLength, double *result);
+
+	float velKernel_[VEL_LENGTH]; // time-reversed
+	float accelKernel_[ACCEL_LENGTH]; // time-reversed
+	bool isSymmetric_;
+
+	float buffer_[2*ACCEL_LENGTH*NUM_CHANNELS]; // (see firKernel)
+	unsigned int pos_;
+};
+
+// ---------------------------------------------------------------------------------------
+
+template<unsigned int NUM_CHANNELS>
+inline void FusedDerivativeSmoother<NUM_CHANNELS>::init(const float *velSmoother, const float *accelSmoother1, const float *accelSmoother2, const float *accelSmoother3)
+{
+	const float derivative[3] = { 0.5f, 0.0f, -0.5f }; // Derivative2 for fs = 1
+	double tmp1[ACCEL_LENGTH];
+	double tmp2[ACCEL_LENGTH];
+	int length;
+
+	// Velocity:
+	tmp1[0] = 1.0;
+	length = convolve(tmp1, 1, derivative, 3, tmp2);
+	length = convolve(tmp2, length, velSmoother, VEL_SMOOTHER_LENGTH, tmp1);
+	for (int i = 0; i < VEL_LENGTH; ++i)
+		velKernel_[i] = (float)tmp1[VEL_LENGTH - 1 - i];
+
+	// Acceleration:
+	tmp1[0] = 1.0;
+	length = convolve(tmp1, 1, derivative, 3, tmp2);
+	length = convolve(tmp2, length, derivative, 3, tmp1);
+	length = convolve(tmp1, length, accelSmoother1, ACCEL_SMOOTHER1_LENGTH, tmp2);
+	length = convolve(tmp2, length, accelSmoother2, ACCEL_SMOOTHER2_LENGTH, tmp1);
+	length = convolve(tmp1, length, accelSmoother3, ACCEL_SMOOTHER3_LENGTH, tmp2);
+	for (int i = 0; i < ACCEL_LENGTH; ++i)
+		accelKernel_[i] = (float)tmp2[ACCEL_LENGTH - 1 - i];
+
+	isSymmetric_ = firKernel::isSymmetric(velSmoother, VEL_SMOOTHER_LENGTH) &&
+		firKernel::isSymmetric(accelSmoother1, ACCEL_SMOOTHER1_LENGTH) &&
+		firKernel::isSymmetric(accelSmoother2, ACCEL_SMOOTHER2_LENGTH) &&
+		firKernel::isSymmetric(accelSmoother3, ACCEL_SMOOTHER3_LENGTH);
+
+	reset();
+}
+
+template<unsigned int NUM_CHANNELS>
+inline void FusedDerivativeSmoother<NUM_CHANNELS>::reset()
+{
+	for (unsigned int i = 0; i < 2*ACCEL_LENGTH*NUM_CHANNELS; ++i)
+		buffer_[i] = 0.f;
+	pos_ = 0;
+}
+
+template<unsigned int NUM_CHANNELS>
+inline void FusedDerivativeSmoother<NUM_CHANNELS>::process(const float *x, float fs, float *vel, float *accel)
+{
+	// Write input twice (see firKernel):
+	float *w1 = buffer_ + pos_*NUM_CHANNELS;
+	float *w2 = buffer_ + (pos_ + ACCEL_LENGTH)*NUM_CHANNELS;
+	for (unsigned int c = 0; c < NUM_CHANNELS; ++c)
+	{
+		w1[c] = x[c];
+		w2[c] = x[c];
+	}
+
+	++pos_;
+	if (pos_ >= ACCEL_LENGTH)
+		pos_ = 0;
+
+	// ACCEL_LENGTH most recent frames (oldest first), velocity only uses the last VEL_LENGTH:
+	const float *w = buffer_ + pos_*NUM_CHANNELS;
+	const float *wVel = w + (ACCEL_LENGTH - VEL_LENGTH)*NUM_CHANNELS;
+	if (isSymmetric_)
+	{
+		firKernel::convolveAntisymmetric(velKernel_, wVel, VEL_LENGTH, NUM_CHANNELS, vel);
+		firKernel::convolveSymmetric(accelKernel_, w, ACCEL_LENGTH, NUM_CHANNELS, accel);
+	}
+	else
+	{
+		firKernel::convolve(velKernel_, wVel, VEL_LENGTH, NUM_CHANNELS, vel);
+		firKernel::convolve(accelKernel_, w, ACCEL_LENGTH, NUM_CHANNELS, accel);
+	}
+
+	const float fs2 = fs*fs;
+	for (unsigned int c = 0; c < NUM_CHANNELS; ++c)
+	{
+		vel[c] *= fs;
+		accel[c] *= fs2;
+	}
+}
+
+// Full (linear) convolution, returns result length (aLength + bLength - 1).
+template<unsigned int NUM_CHANNELS>
+inline int FusedDerivativeSmoother<NUM_CHANNELS>::convolve(const double *a, int aLength, const float *b, int bLength, double *result)
+{
+	const int length = aLength + bLength - 1;
+	for (int i = 0; i < length; ++i)
+		result[i] = 0.0;
+
+	for (int i = 0; i < aLength; ++i)
+	{
+		for (int j = 0; j < bLength; ++j)
+			result[i + j] += a[i]*b[j];
+	}
+
+	return length;
+}
+
+#endif
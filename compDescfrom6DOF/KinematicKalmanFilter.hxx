@@ -0,0 +1,150 @@
+#ifndef INCLUDED_KINEMATICKALMANFILTER_HXX
+#define INCLUDED_KINEMATICKALMANFILTER_HXX
+
+#include <cmath>
+
+// Constant acceleration Kalman filter: estimates position, velocity and acceleration of a
+// 1D coordinate (e.g. bow displacement) from noisy position measurements.
+//
+// Low delay alternative to FusedDerivativeSmoother: the linear phase smoothers delay bow
+// velocity by 3 and acceleration by 10 frames (~42 ms at 240 Hz), while this filter
+// follows the current state, as the model (constant acceleration between frames) tracks
+// polynomial motion up to second order without lag. The price is less attenuation of
+// high frequency noise for the same smoothness.
+//
+// Model (state x = [p v a], frame interval dt):
+//   x_k = F x_{k-1} + w_k, F = [1 dt dt^2/2; 0 1 dt; 0 0 1]
+//   z_k = p_k + v_k
+// with w_k due to white jerk of spectral density processNoise (units^2/s^5) and v_k
+// white with variance measurementNoise (units^2). Only their ratio sets the trade-off
+// between noise and tracking (see processNoiseForBandwidth()). The frame interval may
+// vary from frame to frame.
+//
+// Storage is inline, so it can be a member of a Max object struct: init() sets all state.
+class KinematicKalmanFilter
+{
+public:
+	void init(double processNoise, double measurementNoise); // state is reset
+	void reset(); // next measurement (re)initializes position
+
+	double getProcessNoise() const { return q_; }
+	double getMeasurementNoise() const { return r_; }
+
+	// Updates the estimate with measurement z taken dt seconds after the previous one.
+	// Any of pos, vel and accel may be NULL.
+	void process(double z, double dt, float *pos, float *vel, float *accel);
+
+	// Process noise for which the (steady state) filter has approximately the given -3 dB
+	// bandwidth (Hz), for measurements at sampleRate: its poles then lie on a circle of
+	// radius 2*pi*bandwidth (3rd order Butterworth-like response).
+	static double processNoiseForBandwidth(double bandwidth, double measurementNoise, double sampleRate);
+
+private:
+	double q_;
+	double r_;
+
+	bool isInitialized_;
+	double x_[3];
+	double P_[3][3];
+};
+
+// ---------------------------------------------------------------------------------------
+
+inline void KinematicKalmanFilter::init(double processNoise, double measurementNoise)
+{
+	q_ = processNoise;
+	r_ = measurementNoise;
+	reset();
+}
+
+inline void KinematicKalmanFilter::reset()
+{
+	isInitialized_ = false;
+	for (int i = 0; i < 3; ++i)
+	{
+		x_[i] = 0.0;
+		for (int j = 0; j < 3; ++j)
+			P_[i][j] = 0.0;
+	}
+}
+
+inline void KinematicKalmanFilter::process(double z, double dt, float *pos, float *vel, float *accel)
+{
+	if (!isInitialized_)
+	{
+		// Start at rest at the first measurement, with velocity and acceleration
+		// uncertain enough to converge within a few frames:
+		x_[0] = z;
+		x_[1] = 0.0;
+		x_[2] = 0.0;
+		P_[0][0] = r_;
+		P_[1][1] = r_/(dt*dt)*1e4;
+		P_[2][2] = r_/(dt*dt*dt*dt)*1e6;
+		isInitialized_ = true;
+	}
+	else
+	{
+		// Predict: x = F x
+		const double dt2 = dt*dt;
+		x_[0] += dt*x_[1] + 0.5*dt2*x_[2];
+		x_[1] += dt*x_[2];
+
+		// P = F P F' + Q (F is upper triangular, written out):
+		double FP[3][3];
+		for (int j = 0; j < 3; ++j)
+		{
+			FP[0][j] = P_[0][j] + dt*P_[1][j] + 0.5*dt2*P_[2][j];
+			FP[1][j] = P_[1][j] + dt*P_[2][j];
+			FP[2][j] = P_[2][j];
+		}
+		for (int i = 0; i < 3; ++i)
+		{
+			P_[i][0] = FP[i][0] + dt*FP[i][1] + 0.5*dt2*FP[i][2];
+			P_[i][1] = FP[i][1] + dt*FP[i][2];
+			P_[i][2] = FP[i][2];
+		}
+
+		const double dt3 = dt2*dt;
+		P_[0][0] += q_*dt3*dt2/20.0;
+		P_[0][1] += q_*dt2*dt2/8.0;
+		P_[0][2] += q_*dt3/6.0;
+		P_[1][0] += q_*dt2*dt2/8.0;
+		P_[1][1] += q_*dt3/3.0;
+		P_[1][2] += q_*dt2/2.0;
+		P_[2][0] += q_*dt3/6.0;
+		P_[2][1] += q_*dt2/2.0;
+		P_[2][2] += q_*dt;
+
+		// Update (scalar measurement of position):
+		const double S = P_[0][0] + r_;
+		const double K[3] = { P_[0][0]/S, P_[1][0]/S, P_[2][0]/S };
+		const double innovation = z - x_[0];
+		for (int i = 0; i < 3; ++i)
+			x_[i] += K[i]*innovation;
+
+		const double P0[3] = { P_[0][0], P_[0][1], P_[0][2] };
+		for (int i = 0; i < 3; ++i)
+		{
+			for (int j = 0; j < 3; ++j)
+				P_[i][j] -= K[i]*P0[j];
+		}
+	}
+
+	if (pos != NULL)
+		*pos = (float)x_[0];
+	if (vel != NULL)
+		*vel = (float)x_[1];
+	if (accel != NULL)
+		*accel = (float)x_[2];
+}
+
+inline double KinematicKalmanFilter::processNoiseForBandwidth(double bandwidth, double measurementNoise, double sampleRate)
+{
+	// Continuous time equivalent: measurement noise density measurementNoise/sampleRate,
+	// poles at radius (q/density)^(1/6) for a triple integrator.
+	const double w = 2.0*3.1415926535897932384626433832795*bandwidth;
+	const double w3 = w*w*w;
+	return measurementNoise/sampleRate*w3*w3;
+}
+
+#endif
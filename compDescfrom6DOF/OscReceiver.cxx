@@ -0,0 +1,733 @@
+#define NOMINMAX // avoid min/max macros from windows.h
+#include <winsock2.h> // (must be included before windows.h)
+#include "OscReceiver.hxx"
+
+#include <cstdio>
+#include <cstring>
+#include <cassert>
+#include <algorithm>
+
+#include "concat/Utilities/Logging.hxx"
+
+// ---------------------------------------------------------------------------------------
+
+namespace
+{
+	const char *const frameAddress = "/qtm/data";
+	const char *const sixDofAddressPrefix = "/qtm/6d_euler/";
+	const int frameNumberArgIdx = 3; // (argv[4] in compDescfrom6DOF_6DOF(), argv[0] being the address)
+
+	const int maxPacketSize = 65536;
+	const int receiveTimeoutMilliseconds = 100; // (max. time stop() has to wait for the thread)
+	const int socketReceiveBufferSize = 1 << 20;
+
+	unsigned int readUint32Be(const char *p)
+	{
+		const unsigned char *u = (const unsigned char *)p;
+		return ((unsigned int)u[0] << 24) | ((unsigned int)u[1] << 16) | ((unsigned int)u[2] << 8) | (unsigned int)u[3];
+	}
+
+	float readFloatBe(const char *p)
+	{
+		unsigned int bits = readUint32Be(p);
+		float value;
+		memcpy(&value, &bits, sizeof(float));
+		return value;
+	}
+
+	double readDoubleBe(const char *p)
+	{
+		unsigned __int64 bits = ((unsigned __int64)readUint32Be(p) << 32) | readUint32Be(p + 4);
+		double value;
+		memcpy(&value, &bits, sizeof(double));
+		return value;
+	}
+
+	// Returns number of bytes taken by the (null-terminated, 4-byte padded) OSC string
+	// starting at data, or -1 if not properly terminated within size.
+	int getOscStringSize(const char *data, int size)
+	{
+		const char *end = (const char *)memchr(data, '\0', size);
+		if (end == NULL)
+			return -1;
+		int paddedSize = ((int)(end - data) + 4) & ~3;
+		return (paddedSize <= size) ? paddedSize : -1;
+	}
+
+	// Big-endian OSC packet writer with bounds checking.
+	class OscPacketWriter
+	{
+	public:
+		OscPacketWriter(char *buffer, int size) : buffer_(buffer), size_(size), pos_(0), ok_(true) {}
+
+		void writeUint32(unsigned int value)
+		{
+			if (!reserve(4))
+				return;
+			buffer_[pos_++] = (char)(value >> 24);
+			buffer_[pos_++] = (char)(value >> 16);
+			buffer_[pos_++] = (char)(value >> 8);
+			buffer_[pos_++] = (char)value;
+		}
+
+		void writeFloat(float value)
+		{
+			unsigned int bits;
+			memcpy(&bits, &value, sizeof(float));
+			writeUint32(bits);
+		}
+
+		void writeString(const char *str)
+		{
+			const int n = (int)strlen(str);
+			const int paddedSize = (n + 4) & ~3;
+			if (!reserve(paddedSize))
+				return;
+			memcpy(buffer_ + pos_, str, n);
+			memset(buffer_ + pos_ + n, 0, paddedSize - n);
+			pos_ += paddedSize;
+		}
+
+		void writeBytes(const char *data, int n)
+		{
+			if (!reserve(n))
+				return;
+			memcpy(buffer_ + pos_, data, n);
+			pos_ += n;
+		}
+
+		int getPos() const { return pos_; }
+		void patchUint32(int pos, unsigned int value)
+		{
+			int savedPos = pos_;
+			pos_ = pos;
+			writeUint32(value);
+			pos_ = savedPos;
+		}
+
+		bool isOk() const { return ok_; }
+
+	private:
+		bool reserve(int n)
+		{
+			if (!ok_ || pos_ + n > size_)
+				ok_ = false;
+			return ok_;
+		}
+
+		char *buffer_;
+		int size_;
+		int pos_;
+		bool ok_;
+	};
+}
+
+// ---------------------------------------------------------------------------------------
+
+OscReceiver::OscReceiver()
+{
+	socket_ = INVALID_SOCKET;
+	thread_ = NULL;
+	port_ = 0;
+	stopRequested_.set(false);
+
+	numViolins_ = 0;
+
+	curFrameNumber_ = 0;
+	hasCurFrame_ = false;
+	isCurFramePosted_ = false;
+
+	frameCallback_ = NULL;
+	frameCallbackContext_ = NULL;
+
+	captureFile_ = NULL;
+	::InitializeCriticalSection(&captureLock_);
+	::QueryPerformanceFrequency(&counterFrequency_);
+	captureStartTime_.QuadPart = 0;
+
+	numPacketsReceived_ = 0;
+	numMalformedPackets_ = 0;
+	numFramesDropped_ = 0;
+}
+
+OscReceiver::~OscReceiver()
+{
+	stop();
+	stopPacketCapture();
+	::DeleteCriticalSection(&captureLock_);
+}
+
+// ---------------------------------------------------------------------------------------
+
+void OscReceiver::setLabels(int numViolins, const std::vector<std::string> &violinLabels, const std::vector<std::string> &bowLabels)
+{
+	assert(!isRunning());
+	numViolins_ = std::min(numViolins, MAX_NUM_VIOLINS);
+	numViolins_ = std::min(numViolins_, (int)std::min(violinLabels.size(), bowLabels.size()));
+	violinLabels_ = violinLabels;
+	bowLabels_ = bowLabels;
+}
+
+void OscReceiver::setFrameCallback(FrameCallback callback, void *context)
+{
+	assert(!isRunning());
+	frameCallback_ = callback;
+	frameCallbackContext_ = context;
+}
+
+// ---------------------------------------------------------------------------------------
+
+bool OscReceiver::start(int port, int fifoCapacityFrames)
+{
+	stop();
+
+	WSADATA wsaData;
+	if (::WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+	{
+		LOG_ERROR_N("osc_receiver", "[r]ERROR: Failed to initialize Winsock.");
+		return false;
+	}
+
+	SOCKET s = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (s == INVALID_SOCKET)
+	{
+		LOG_ERROR_N("osc_receiver", "[r]ERROR: Failed to create UDP socket.");
+		::WSACleanup();
+		return false;
+	}
+
+	// Large receive buffer, so bursts aren't lost while the thread is descheduled, and a
+	// timeout so the thread can check if it should stop:
+	int bufferSize = socketReceiveBufferSize;
+	::setsockopt(s, SOL_SOCKET, SO_RCVBUF, (const char *)&bufferSize, sizeof(bufferSize));
+	DWORD timeout = receiveTimeoutMilliseconds;
+	::setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, (const char *)&timeout, sizeof(timeout));
+
+	sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_ANY);
+	address.sin_port = htons((u_short)port);
+	if (::bind(s, (const sockaddr *)&address, sizeof(address)) == SOCKET_ERROR)
+	{
+		LOG_ERROR_N("osc_receiver", concat::formatStr("[r]ERROR: Failed to bind UDP port %d (in use by udpreceive?).", port));
+		::closesocket(s);
+		::WSACleanup();
+		return false;
+	}
+
+	socket_ = (UINT_PTR)s;
+	port_ = port;
+
+	fifo_.reserve(fifoCapacityFrames + 1); // (+ 1, see LockFreeFifo notes)
+	hasCurFrame_ = false;
+	isCurFramePosted_ = false;
+	numPacketsReceived_ = 0;
+	numMalformedPackets_ = 0;
+	numFramesDropped_ = 0;
+
+	stopRequested_.set(false);
+	thread_ = ::CreateThread(NULL, 0, &OscReceiver::threadEntry, this, 0, NULL);
+	if (thread_ == NULL)
+	{
+		LOG_ERROR_N("osc_receiver", "[r]ERROR: Failed to create receiver thread.");
+		::closesocket(s);
+		::WSACleanup();
+		socket_ = INVALID_SOCKET;
+		return false;
+	}
+	::SetThreadPriority(thread_, THREAD_PRIORITY_ABOVE_NORMAL);
+
+	return true;
+}
+
+void OscReceiver::stop()
+{
+	if (thread_ == NULL)
+		return;
+
+	stopRequested_.set(true);
+	::WaitForSingleObject(thread_, INFINITE);
+	::CloseHandle(thread_);
+	thread_ = NULL;
+
+	::closesocket((SOCKET)socket_);
+	socket_ = INVALID_SOCKET;
+	::WSACleanup();
+}
+
+// ---------------------------------------------------------------------------------------
+
+DWORD WINAPI OscReceiver::threadEntry(LPVOID arg)
+{
+	static_cast<OscReceiver *>(arg)->run();
+	return 0;
+}
+
+void OscReceiver::run()
+{
+	std::vector<char> buffer(maxPacketSize);
+
+	while (!stopRequested_.isSet())
+	{
+		int size = ::recv((SOCKET)socket_, &buffer[0], maxPacketSize, 0);
+		if (size == SOCKET_ERROR)
+		{
+			// Timeouts are expected (so stop requests are seen), connection resets may
+			// be reported for UDP after an ICMP port unreachable, ignore both:
+			int error = ::WSAGetLastError();
+			if (error != WSAETIMEDOUT && error != WSAECONNRESET)
+				LOG_ERROR_N("osc_receiver", concat::formatStr("[r]ERROR: UDP receive failed (%d).", error));
+			continue;
+		}
+
+		++numPacketsReceived_;
+		capturePacket(&buffer[0], size);
+
+		if (!parsePacket(&buffer[0], size))
+			++numMalformedPackets_;
+	}
+}
+
+// ---------------------------------------------------------------------------------------
+
+int OscReceiver::getNumAvailableFrames() const
+{
+	return fifo_.getReadAvail();
+}
+
+int OscReceiver::readFrames(TrackerFrame *frames, int maxFrames)
+{
+	return fifo_.get(frames, maxFrames);
+}
+
+// ---------------------------------------------------------------------------------------
+
+bool OscReceiver::parsePacket(const char *data, int size)
+{
+	if (size < 4 || (size & 3) != 0)
+		return false;
+
+	if (size >= 16 && memcmp(data, "#bundle", 8) == 0)
+	{
+		// Bundle: "#bundle", 64-bit time tag, then elements of (32-bit size, contents).
+		// Time tags are ignored, frames are identified by the /qtm/data frame number.
+		int pos = 16;
+		while (pos < size)
+		{
+			if (pos + 4 > size)
+				return false;
+			const int elementSize = (int)readUint32Be(data + pos);
+			pos += 4;
+			if (elementSize <= 0 || elementSize > size - pos)
+				return false;
+			if (!parsePacket(data + pos, elementSize)) // (may be nested bundle)
+				return false;
+			pos += elementSize;
+		}
+		return true;
+	}
+
+	return parseMessage(data, size);
+}
+
+bool OscReceiver::parseMessage(const char *data, int size)
+{
+	const int addressSize = getOscStringSize(data, size);
+	if (addressSize < 0 || data[0] != '/')
+		return false;
+	const char *address = data;
+
+	const bool isFrame = (strcmp(address, frameAddress) == 0);
+	const bool isSixDof = (strncmp(address, sixDofAddressPrefix, strlen(sixDofAddressPrefix)) == 0);
+	if (!isFrame && !isSixDof)
+		return true; // (other QTM data, e.g. 3D markers, not used)
+
+	const int typeTagsSize = getOscStringSize(data + addressSize, size - addressSize);
+	if (typeTagsSize < 0 || data[addressSize] != ',')
+		return false;
+	const char *typeTags = data + addressSize + 1;
+
+	// Decode numeric arguments (only the first few are used):
+	const int maxNumValues = 8;
+	float values[maxNumValues];
+	const char *valuePtrs[maxNumValues];
+	int numValues = 0;
+
+	const char *arg = data + addressSize + typeTagsSize;
+	const char *end = data + size;
+	for (const char *tag = typeTags; *tag != '\0' && numValues < maxNumValues; ++tag)
+	{
+		switch (*tag)
+		{
+		case 'i':
+			if (arg + 4 > end) return false;
+			valuePtrs[numValues] = arg;
+			values[numValues++] = (float)(int)readUint32Be(arg);
+			arg += 4;
+			break;
+		case 'f':
+			if (arg + 4 > end) return false;
+			valuePtrs[numValues] = arg;
+			values[numValues++] = readFloatBe(arg);
+			arg += 4;
+			break;
+		case 'h':
+			if (arg + 8 > end) return false;
+			valuePtrs[numValues] = arg;
+			values[numValues++] = (float)(int)readUint32Be(arg + 4); // (low word)
+			arg += 8;
+			break;
+		case 'd':
+			if (arg + 8 > end) return false;
+			valuePtrs[numValues] = arg;
+			values[numValues++] = (float)readDoubleBe(arg);
+			arg += 8;
+			break;
+		default:
+			numValues = maxNumValues; // (unsupported argument type, stop decoding)
+			break;
+		}
+	}
+
+	if (isFrame)
+	{
+		if (numValues <= frameNumberArgIdx)
+			return false;
+		// Note: Frame number decoded through float above, re-read it exactly if integer:
+		DWORD frameNumber = (DWORD)values[frameNumberArgIdx];
+		if (typeTags[frameNumberArgIdx] == 'i')
+			frameNumber = readUint32Be(valuePtrs[frameNumberArgIdx]);
+		else if (typeTags[frameNumberArgIdx] == 'h')
+			frameNumber = readUint32Be(valuePtrs[frameNumberArgIdx] + 4);
+		beginFrame(frameNumber);
+		return true;
+	}
+
+	if (numValues < 6)
+		return false;
+	if (!hasCurFrame_)
+		return true; // (no /qtm/data seen yet, as in the Max path)
+
+	const char *label = address + strlen(sixDofAddressPrefix);
+	for (int i = 0; i < numViolins_; ++i)
+	{
+		if (violinLabels_[i] == label)
+		{
+			setBody(curFrame_.bodies[violinSampleIdx(i)], values);
+			curFrame_.receivedBodiesMask |= 1 << violinSampleIdx(i);
+			break;
+		}
+		else if (bowLabels_[i] == label)
+		{
+			setBody(curFrame_.bodies[bowSampleIdx(i)], values);
+			curFrame_.receivedBodiesMask |= 1 << bowSampleIdx(i);
+			break;
+		}
+	}
+
+	const unsigned int allBodiesMask = (1u << (2*numViolins_)) - 1;
+	if (!isCurFramePosted_ && curFrame_.receivedBodiesMask == allBodiesMask)
+		postFrame();
+
+	return true;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void OscReceiver::beginFrame(DWORD frameNumber)
+{
+	// Deliver previous frame if it wasn't complete yet:
+	if (hasCurFrame_ && !isCurFramePosted_)
+		postFrame();
+
+	for (int i = 0; i < 2*numViolins_; ++i)
+	{
+		curFrame_.bodies[i].initToZero();
+		curFrame_.bodies[i].frameCount = frameNumber;
+	}
+	curFrame_.receivedBodiesMask = 0;
+
+	curFrameNumber_ = frameNumber;
+	hasCurFrame_ = true;
+	isCurFramePosted_ = false;
+}
+
+void OscReceiver::postFrame()
+{
+	if (fifo_.put(curFrame_) == 0)
+		++numFramesDropped_; // (consumer not keeping up)
+	isCurFramePosted_ = true;
+
+	if (frameCallback_ != NULL)
+		frameCallback_(frameCallbackContext_);
+}
+
+void OscReceiver::setBody(TrackerSample &item, const float values[6])
+{
+	// Same units as compDescfrom6DOF_6DOF(): QTM positions in mm to cm, euler angles as is.
+	item.position[0] = values[0]/10;
+	item.position[1] = values[1]/10;
+	item.position[2] = values[2]/10;
+	item.orientation[0] = values[3];
+	item.orientation[1] = values[4];
+	item.orientation[2] = values[5];
+}
+
+// ---------------------------------------------------------------------------------------
+
+bool OscReceiver::startPacketCapture(const char *filename)
+{
+	stopPacketCapture();
+
+	FILE *file = fopen(filename, "wb");
+	if (file == NULL)
+	{
+		LOG_ERROR_N("osc_receiver", concat::formatStr("[r]ERROR: Failed to open capture file %s.", filename));
+		return false;
+	}
+
+	::EnterCriticalSection(&captureLock_);
+	captureFile_ = file;
+	captureStartTime_.QuadPart = 0; // (set on first packet)
+	::LeaveCriticalSection(&captureLock_);
+
+	return true;
+}
+
+void OscReceiver::stopPacketCapture()
+{
+	::EnterCriticalSection(&captureLock_);
+	if (captureFile_ != NULL)
+	{
+		fclose(captureFile_);
+		captureFile_ = NULL;
+	}
+	::LeaveCriticalSection(&captureLock_);
+}
+
+void OscReceiver::capturePacket(const char *data, int size)
+{
+	if (captureFile_ == NULL) // (checked again with lock held below)
+		return;
+
+	LARGE_INTEGER now;
+	::QueryPerformanceCounter(&now);
+
+	::EnterCriticalSection(&captureLock_);
+	if (captureFile_ != NULL)
+	{
+		if (captureStartTime_.QuadPart == 0)
+			captureStartTime_ = now;
+
+		// Note: Header written in native byte order, i.e. little-endian on x86.
+		unsigned int header[2];
+		header[0] = (unsigned int)size;
+		header[1] = (unsigned int)((now.QuadPart - captureStartTime_.QuadPart)*1000000/counterFrequency_.QuadPart);
+		fwrite(header, sizeof(header), 1, captureFile_);
+		fwrite(data, 1, size, captureFile_);
+	}
+	::LeaveCriticalSection(&captureLock_);
+}
+
+// ---------------------------------------------------------------------------------------
+
+OscSender::OscSender()
+{
+	socket_ = INVALID_SOCKET;
+	memset(address_, 0, sizeof(address_));
+
+	replayThread_ = NULL;
+	replaySpeed_ = 1.0;
+	stopReplayRequested_.set(false);
+}
+
+OscSender::~OscSender()
+{
+	stopReplayThread();
+	close();
+}
+
+bool OscSender::open(const char *host, int port)
+{
+	close();
+
+	WSADATA wsaData;
+	if (::WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+		return false;
+
+	SOCKET s = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (s == INVALID_SOCKET)
+	{
+		::WSACleanup();
+		return false;
+	}
+
+	sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = ::inet_addr(host);
+	address.sin_port = htons((u_short)port);
+	assert(sizeof(address) == sizeof(address_));
+	memcpy(address_, &address, sizeof(address_));
+
+	socket_ = (UINT_PTR)s;
+	return true;
+}
+
+void OscSender::close()
+{
+	stopReplayThread();
+
+	if (socket_ == INVALID_SOCKET)
+		return;
+
+	::closesocket((SOCKET)socket_);
+	socket_ = INVALID_SOCKET;
+	::WSACleanup();
+}
+
+bool OscSender::isOpen() const
+{
+	return (socket_ != INVALID_SOCKET);
+}
+
+bool OscSender::sendPacket(const char *data, int size)
+{
+	if (!isOpen())
+		return false;
+
+	int result = ::sendto((SOCKET)socket_, data, size, 0, (const sockaddr *)address_, sizeof(address_));
+	return (result == size);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+int OscSender::replayCapture(const char *filename, double speed, const AtomicFlag *stopRequested)
+{
+	FILE *file = fopen(filename, "rb");
+	if (file == NULL)
+		return -1;
+
+	LARGE_INTEGER frequency, startTime, now;
+	::QueryPerformanceFrequency(&frequency);
+	::QueryPerformanceCounter(&startTime);
+
+	std::vector<char> buffer(maxPacketSize);
+	int numPacketsSent = 0;
+	unsigned int header[2];
+
+	while (fread(header, sizeof(header), 1, file) == 1)
+	{
+		if (stopRequested != NULL && stopRequested->isSet())
+			break;
+
+		const int size = (int)header[0];
+		if (size <= 0 || size > maxPacketSize || fread(&buffer[0], 1, size, file) != (size_t)size)
+			break; // (truncated file)
+
+		if (speed > 0.0)
+		{
+			// Wait until packet's (scaled) arrival time: sleep coarsely, then yield until
+			// the exact time (Sleep() resolution is only about 1-15 ms).
+			const LONGLONG dueTicks = (LONGLONG)(header[1]/speed*frequency.QuadPart/1000000.0);
+			for (;;)
+			{
+				::QueryPerformanceCounter(&now);
+				const LONGLONG remainingTicks = dueTicks - (now.QuadPart - startTime.QuadPart);
+				if (remainingTicks <= 0)
+					break;
+				const LONGLONG remainingMilliseconds = remainingTicks*1000/frequency.QuadPart;
+				::Sleep(remainingMilliseconds > 2 ? (DWORD)(remainingMilliseconds - 2) : 0);
+			}
+		}
+
+		if (sendPacket(&buffer[0], size))
+			++numPacketsSent;
+	}
+
+	fclose(file);
+	return numPacketsSent;
+}
+
+bool OscSender::startReplayThread(const char *filename, double speed)
+{
+	stopReplayThread();
+	if (!isOpen())
+		return false;
+
+	replayFilename_ = filename;
+	replaySpeed_ = speed;
+	stopReplayRequested_.set(false);
+	replayThread_ = ::CreateThread(NULL, 0, &OscSender::replayThreadEntry, this, 0, NULL);
+	return (replayThread_ != NULL);
+}
+
+void OscSender::stopReplayThread()
+{
+	if (replayThread_ == NULL)
+		return;
+
+	stopReplayRequested_.set(true);
+	::WaitForSingleObject(replayThread_, INFINITE);
+	::CloseHandle(replayThread_);
+	replayThread_ = NULL;
+}
+
+bool OscSender::isReplaying() const
+{
+	return (replayThread_ != NULL && ::WaitForSingleObject(replayThread_, 0) == WAIT_TIMEOUT);
+}
+
+DWORD WINAPI OscSender::replayThreadEntry(LPVOID arg)
+{
+	OscSender *sender = static_cast<OscSender *>(arg);
+	int numPacketsSent = sender->replayCapture(sender->replayFilename_.c_str(), sender->replaySpeed_, &sender->stopReplayRequested_);
+	if (numPacketsSent < 0)
+		LOG_ERROR_N("osc_receiver", concat::formatStr("[r]ERROR: Failed to open capture file %s for replay.", sender->replayFilename_.c_str()));
+	return 0;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+int OscSender::buildFrameBundle(char *buffer, int bufferSize, DWORD frameNumber,
+	int numViolins, const std::vector<std::string> &violinLabels, const std::vector<std::string> &bowLabels,
+	const TrackerSample *bodies)
+{
+	OscPacketWriter writer(buffer, bufferSize);
+
+	writer.writeBytes("#bundle", 8);
+	writer.writeUint32(0); // time tag "immediately"
+	writer.writeUint32(1);
+
+	// /qtm/data (only the frame number argument is used by the receivers):
+	int sizePos = writer.getPos();
+	writer.writeUint32(0); // (patched below)
+	writer.writeString(frameAddress);
+	writer.writeString(",iiii");
+	writer.writeUint32(0);
+	writer.writeUint32(0);
+	writer.writeUint32(0);
+	writer.writeUint32(frameNumber);
+	writer.patchUint32(sizePos, writer.getPos() - sizePos - 4);
+
+	for (int i = 0; i < 2*numViolins; ++i)
+	{
+		const TrackerSample &item = bodies[i];
+		const std::string address = sixDofAddressPrefix + ((i & 1) ? bowLabels[i/2] : violinLabels[i/2]);
+
+		sizePos = writer.getPos();
+		writer.writeUint32(0); // (patched below)
+		writer.writeString(address.c_str());
+		writer.writeString(",ffffff");
+		writer.writeFloat(item.position[0]*10); // cm to mm
+		writer.writeFloat(item.position[1]*10);
+		writer.writeFloat(item.position[2]*10);
+		writer.writeFloat(item.orientation[0]);
+		writer.writeFloat(item.orientation[1]);
+		writer.writeFloat(item.orientation[2]);
+		writer.patchUint32(sizePos, writer.getPos() - sizePos - 4);
+	}
+
+	return writer.isOk() ? writer.getPos() : -1;
+}
@@ -0,0 +1,168 @@
+#ifndef INCLUDED_OSCRECEIVER_HXX
+#define INCLUDED_OSCRECEIVER_HXX
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "TrackerSample.hxx"
+#include "LockFreeFifo.hxx"
+#include "AtomicFlag.hxx"
+#include "ViolinRecordingPlugInConfig.hxx"
+
+// One tracker frame as assembled from the OSC stream: a violin and a bow rigid body for
+// each instrument, interleaved (see TrackerSample), only the first 2*numViolins are used.
+struct TrackerFrame
+{
+	TrackerSample bodies[2*MAX_NUM_VIOLINS];
+	unsigned int receivedBodiesMask; // bit b: bodies[b]
+};
+
+// Native receiver for the QTM real-time OSC stream.
+//
+// Normally QTM data goes udpreceive -> OSC route -> atom lists -> compDescfrom6DOF_6DOF(),
+// which re-parses the address symbols and copies the floats out of atoms for every rigid
+// body. This class instead binds a UDP port on its own thread, parses the binary OSC
+// packets (bundles or single messages) directly and assembles complete frames:
+// - /qtm/data starts a new frame (4th argument is the frame number, as in the Max path)
+// - /qtm/6d_euler/<label> x y z (mm) az el roll (degrees) sets the body with that label
+// A frame is posted as soon as all bodies of it have been received, or otherwise when the
+// next /qtm/data arrives (so frames with missing bodies are still delivered).
+//
+// Frames are handed to the consumer (the Max scheduler thread) through a single reader,
+// single writer lock-free FIFO; when it's full frames are dropped (and counted) rather
+// than blocking the network thread. An optional callback is called from the network
+// thread after every posted frame (e.g. to set a clock).
+//
+// Packets can be captured to a file (as received, see startPacketCapture()) and sent back
+// to a port with OscSender (e.g. 127.0.0.1 for loopback testing without QTM running).
+class OscReceiver
+{
+public:
+	typedef void (*FrameCallback)(void *context);
+
+	OscReceiver();
+	~OscReceiver();
+
+	// Configuration (only while not running):
+	void setLabels(int numViolins, const std::vector<std::string> &violinLabels, const std::vector<std::string> &bowLabels);
+	void setFrameCallback(FrameCallback callback, void *context);
+
+	// Starting/stopping the receiver thread:
+	bool start(int port, int fifoCapacityFrames);
+	void stop();
+	bool isRunning() const { return thread_ != NULL; }
+	int getPort() const { return port_; }
+
+	// Reading frames (consumer thread only):
+	int getNumAvailableFrames() const;
+	int readFrames(TrackerFrame *frames, int maxFrames);
+
+	// Capturing received packets (file format: per packet, a 32-bit little-endian size
+	// followed by a 32-bit arrival time in microseconds relative to the first packet,
+	// followed by the packet bytes):
+	bool startPacketCapture(const char *filename);
+	void stopPacketCapture();
+
+	// Statistics (approximate, may be read from any thread):
+	unsigned int getNumPacketsReceived() const { return numPacketsReceived_; }
+	unsigned int getNumMalformedPackets() const { return numMalformedPackets_; }
+	unsigned int getNumFramesDropped() const { return numFramesDropped_; }
+
+	// Parsing (called by the receiver thread, public so captured packets can be fed
+	// synchronously):
+	bool parsePacket(const char *data, int size);
+
+private:
+	static DWORD WINAPI threadEntry(LPVOID arg);
+	void run();
+
+	bool parseMessage(const char *data, int size);
+	void beginFrame(DWORD frameNumber);
+	void postFrame();
+	void setBody(TrackerSample &item, const float values[6]);
+
+	void capturePacket(const char *data, int size);
+
+private:
+	UINT_PTR socket_; // (SOCKET, but avoids including winsock2.h here)
+	HANDLE thread_;
+	int port_;
+	AtomicFlag stopRequested_;
+
+	int numViolins_;
+	std::vector<std::string> violinLabels_;
+	std::vector<std::string> bowLabels_;
+
+	LockFreeFifo<TrackerFrame> fifo_;
+	TrackerFrame curFrame_;
+	DWORD curFrameNumber_;
+	bool hasCurFrame_;
+	bool isCurFramePosted_;
+
+	FrameCallback frameCallback_;
+	void *frameCallbackContext_;
+
+	FILE *captureFile_;
+	CRITICAL_SECTION captureLock_;
+	LARGE_INTEGER captureStartTime_;
+	LARGE_INTEGER counterFrequency_;
+
+	volatile unsigned int numPacketsReceived_;
+	volatile unsigned int numMalformedPackets_;
+	volatile unsigned int numFramesDropped_;
+
+	OscReceiver(const OscReceiver &); // non-copyable
+	OscReceiver &operator=(const OscReceiver &); // non-copyable
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// Sends OSC packets over UDP, e.g. to replay a capture of OscReceiver to a receiver
+// listening on 127.0.0.1.
+class OscSender
+{
+public:
+	OscSender();
+	~OscSender();
+
+	bool open(const char *host, int port);
+	void close();
+	bool isOpen() const;
+
+	bool sendPacket(const char *data, int size);
+
+	// Replays a capture file (see OscReceiver::startPacketCapture()) with the original
+	// timing scaled by 1/speed, or as fast as possible if speed <= 0. Blocks until done
+	// or until stopRequested becomes true. Returns number of packets sent (-1 on error).
+	int replayCapture(const char *filename, double speed, const AtomicFlag *stopRequested = NULL);
+
+	// Same as replayCapture(), but on a separate thread (the sender must be open):
+	bool startReplayThread(const char *filename, double speed);
+	void stopReplayThread();
+	bool isReplaying() const;
+
+	// Builds a QTM-like bundle for one frame (a /qtm/data message followed by one
+	// /qtm/6d_euler/<label> message per body, 2*numViolins interleaved bodies), mainly for 
+	// testing. Returns bundle size (-1 if it doesn't fit in the buffer).
+	static int buildFrameBundle(char *buffer, int bufferSize, DWORD frameNumber,
+		int numViolins, const std::vector<std::string> &violinLabels, const std::vector<std::string> &bowLabels,
+		const TrackerSample *bodies);
+
+private:
+	static DWORD WINAPI replayThreadEntry(LPVOID arg);
+
+private:
+	UINT_PTR socket_;
+	char address_[16]; // (sockaddr_in)
+
+	HANDLE replayThread_;
+	std::string replayFilename_;
+	double replaySpeed_;
+	AtomicFlag stopReplayRequested_;
+
+	OscSender(const OscSender &); // non-copyable
+	OscSender &operator=(const OscSender &); // non-copyable
+};
+
+#endif
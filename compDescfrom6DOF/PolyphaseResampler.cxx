@@ -0,0 +1,168 @@
+#define NOMINMAX // avoid min/max macros from windows.h
+#include "PolyphaseResampler.hxx"
+
+#include <cmath>
+#include <algorithm>
+
+#include "FilterFirN.hxx" // firKernel
+
+// ---------------------------------------------------------------------------------------
+
+namespace
+{
+	const double pi = 3.1415926535897932384626433832795;
+
+	const int maxTapsPerPhase = 64;
+	const int maxNumChannels = 256;
+}
+
+// ---------------------------------------------------------------------------------------
+
+PolyphaseResampler::PolyphaseResampler()
+{
+	numChannels_ = 0;
+	tapsPerPhase_ = 0;
+	upFactor_ = 1;
+	downFactor_ = 1;
+	pos_ = 0;
+	phase_ = 0;
+	isFirstFrame_ = true;
+}
+
+bool PolyphaseResampler::init(double inputRate, double outputRate, int numChannels, int tapsPerPhase)
+{
+	if (inputRate <= 0.0 || outputRate <= 0.0)
+		return false;
+	if (numChannels < 1 || numChannels > maxNumChannels || tapsPerPhase < 1 || tapsPerPhase > maxTapsPerPhase)
+		return false;
+
+	int up, down;
+	approximateRatio(outputRate/inputRate, MAX_NUM_PHASES, up, down);
+	if (up < 1 || down < 1)
+		return false;
+
+	numChannels_ = numChannels;
+	tapsPerPhase_ = tapsPerPhase;
+	upFactor_ = up;
+	downFactor_ = down;
+
+	// Prototype lowpass at the upsampled rate (windowed sinc, Hann window), cutoff at the
+	// lower of the input and output Nyquist frequencies:
+	const int length = tapsPerPhase_*upFactor_;
+	const double center = 0.5*(length - 1);
+	const double cutoff = 0.5/std::max(upFactor_, downFactor_); // cycles per upsampled frame
+	std::vector<double> prototype(length);
+	for (int i = 0; i < length; ++i)
+	{
+		const double t = i - center;
+		const double sinc = (t == 0.0) ? 1.0 : std::sin(2.0*pi*cutoff*t)/(2.0*pi*cutoff*t);
+		const double window = 0.5 - 0.5*std::cos(2.0*pi*(i + 1)/(length + 1));
+		prototype[i] = sinc*window;
+	}
+
+	// Phases, normalized to unit gain at DC, time-reversed so that a phase applies to the
+	// window of the most recent input frames (oldest first):
+	coeffs_.resize(upFactor_*tapsPerPhase_);
+	for (int p = 0; p < upFactor_; ++p)
+	{
+		double sum = 0.0;
+		for (int j = 0; j < tapsPerPhase_; ++j)
+			sum += prototype[p + j*upFactor_];
+		for (int t = 0; t < tapsPerPhase_; ++t)
+			coeffs_[p*tapsPerPhase_ + t] = (float)(prototype[p + (tapsPerPhase_ - 1 - t)*upFactor_]/sum);
+	}
+
+	buffer_.resize(2*tapsPerPhase_*numChannels_);
+	reset();
+	return true;
+}
+
+void PolyphaseResampler::reset()
+{
+	std::fill(buffer_.begin(), buffer_.end(), 0.f);
+	pos_ = 0;
+	phase_ = 0;
+	isFirstFrame_ = true;
+}
+
+double PolyphaseResampler::getLatency() const
+{
+	return (tapsPerPhase_*upFactor_ - 1)/(2.0*upFactor_);
+}
+
+int PolyphaseResampler::getMaxNumOutputFrames(int numInputFrames) const
+{
+	return (numInputFrames*upFactor_ + downFactor_ - 1)/downFactor_ + 1;
+}
+
+int PolyphaseResampler::process(const float *input, int numInputFrames, float *output)
+{
+	const int K = tapsPerPhase_;
+	const int C = numChannels_;
+	int numOutputFrames = 0;
+
+	for (int n = 0; n < numInputFrames; ++n)
+	{
+		const float *x = input + n*C;
+
+		if (isFirstFrame_)
+		{
+			for (int i = 0; i < 2*K; ++i)
+				std::copy(x, x + C, buffer_.begin() + i*C);
+			isFirstFrame_ = false;
+		}
+
+		// Write input twice (see firKernel):
+		std::copy(x, x + C, buffer_.begin() + pos_*C);
+		std::copy(x, x + C, buffer_.begin() + (pos_ + K)*C);
+		++pos_;
+		if (pos_ >= K)
+			pos_ = 0;
+
+		// Outputs between this input frame and the next one:
+		const float *w = &buffer_[pos_*C];
+		while (phase_ < upFactor_)
+		{
+			firKernel::convolve(&coeffs_[phase_*K], w, K, C, output + numOutputFrames*C);
+			++numOutputFrames;
+			phase_ += downFactor_;
+		}
+		phase_ -= upFactor_;
+	}
+
+	return numOutputFrames;
+}
+
+// Best rational approximation (continued fractions) with numerator <= maxNumerator.
+void PolyphaseResampler::approximateRatio(double ratio, int maxNumerator, int &numerator, int &denominator)
+{
+	// Convergents h/k:
+	double hPrev = 1.0, h = std::floor(ratio);
+	double kPrev = 0.0, k = 1.0;
+	double x = ratio;
+	numerator = (int)h;
+	denominator = 1;
+	for (int i = 0; i < 32; ++i)
+	{
+		const double frac = x - std::floor(x);
+		if (frac < 1e-12)
+			break;
+		x = 1.0/frac;
+		const double a = std::floor(x);
+		const double hNext = a*h + hPrev;
+		const double kNext = a*k + kPrev;
+		if (hNext > maxNumerator || kNext > 1e9)
+			break;
+		hPrev = h; h = hNext;
+		kPrev = k; k = kNext;
+		numerator = (int)h;
+		denominator = (int)k;
+	}
+
+	if (numerator < 1)
+	{
+		// (ratio < 1/denominator bound, downsample by the nearest integer)
+		numerator = 1;
+		denominator = std::max((int)(1.0/ratio + 0.5), 1);
+	}
+}
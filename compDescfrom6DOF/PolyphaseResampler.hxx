@@ -0,0 +1,64 @@
+#ifndef INCLUDED_POLYPHASERESAMPLER_HXX
+#define INCLUDED_POLYPHASERESAMPLER_HXX
+
+#include <vector>
+
+// Streaming sample rate conversion of frame-rate signals (e.g. descriptor streams from the
+// 240 Hz tracker rate to the 44100/256 Hz synthesis frame rate, or raw positions).
+//
+// The rate ratio is approximated by a fraction L/M (L <= MAX_NUM_PHASES, exact for
+// 44100/256 over 240 = 735/1024). Conceptually the input is upsampled by L, lowpass
+// filtered (windowed sinc at the lower of both Nyquist frequencies) and downsampled by M;
+// only the needed outputs are computed, each as the dot product of the most recent
+// tapsPerPhase input frames with one of the L phases of the filter, so the cost per
+// output frame doesn't depend on L or M.
+//
+// Latency is the group delay of the filter, about tapsPerPhase/2 input frames (e.g. 4
+// frames, 17 ms at 240 Hz for 8 taps): fewer taps give less delay but more aliasing.
+// Each phase sums to one, so constant signals pass unchanged. Before the first input
+// frame the signal is taken to be constant (no startup ramp).
+//
+// Channels are interleaved (channel index innermost, see firKernel), processing is done
+// in blocks of any number of input frames, without allocation (only init() allocates).
+// Signals with discontinuities (e.g. euler angles wrapping around) must be unwrapped.
+class PolyphaseResampler
+{
+public:
+	enum { MAX_NUM_PHASES = 1024, DEFAULT_TAPS_PER_PHASE = 8 };
+
+	PolyphaseResampler();
+
+	// Returns false if the rates or sizes are not valid (state is then unchanged).
+	bool init(double inputRate, double outputRate, int numChannels, int tapsPerPhase = DEFAULT_TAPS_PER_PHASE);
+	void reset();
+
+	int getNumChannels() const { return numChannels_; }
+	int getUpFactor() const { return upFactor_; } // L
+	int getDownFactor() const { return downFactor_; } // M
+	double getLatency() const; // input frames
+
+	// Upper bound of the output frames produced by numInputFrames input frames.
+	int getMaxNumOutputFrames(int numInputFrames) const;
+
+	// Resamples numInputFrames frames from input into output (numChannels interleaved
+	// values per frame, output of at least getMaxNumOutputFrames()), returns the number of
+	// output frames.
+	int process(const float *input, int numInputFrames, float *output);
+
+private:
+	static void approximateRatio(double ratio, int maxNumerator, int &numerator, int &denominator);
+
+	int numChannels_;
+	int tapsPerPhase_;
+	int upFactor_;
+	int downFactor_;
+
+	std::vector<float> coeffs_; // upFactor_ phases of tapsPerPhase_ coefficients (time-reversed)
+
+	std::vector<float> buffer_; // 2*tapsPerPhase_ frames (see firKernel)
+	int pos_;
+	int phase_; // of the next output frame relative to the most recent input frame, in 1/L input frames
+	bool isFirstFrame_;
+};
+
+#endif
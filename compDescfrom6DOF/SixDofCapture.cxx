@@ -0,0 +1,206 @@
+#include "SixDofCapture.hxx"
+
+#include <cstring>
+
+#include <windows.h> // QueryPerformanceCounter() (already included by ext.h)
+
+// ---------------------------------------------------------------------------------------
+
+namespace
+{
+	const char fileMagic[8] = { '6', 'D', 'O', 'F', 'C', 'A', 'P', 1 };
+	const int fileBufferSize = 1 << 16;
+
+	template<typename T>
+	bool readValue(FILE *file, T &value)
+	{
+		return (fread(&value, sizeof(T), 1, file) == 1);
+	}
+
+	template<typename T>
+	void writeValue(FILE *file, const T &value)
+	{
+		fwrite(&value, sizeof(T), 1, file);
+	}
+}
+
+double getSixDofCaptureTimeMs()
+{
+	static LARGE_INTEGER frequency = { 0 };
+	if (frequency.QuadPart == 0)
+		::QueryPerformanceFrequency(&frequency);
+
+	LARGE_INTEGER now;
+	::QueryPerformanceCounter(&now);
+	return (double)now.QuadPart*1000.0/(double)frequency.QuadPart;
+}
+
+// ---------------------------------------------------------------------------------------
+
+SixDofCaptureWriter::SixDofCaptureWriter()
+{
+	file_ = NULL;
+	startTimeMs_ = 0.0;
+	numMessages_ = 0;
+}
+
+SixDofCaptureWriter::~SixDofCaptureWriter()
+{
+	close();
+}
+
+bool SixDofCaptureWriter::open(const char *filename)
+{
+	close();
+
+	file_ = fopen(filename, "wb");
+	if (file_ == NULL)
+		return false;
+	setvbuf(file_, NULL, _IOFBF, fileBufferSize); // (few actual disk writes while capturing)
+
+	fwrite(fileMagic, sizeof(fileMagic), 1, file_);
+	numMessages_ = 0;
+	symbolIdxs_.clear();
+	return true;
+}
+
+void SixDofCaptureWriter::close()
+{
+	if (file_ == NULL)
+		return;
+
+	fclose(file_);
+	file_ = NULL;
+}
+
+void SixDofCaptureWriter::write(short argc, const t_atom *argv)
+{
+	if (file_ == NULL)
+		return;
+
+	const double nowMs = getSixDofCaptureTimeMs();
+	if (numMessages_ == 0)
+		startTimeMs_ = nowMs;
+	++numMessages_;
+
+	if (argc > SixDofCaptureReader::MAX_NUM_ATOMS)
+		argc = SixDofCaptureReader::MAX_NUM_ATOMS;
+	writeValue(file_, nowMs - startTimeMs_);
+	writeValue(file_, (unsigned char)argc);
+
+	for (int i = 0; i < argc; ++i)
+	{
+		switch (argv[i].a_type)
+		{
+		case A_LONG:
+			writeValue(file_, 'l');
+			writeValue(file_, (int)argv[i].a_w.w_long);
+			break;
+		case A_FLOAT:
+			writeValue(file_, 'f');
+			writeValue(file_, (float)argv[i].a_w.w_float);
+			break;
+		case A_SYM:
+			{
+				std::map<t_symbol *, unsigned short>::const_iterator it = symbolIdxs_.find(argv[i].a_w.w_sym);
+				if (it != symbolIdxs_.end())
+				{
+					writeValue(file_, 'S');
+					writeValue(file_, it->second);
+				}
+				else
+				{
+					const char *name = argv[i].a_w.w_sym->s_name;
+					const size_t nameLength = strlen(name);
+					const unsigned char length = (unsigned char)(nameLength < 255 ? nameLength : 255);
+					writeValue(file_, 's');
+					writeValue(file_, length);
+					fwrite(name, 1, length, file_);
+
+					const unsigned short idx = (unsigned short)symbolIdxs_.size();
+					symbolIdxs_[argv[i].a_w.w_sym] = idx;
+				}
+			}
+			break;
+		default:
+			writeValue(file_, 'l'); // (keep atom count/positions, 6DOF messages don't have other types)
+			writeValue(file_, (int)0);
+			break;
+		}
+	}
+}
+
+// ---------------------------------------------------------------------------------------
+
+bool SixDofCaptureReader::load(const char *filename)
+{
+	messages_.clear();
+
+	FILE *file = fopen(filename, "rb");
+	if (file == NULL)
+		return false;
+	setvbuf(file, NULL, _IOFBF, fileBufferSize);
+
+	char magic[sizeof(fileMagic)];
+	if (fread(magic, sizeof(magic), 1, file) != 1 || memcmp(magic, fileMagic, sizeof(fileMagic)) != 0)
+	{
+		fclose(file);
+		return false;
+	}
+
+	std::vector<t_symbol *> symbols;
+	Message message;
+	unsigned char argc;
+	bool ok = true;
+
+	while (ok && readValue(file, message.timeMs))
+	{
+		ok = readValue(file, argc) && argc <= MAX_NUM_ATOMS;
+		message.argc = argc;
+
+		for (int i = 0; ok && i < argc; ++i)
+		{
+			char type;
+			ok = readValue(file, type);
+			if (!ok)
+				break;
+
+			if (type == 'l')
+			{
+				int value;
+				ok = readValue(file, value);
+				SETLONG(&message.argv[i], value);
+			}
+			else if (type == 'f')
+			{
+				float value;
+				ok = readValue(file, value);
+				SETFLOAT(&message.argv[i], value);
+			}
+			else if (type == 's')
+			{
+				unsigned char length;
+				char name[256];
+				ok = readValue(file, length) && fread(name, 1, length, file) == length;
+				name[length] = '\0';
+				symbols.push_back(gensym(name)); // (gensym() done here, not while replaying)
+				SETSYM(&message.argv[i], symbols.back());
+			}
+			else if (type == 'S')
+			{
+				unsigned short idx;
+				ok = readValue(file, idx) && idx < symbols.size();
+				if (ok)
+					SETSYM(&message.argv[i], symbols[idx]);
+			}
+			else
+				ok = false;
+		}
+
+		if (ok)
+			messages_.push_back(message);
+	}
+
+	fclose(file);
+	return !messages_.empty();
+}
@@ -0,0 +1,72 @@
+#ifndef INCLUDED_SIXDOFCAPTURE_HXX
+#define INCLUDED_SIXDOFCAPTURE_HXX
+
+#include <cstdio>
+#include <map>
+#include <vector>
+
+#include "ext.h" // Required for all Max external objects
+
+// Capture and replay of the 6DOF messages received by compDescfrom6DOF, so tracker input
+// can be reproduced (and load-tested) without QTM running.
+//
+// File format (native byte order, i.e. little-endian on x86):
+// - header: "6DOFCAP", version byte
+// - per message: double arrival time in ms (relative to first message), unsigned char
+//   argc, then argc atoms of a type byte followed by:
+//   'l': 32-bit int
+//   'f': 32-bit float
+//   's': new symbol, unsigned char length + chars (gets next symbol index)
+//   'S': unsigned short index of a previously written symbol
+// Symbols are mostly the OSC addresses repeated every frame, so indexing them keeps the
+// file at roughly the size of the numeric data.
+
+// Timestamps used for capturing/replaying (ms, high resolution, arbitrary origin).
+double getSixDofCaptureTimeMs();
+
+class SixDofCaptureWriter
+{
+public:
+	SixDofCaptureWriter();
+	~SixDofCaptureWriter();
+
+	bool open(const char *filename);
+	void close();
+	bool isOpen() const { return file_ != NULL; }
+
+	void write(short argc, const t_atom *argv);
+
+	unsigned int getNumMessages() const { return numMessages_; }
+
+private:
+	FILE *file_;
+	double startTimeMs_;
+	unsigned int numMessages_;
+	std::map<t_symbol *, unsigned short> symbolIdxs_;
+
+	SixDofCaptureWriter(const SixDofCaptureWriter &); // non-copyable
+	SixDofCaptureWriter &operator=(const SixDofCaptureWriter &); // non-copyable
+};
+
+class SixDofCaptureReader
+{
+public:
+	enum { MAX_NUM_ATOMS = 8 }; // (6DOF messages have 7 or 8 atoms)
+
+	struct Message
+	{
+		double timeMs;
+		short argc;
+		t_atom argv[MAX_NUM_ATOMS];
+	};
+
+	// Reads whole file, so replaying doesn't do any file access.
+	bool load(const char *filename);
+
+	const std::vector<Message> &getMessages() const { return messages_; }
+
+private:
+	std::vector<Message> messages_;
+};
+
+#endif
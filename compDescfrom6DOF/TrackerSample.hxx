@@ -0,0 +1,104 @@
+#ifndef INCLUDED_TRACKERSAMPLE_HXX
+#define INCLUDED_TRACKERSAMPLE_HXX
+
+#include <windows.h> // DWORD
+
+#include "LibertyTracker.hxx"
+
+// Compact record of one rigid body in one tracker frame: only what the descriptor
+// computation uses of LibertyTracker::ItemData (28 instead of 44 bytes, no PDI header
+// and stylus/external sync words, which the 6DOF/OSC input never fills in).
+//
+// A frame is 2*numViolins consecutive samples, interleaved as violin 0, bow 0, violin 1,
+// bow 1, etc. (bit b of a received bodies mask refers to sample b), so its size follows
+// the actual ensemble instead of MAX_NUM_VIOLINS.
+struct TrackerSample
+{
+	DWORD frameCount;
+
+	float position[3]; // cm
+	float orientation[3]; // euler angles in degrees (azimuth, elevation, roll)
+
+	void initToZero()
+	{
+		frameCount = 0;
+
+		position[0] = 0.0f;
+		position[1] = 0.0f;
+		position[2] = 0.0f;
+
+		orientation[0] = 0.0f;
+		orientation[1] = 0.0f;
+		orientation[2] = 0.0f;
+	}
+
+	void fromItemData(const LibertyTracker::ItemData &item)
+	{
+		frameCount = item.frameCount;
+
+		position[0] = item.position[0];
+		position[1] = item.position[1];
+		position[2] = item.position[2];
+
+		orientation[0] = item.orientation[0];
+		orientation[1] = item.orientation[1];
+		orientation[2] = item.orientation[2];
+	}
+};
+
+// Index of a body's sample within a frame:
+inline int violinSampleIdx(int violin) { return 2*violin; }
+inline int bowSampleIdx(int violin) { return 2*violin + 1; }
+
+// Iterator for circular buffer of samples (same as LibertyTracker::ItemDataIterator).
+class TrackerSampleIterator
+{
+public:
+	TrackerSampleIterator()
+	{
+		circBufferBase_ = NULL;
+		idx_ = 0;
+		size_ = 0;
+	}
+
+	TrackerSampleIterator(const TrackerSample *circBufferBase, int idx, int size)
+	{
+		circBufferBase_ = circBufferBase;
+		idx_ = idx; // possibly not wrapped
+		size_ = size;
+	}
+
+	void next()
+	{
+		advance(1);
+	}
+
+	void advance(int count)
+	{
+		idx_ += count;
+		wrap();
+	}
+
+	void wrap()
+	{
+		if (size_ <= 0)
+			return;
+
+		while (idx_ >= size_)
+		{
+			idx_ = idx_ - size_;
+		}
+	}
+
+	const TrackerSample &item() const
+	{
+		return circBufferBase_[idx_];
+	}
+
+private:
+	const TrackerSample *circBufferBase_;
+	int idx_;
+	int size_;
+};
+
+#endif
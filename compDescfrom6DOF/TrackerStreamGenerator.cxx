@@ -0,0 +1,294 @@
+#define NOMINMAX // avoid min/max macros from windows.h
+#include "TrackerStreamGenerator.hxx"
+
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+
+#include "TrackerCalibration.hxx"
+#include "OscReceiver.hxx"
+
+// ---------------------------------------------------------------------------------------
+
+namespace
+{
+	const double pi = 3.1415926535897932384626433832795;
+
+	const double minStrokeDuration = 0.25; // s
+	const double maxStrokeDuration = 2.0;
+	const double bowMargin = 5.0; // cm, unused hair at frog and tip
+	const double crossingFraction = 0.15; // part of stroke used for string crossings
+	const double stringCrossingProbability = 0.3;
+	const double liftedStrokeProbability = 0.1;
+	const double liftHeight = 2.0; // cm
+	const double minBowBridgeDist = 1.5; // cm
+	const double maxBowBridgeDist = 5.0;
+	const double hairTiltRadians = 15.0*pi/180.0;
+	const double instrumentSpacing = 100.0; // cm
+
+	double smoothStep(double x)
+	{
+		x = (x < 0.0) ? 0.0 : ((x > 1.0) ? 1.0 : x);
+		return x*x*(3.0 - 2.0*x);
+	}
+
+	// Matrix with the given vectors as columns.
+	Matrix3x3 fromColumns(const Matrix3x1 &c0, const Matrix3x1 &c1, const Matrix3x1 &c2)
+	{
+		return Matrix3x3(
+			c0(0, 0), c1(0, 0), c2(0, 0),
+			c0(1, 0), c1(1, 0), c2(1, 0),
+			c0(2, 0), c1(2, 0), c2(2, 0));
+	}
+
+	Matrix3x3 transpose(const Matrix3x3 &m)
+	{
+		return Matrix3x3(
+			m(0, 0), m(1, 0), m(2, 0),
+			m(0, 1), m(1, 1), m(2, 1),
+			m(0, 2), m(1, 2), m(2, 2));
+	}
+}
+
+// ---------------------------------------------------------------------------------------
+
+TrackerStreamGenerator::TrackerStreamGenerator()
+{
+	numInstruments_ = 0;
+	sampleRate_ = 240.0;
+	frameNumber_ = 0;
+}
+
+void TrackerStreamGenerator::init(int numInstruments, double sampleRate, const TrackerCalibration &calibration, int numCalibratedViolins, unsigned int seed)
+{
+	numInstruments_ = (numInstruments < 1) ? 1 : ((numInstruments > MAX_NUM_INSTRUMENTS) ? MAX_NUM_INSTRUMENTS : numInstruments);
+	sampleRate_ = sampleRate;
+	frameNumber_ = 0;
+
+	if (numCalibratedViolins < 1)
+		numCalibratedViolins = 1;
+
+	const int bridgeIdxs[4] = { TrackerCalibration::STR1_BRIDGE, TrackerCalibration::STR2_BRIDGE, TrackerCalibration::STR3_BRIDGE, TrackerCalibration::STR4_BRIDGE };
+	const int fingerboardIdxs[4] = { TrackerCalibration::STR1_FB, TrackerCalibration::STR2_FB, TrackerCalibration::STR3_FB, TrackerCalibration::STR4_FB };
+
+	for (int i = 0; i < numInstruments_; ++i)
+	{
+		Instrument &instrument = instruments_[i];
+		const int calibViolin = i % numCalibratedViolins;
+
+		for (int s = 0; s < 4; ++s)
+		{
+			instrument.bridge[s] = calibration.getBeta(calibViolin, bridgeIdxs[s]);
+			instrument.fingerboard[s] = calibration.getBeta(calibViolin, fingerboardIdxs[s]);
+		}
+		// The bridge is arched, so middle strings are further from the top plate:
+		instrument.archUp = normalize((instrument.bridge[1] + instrument.bridge[2]) - (instrument.bridge[0] + instrument.bridge[3]));
+
+		const Matrix3x1 &frogLhs = calibration.getBeta(calibViolin, TrackerCalibration::BOW_FROG_LHS);
+		const Matrix3x1 &frogRhs = calibration.getBeta(calibViolin, TrackerCalibration::BOW_FROG_RHS);
+		const Matrix3x1 &tipLhs = calibration.getBeta(calibViolin, TrackerCalibration::BOW_TIP_LHS);
+		const Matrix3x1 &tipRhs = calibration.getBeta(calibViolin, TrackerCalibration::BOW_TIP_RHS);
+		instrument.frog = (frogLhs + frogRhs)*0.5;
+		const Matrix3x1 tip = (tipLhs + tipRhs)*0.5;
+		instrument.hairLength = euclidean_length(tip - instrument.frog);
+		instrument.hairDir = normalize(tip - instrument.frog);
+		const Matrix3x1 across = frogRhs - frogLhs;
+		instrument.ribbonDir = normalize(across - instrument.hairDir*dot(across, instrument.hairDir));
+
+		instrument.rngState = (seed + 1)*2654435761u*(unsigned int)(i + 1);
+		if (instrument.rngState == 0)
+			instrument.rngState = 1;
+
+		instrument.basePos = Matrix3x1(i*instrumentSpacing, 0.0, 120.0);
+		instrument.baseOrientation = Matrix3x1(random(instrument, -pi, pi), random(instrument, -0.2, 0.2), random(instrument, -0.3, 0.3));
+		instrument.swayFreq = random(instrument, 0.1, 0.5);
+		instrument.swayPhase = random(instrument, 0.0, 2.0*pi);
+
+		instrument.strokeEndDisplacement = bowMargin;
+		instrument.strokeEndString = (double)(i % 4);
+		instrument.strokeEndBowBridgeDist = random(instrument, minBowBridgeDist, maxBowBridgeDist);
+		startNewStroke(instrument, 0.0);
+	}
+}
+
+// ---------------------------------------------------------------------------------------
+
+void TrackerStreamGenerator::generateFrame(TrackerSample *bodies)
+{
+	const double time = frameNumber_/sampleRate_;
+
+	for (int i = 0; i < numInstruments_; ++i)
+	{
+		Instrument &instrument = instruments_[i];
+		while (time >= instrument.strokeStartTime + instrument.strokeDuration)
+			startNewStroke(instrument, instrument.strokeStartTime + instrument.strokeDuration);
+
+		TrackerSample &violin = bodies[violinSampleIdx(i)];
+		TrackerSample &bow = bodies[bowSampleIdx(i)];
+		violin.frameCount = frameNumber_;
+		bow.frameCount = frameNumber_;
+		computePose(instrument, time, violin, bow);
+	}
+
+	++frameNumber_;
+}
+
+void TrackerStreamGenerator::startNewStroke(Instrument &instrument, double time)
+{
+	instrument.strokeStartTime = time;
+	instrument.strokeDuration = random(instrument, minStrokeDuration, maxStrokeDuration);
+
+	// Alternate down/up bows (unless there's no hair left in that direction), length a 
+	// random part of the usable hair:
+	const double minDisplacement = bowMargin;
+	const double maxDisplacement = instrument.hairLength - bowMargin;
+	const double length = random(instrument, 0.3, 0.9)*(maxDisplacement - minDisplacement);
+	const bool wasTowardsTip = (instrument.strokeEndDisplacement > instrument.strokeStartDisplacement);
+	instrument.strokeStartDisplacement = instrument.strokeEndDisplacement;
+	const bool fitsTowardsTip = (instrument.strokeStartDisplacement + length <= maxDisplacement);
+	const bool fitsTowardsFrog = (instrument.strokeStartDisplacement - length >= minDisplacement);
+	if (fitsTowardsTip && (wasTowardsTip ? !fitsTowardsFrog : true))
+		instrument.strokeEndDisplacement = instrument.strokeStartDisplacement + length;
+	else
+		instrument.strokeEndDisplacement = std::max(instrument.strokeStartDisplacement - length, minDisplacement);
+
+	instrument.strokeStartString = instrument.strokeEndString;
+	if (random(instrument, 0.0, 1.0) < stringCrossingProbability)
+	{
+		double nextString = instrument.strokeStartString + ((random(instrument, 0.0, 1.0) < 0.5) ? -1.0 : 1.0);
+		instrument.strokeEndString = (nextString < 0.0) ? 1.0 : ((nextString > 3.0) ? 2.0 : nextString);
+	}
+
+	instrument.strokeStartBowBridgeDist = instrument.strokeEndBowBridgeDist;
+	instrument.strokeEndBowBridgeDist = random(instrument, minBowBridgeDist, maxBowBridgeDist);
+
+	instrument.isStrokeLifted = (random(instrument, 0.0, 1.0) < liftedStrokeProbability);
+}
+
+void TrackerStreamGenerator::computePose(Instrument &instrument, double time, TrackerSample &violin, TrackerSample &bow)
+{
+	const double phase = (time - instrument.strokeStartTime)/instrument.strokeDuration;
+
+	// Bow displacement with (raised cosine) velocity going to zero at stroke changes:
+	const double displacement = instrument.strokeStartDisplacement +
+		(instrument.strokeEndDisplacement - instrument.strokeStartDisplacement)*0.5*(1.0 - cos(pi*phase));
+	const double string = instrument.strokeStartString +
+		(instrument.strokeEndString - instrument.strokeStartString)*smoothStep(phase/crossingFraction);
+	const double bowBridgeDist = instrument.strokeStartBowBridgeDist +
+		(instrument.strokeEndBowBridgeDist - instrument.strokeStartBowBridgeDist)*phase;
+	const double lift = instrument.isStrokeLifted ? liftHeight*sin(pi*phase) : 0.0;
+
+	// Contact point and bow orientation in violin frame:
+	const Matrix3x1 bridgePoint = stringPoint(instrument.bridge, string);
+	const Matrix3x1 stringDir = normalize(stringPoint(instrument.fingerboard, string) - bridgePoint);
+	const Matrix3x1 contact = bridgePoint + stringDir*bowBridgeDist;
+
+	// Bow lies along the tangent of the bridge arc at the played string (touching it
+	// but not its neighbours), blended between strings while crossing:
+	const int s0 = std::min((int)floor(string), 2);
+	const double frac = string - s0;
+	const Matrix3x1 tangent = bridgeTangent(instrument, s0)*(1.0 - frac) + bridgeTangent(instrument, s0 + 1)*frac;
+	const Matrix3x1 bowDir = normalize(tangent - stringDir*dot(tangent, stringDir));
+	Matrix3x1 upDir = normalize(cross(stringDir, bowDir));
+	if (dot(upDir, instrument.archUp) < 0.0)
+		upDir *= -1.0;
+	const Matrix3x1 ribbonDir = stringDir*cos(hairTiltRadians) + upDir*sin(hairTiltRadians);
+
+	const Matrix3x3 bowBasis = fromColumns(instrument.hairDir, instrument.ribbonDir, cross(instrument.hairDir, instrument.ribbonDir));
+	const Matrix3x3 violinBasis = fromColumns(bowDir, ribbonDir, cross(bowDir, ribbonDir));
+	const Matrix3x3 bowToViolinRot = violinBasis*transpose(bowBasis);
+
+	const Matrix3x1 hairPoint = instrument.frog + instrument.hairDir*displacement;
+	const Matrix3x1 bowPosInViolin = contact + upDir*lift - bowToViolinRot*hairPoint;
+
+	// Violin pose in world frame:
+	const double sway = sin(2.0*pi*instrument.swayFreq*time + instrument.swayPhase);
+	const Matrix3x1 violinPos = instrument.basePos + Matrix3x1(1.0, 0.5, 0.5)*sway;
+	const Matrix3x1 violinOrientation = instrument.baseOrientation + Matrix3x1(0.05, 0.03, 0.08)*sway;
+	const Matrix3x3 violinRot = Matrix3x3::rotation_matrix_zyx(violinOrientation(0, 0), violinOrientation(1, 0), violinOrientation(2, 0));
+
+	const Matrix3x1 bowPos = violinPos + violinRot*bowPosInViolin;
+	const Matrix3x1 bowOrientation = toEulerDegrees(violinRot*bowToViolinRot);
+
+	for (int k = 0; k < 3; ++k)
+	{
+		violin.position[k] = (float)violinPos(k, 0);
+		violin.orientation[k] = (float)(violinOrientation(k, 0)*180.0/pi);
+		bow.position[k] = (float)bowPos(k, 0);
+		bow.orientation[k] = (float)bowOrientation(k, 0);
+	}
+}
+
+// ---------------------------------------------------------------------------------------
+
+// xorshift32, per instrument so instruments don't depend on each other
+double TrackerStreamGenerator::random(Instrument &instrument, double min, double max)
+{
+	unsigned int x = instrument.rngState;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	instrument.rngState = x;
+	return min + (max - min)*(x/4294967296.0);
+}
+
+Matrix3x1 TrackerStreamGenerator::bridgeTangent(const Instrument &instrument, int string)
+{
+	return instrument.bridge[std::min(string + 1, 3)] - instrument.bridge[std::max(string - 1, 0)];
+}
+
+// Linear interpolation between string points for fractional (crossing) string index.
+Matrix3x1 TrackerStreamGenerator::stringPoint(const Matrix3x1 *points, double string)
+{
+	const int s0 = std::min((int)floor(string), 2);
+	const double frac = string - s0;
+	return points[s0]*(1.0 - frac) + points[s0 + 1]*frac;
+}
+
+// Inverse of Matrix3x3::rotation_matrix_zyx() (rot = Rz(azimuth)*Ry(elevation)*Rx(roll)).
+Matrix3x1 TrackerStreamGenerator::toEulerDegrees(const Matrix3x3 &rot)
+{
+	const double sinElevation = std::max(-1.0, std::min(1.0, -rot(2, 0)));
+	const double azimuth = atan2(rot(1, 0), rot(0, 0));
+	const double elevation = asin(sinElevation);
+	const double roll = atan2(rot(2, 1), rot(2, 2));
+	return Matrix3x1(azimuth, elevation, roll)*(180.0/pi);
+}
+
+// ---------------------------------------------------------------------------------------
+
+bool TrackerStreamGenerator::writeOscCapture(const char *filename, int numFrames, const std::vector<std::string> &violinLabels, const std::vector<std::string> &bowLabels)
+{
+	if ((int)violinLabels.size() < numInstruments_ || (int)bowLabels.size() < numInstruments_)
+		return false;
+
+	FILE *file = fopen(filename, "wb");
+	if (file == NULL)
+		return false;
+
+	TrackerSample bodies[2*MAX_NUM_INSTRUMENTS];
+	char packet[16384];
+	bool ok = true;
+
+	for (int i = 0; i < numFrames && ok; ++i)
+	{
+		const DWORD frameNumber = frameNumber_;
+		generateFrame(bodies);
+
+		const int size = OscSender::buildFrameBundle(packet, sizeof(packet), frameNumber, numInstruments_, violinLabels, bowLabels, bodies);
+		if (size < 0)
+		{
+			ok = false;
+			break;
+		}
+
+		// (see OscReceiver::capturePacket())
+		unsigned int header[2];
+		header[0] = (unsigned int)size;
+		header[1] = (unsigned int)(frameNumber*1000000.0/sampleRate_);
+		ok = (fwrite(header, sizeof(header), 1, file) == 1 && fwrite(packet, 1, size, file) == (size_t)size);
+	}
+
+	fclose(file);
+	return ok;
+}
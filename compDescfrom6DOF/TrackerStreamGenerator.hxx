@@ -0,0 +1,91 @@
+#ifndef INCLUDED_TRACKERSTREAMGENERATOR_HXX
+#define INCLUDED_TRACKERSTREAMGENERATOR_HXX
+
+#include <string>
+#include <vector>
+
+#include "TrackerSample.hxx"
+#include "SimpleMatrix.hxx"
+
+class TrackerCalibration;
+
+// Synthesizes tracker data (violin body and bow rigid bodies) for an ensemble of
+// instruments, for scalability testing without a tracker (or with more instruments
+// and/or a higher frame rate than the tracker provides).
+//
+// Trajectories are made physically plausible using the string and bow geometry of a
+// calibration: the bow hair touches the played string at the (slowly varying) bow-bridge
+// distance, perpendicular to the string and inclined as the bridge arc requires, while
+// moving along the hair in smooth strokes of random length and duration. Strokes may
+// cross to an adjacent string (at the start of the stroke) or be played off the string
+// (bow lifted in the middle of the stroke). The violin itself sways slowly.
+//
+// Positions are in cm and euler angles in degrees (same as the 6DOF messages after
+// conversion, see compDescfrom6DOF_6DOF()). Output is deterministic for a given seed.
+class TrackerStreamGenerator
+{
+public:
+	enum { MAX_NUM_INSTRUMENTS = 16 };
+
+	TrackerStreamGenerator();
+
+	// Instrument i uses the geometry of calibration violin i % numCalibratedViolins.
+	void init(int numInstruments, double sampleRate, const TrackerCalibration &calibration, int numCalibratedViolins, unsigned int seed = 1);
+
+	int getNumInstruments() const { return numInstruments_; }
+	double getSampleRate() const { return sampleRate_; }
+	DWORD getFrameNumber() const { return frameNumber_; }
+
+	// Generates the next frame (2*getNumInstruments() interleaved bodies, see TrackerSample).
+	void generateFrame(TrackerSample *bodies);
+
+	// Generates numFrames frames as QTM-like OSC bundles to a capture file (same format as
+	// OscReceiver::startPacketCapture(), so it can be replayed with OscSender).
+	bool writeOscCapture(const char *filename, int numFrames, const std::vector<std::string> &violinLabels, const std::vector<std::string> &bowLabels);
+
+private:
+	struct Instrument
+	{
+		// Geometry (violin body sensor frame):
+		Matrix3x1 bridge[4];
+		Matrix3x1 fingerboard[4];
+		Matrix3x1 archUp; // (points away from the top plate)
+
+		// Geometry (bow sensor frame):
+		Matrix3x1 frog;
+		Matrix3x1 hairDir; // frog to tip (normalized)
+		Matrix3x1 ribbonDir; // across the hair ribbon (normalized, perpendicular to hairDir)
+		double hairLength;
+
+		// Violin pose:
+		Matrix3x1 basePos;
+		Matrix3x1 baseOrientation; // radians
+		double swayFreq;
+		double swayPhase;
+
+		// Current stroke:
+		double strokeStartTime;
+		double strokeDuration;
+		double strokeStartDisplacement, strokeEndDisplacement;
+		double strokeStartString, strokeEndString; // 0-based, fractional during crossings
+		double strokeStartBowBridgeDist, strokeEndBowBridgeDist;
+		bool isStrokeLifted;
+
+		unsigned int rngState;
+	};
+
+	void startNewStroke(Instrument &instrument, double time);
+	void computePose(Instrument &instrument, double time, TrackerSample &violin, TrackerSample &bow);
+
+	static double random(Instrument &instrument, double min, double max);
+	static Matrix3x1 stringPoint(const Matrix3x1 *points, double string);
+	static Matrix3x1 bridgeTangent(const Instrument &instrument, int string);
+	static Matrix3x1 toEulerDegrees(const Matrix3x3 &rot);
+
+	int numInstruments_;
+	double sampleRate_;
+	DWORD frameNumber_;
+	Instrument instruments_[MAX_NUM_INSTRUMENTS];
+};
+
+#endif
@@ -2,29 +2,56 @@
 
 #include <vector>
 #include <string>
+#include <new> // std::bad_alloc (see COUNT_ALLOCATIONS)
+#include <crtdbg.h> // _CrtSetAllocHook()
 #include "ext.h" // Required for all Max external objects
 #include "ext_obex.h"						// required for new style Max object
 #include "z_dsp.h"
+#include "buffer.h"
+#include "ext_atomic.h"
 #include "ComputeDescriptors.hxx"
 #include "AtomicEnum.hxx"
 #include "AtomicFlag.hxx" 
 //#include "juce.h"
 //#include "ViolinRecordingPlugInEditor.hxx"
 #include "utils.h"
-#include "FilterFir.hxx"
-#include "Derivative2.hxx"
+#include "FusedDerivativeSmoother.hxx"
+#include "KinematicKalmanFilter.hxx"
+#include "EstimatorComparison.hxx"
+#include "PolyphaseResampler.hxx"
+#include "DescriptorSignalUpsampler.hxx"
+#include "DescriptorRing.hxx"
 #include "BPF.h"
 
 #include "AsynchFileWriter.hxx"
+#include "AsynchFileWriterService.hxx"
+#include "ChunkCrcFile.hxx"
+#include "CalibrationCache.hxx"
 #include "FileWriters.hxx"
 
 #include "CBuffer.h"
+#include "OscReceiver.hxx"
+#include "SixDofCapture.hxx"
+#include "TrackerStreamGenerator.hxx"
 
 #define ASSIST_OUTLET (2)
 #define N_DESC 7
 #define FORCE_BUFF 7
 #define FORCE_BUFF_DELAY 0
 #define INC_FORCE_SIZE 8
+#define FORCE_CORRECTION_BATCH 16 // bow forces corrected per BPF::get() call
+#define REPLAY_MAX_SPEED_CHUNK 1024 // max. messages dispatched per scheduler pass when replaying as fast as possible
+#define BENCHMARK_MAX_SECONDS 60
+#define ROTATION_CHECK_MAX_SENSORS 65536
+#define ESTIMATOR_MEASUREMENT_NOISE 0.0004 // variance (cm^2) of bow displacement noise assumed by the Kalman estimator (0.2 mm std)
+#define ESTIMATOR_DEFAULT_BANDWIDTH 20 // Hz
+#define ESTIMATOR_COMPARISON_MAX_LAG 30 // frames
+#define RESAMPLER_MAX_OUTPUT_FRAMES 8 // per tracker frame (limits upsampling)
+#define RESAMPLER_HOLD_FRAMES 16 // integer descriptor history (> resampler latency, see outputResampledDescriptors())
+#define SIGNAL_FIFO_SECONDS 1 // capacity of the descriptor signal FIFO
+#define PRE_ROLL_MAX_SECONDS 30 // history kept for retroactive recording starts (see compDescfrom6DOF_preRoll())
+#define PRE_ROLL_MAX_SKEW_SECONDS 0.5 // larger differences of the audio and tracker history are reported
+#define TASK_DERIVED3D_FIELDS (Derived3dData::WOOD | Derived3dData::DESCRIPTOR_INPUTS) // the task outputs the descriptors and the transformed betas
 //#define MAX_NUM_VIOLINS 4
 enum TrackerState
 {
@@ -34,6 +61,18 @@ enum TrackerState
 };
 AtomicEnum<TrackerState> trackerState_;
 
+enum ScheduleMode
+{
+	SCHEDULE_PERIODIC,			// poll the circular buffer every clock_compDesc_Delay ms (initial mode)
+	SCHEDULE_ON_FRAME			// process as soon as a complete frame has been assembled
+};
+
+enum EstimatorMode
+{
+	ESTIMATOR_FIR,				// derivatives followed by linear phase smoothing (3 and 10 frames delay, initial mode)
+	ESTIMATOR_KALMAN			// constant acceleration Kalman filter (low delay, see KinematicKalmanFilter)
+};
+
 static char *pDescNames[N_DESC]=
 {
 	"string", "position", "bbd", "vel", "acc", "force", "tilt"
@@ -46,21 +85,114 @@ static char *pDescNames[N_DESC]=
 ComputeViolinPeformanceDescriptors computeDescriptors_;
 class AsynchFileWriter *audioCh1Writer_;
 class AsynchFileWriter *trackerWriter_;
+AsynchFileWriterService writerService_; // consumes audioCh1Writer_ and trackerWriter_ (see prepareRecordingWriters())
+int trackerWriterNumViolins_=0; // trackerWriter_ file writer configuration (see prepareRecordingWriters())
+float writersIntervalMilliseconds_=0; // writer buffer configuration (see prepareRecordingWriters())
+volatile bool isHistoryEnabled_=false; // writers are fed while connected, not only while recording (see compDescfrom6DOF_preRoll())
+int numInstances_=0; // the writer service is shared, it's stopped when the last instance is freed
+const int audioRecordingSampleRate=44100;
 const int numItemsPerFrameQualisys = 12;	
 const int trackerCalibDataSize=48;
+const int numBufferSinkStreams=N_DESC+trackerCalibDataSize; // descriptors, then transformed betas
+t_symbol *ps_buffer;
 int trackerSampleRate=240;
 
 BPF incForce, sensitForce;
+float bowSmoother5_[5], bowSmoother9_[9]; // Gaussian kernels of initBowDerivatives() (filled in by the first instance, then read only)
 ComputeSensorVelocityAndAcceleration sens2VelAndAccel_;
 RawSensorData rawSensorData;
 
 int numViolins_ =1;
-LibertyTracker::ItemData violinData[MAX_NUM_VIOLINS];
-LibertyTracker::ItemData bowData[MAX_NUM_VIOLINS];
+TrackerSample frameData[2*MAX_NUM_VIOLINS];	// frame being assembled (2*numViolins_ interleaved bodies, see TrackerSample)
 int frameCount=0;
+unsigned int receivedBodiesMask_=0;	// bit b: frameData[b] received
+bool isFrameCommitted_=false;		// frame being assembled already written to circular buffer
 
 void *compDescfrom6DOF_class; // Required. Global pointing to this class
-TrackerCalibration trackerCalibration_;
+TrackerCalibration trackerCalibration_; // (copy of the calibration started last, see compDescfrom6DOF_start())
+CalibrationCache calibrationCache_; // parsed calibration files, shared by the instances
+
+// Allocations of a thread counting them (see ScopedAllocationCount, the receiver and writer 
+// threads allocate meanwhile, those aren't counted). A build with COUNT_ALLOCATIONS 
+// (release too) counts operator new of this module, a debug build otherwise uses the 
+// allocation hook of the debug CRT (malloc() too).
+#if defined(COUNT_ALLOCATIONS) || defined(_DEBUG)
+#define IS_COUNTING_ALLOCATIONS
+#endif
+
+#ifdef IS_COUNTING_ALLOCATIONS
+volatile LONG numAllocations_=0; // (only incremented by the counting thread)
+volatile DWORD countingThreadId_=0; // (0: not counting)
+
+void countAllocation()
+{
+	if (countingThreadId_!=0 && ::GetCurrentThreadId()==countingThreadId_)
+		numAllocations_++;
+}
+
+#if defined(COUNT_ALLOCATIONS)
+void *operator new(size_t size)
+{
+	countAllocation();
+	void *p=::malloc(size>0 ? size : 1);
+	if (p==NULL)
+		throw std::bad_alloc();
+	return p;
+}
+void *operator new[](size_t size) { return operator new(size); }
+void operator delete(void *p) { ::free(p); }
+void operator delete[](void *p) { ::free(p); }
+#else
+int countAllocationsHook(int allocType, void *userData, size_t size, int blockType, long requestNumber, const unsigned char *filename, int lineNumber)
+{
+	if (allocType==_HOOK_ALLOC || allocType==_HOOK_REALLOC)
+		countAllocation();
+	return TRUE;
+}
+#endif
+
+// Counts the allocations of the calling thread while in scope (may be nested).
+class ScopedAllocationCount
+{
+public:
+	ScopedAllocationCount()
+	{
+		previousThreadId_=countingThreadId_;
+		numAllocationsBefore_=numAllocations_;
+#if !defined(COUNT_ALLOCATIONS)
+		previousHook_=_CrtSetAllocHook(countAllocationsHook);
+#endif
+		countingThreadId_=::GetCurrentThreadId();
+	}
+	~ScopedAllocationCount()
+	{
+		countingThreadId_=previousThreadId_;
+#if !defined(COUNT_ALLOCATIONS)
+		_CrtSetAllocHook(previousHook_);
+#endif
+	}
+	long getCount() const { return (long)(numAllocations_-numAllocationsBefore_); }
+
+private:
+	DWORD previousThreadId_;
+	LONG numAllocationsBefore_;
+#if !defined(COUNT_ALLOCATIONS)
+	_CRT_ALLOC_HOOK previousHook_;
+#endif
+};
+#endif
+
+// Resamplers of an outputRate change, swapped in by the task (see applyPendingOutputChanges()):
+struct DescResamplerChange
+{
+	PolyphaseResampler *resamplers[MAX_NUM_VIOLINS]; // (NULL if not resampling)
+};
+
+// Shared memory ring of a publish change, swapped in by the task (see applyPendingOutputChanges()):
+struct RingWriterChange
+{
+	DescriptorRingWriter *writer; // (NULL if not publishing)
+};
 
 typedef struct _compDescfrom6DOF // Data structure for this object
 {
@@ -69,12 +201,33 @@ typedef struct _compDescfrom6DOF // Data structure for this object
 	Atom desc[N_DESC];
 	void *m_clock_compDesc;  // add a clock
 	float clock_compDesc_Delay;
-	void *m_clock_write;  // add a clock
-	float clock_write_Delay;
+	long scheduleMode; // ScheduleMode
+	int batchBound; // max. frames processed per task call in SCHEDULE_ON_FRAME mode (adaptive)
+	int maxBatchBound;
+	float clock_write_Delay; // writer service interval (ms)
+	float preRollSeconds; // recorded from before startRecording (0: off)
+	long chunkCrcKBytes; // per-chunk CRC records of the take files (0: off, see compDescfrom6DOF_chunkCrc())
 	bool verbose;
-	Derivative2 compBowVel_, compBowAccel_, compBowSensorVel_, compBowSensorAccel_;
-	FilterFir bowVelSmoother_, bowAccelSmoother1_, bowAccelSmoother2_, bowAccelSmoother3_;
-	FilterFir bowSensorVelSmoother_, bowSensorAccelSmoother1_, bowSensorAccelSmoother2_, bowSensorAccelSmoother3_;
+	FusedDerivativeSmoother<> bowDerivatives_; // smoothed bow velocity and acceleration
+	long estimatorMode; // EstimatorMode
+	double estimatorBandwidth; // Hz (ESTIMATOR_KALMAN)
+	KinematicKalmanFilter bowKalman_[MAX_NUM_VIOLINS];
+	double outputRate; // Hz, descriptors are resampled to it (0: output every tracker frame)
+	PolyphaseResampler *descResampler[MAX_NUM_VIOLINS]; // (NULL if not resampling, only replaced by the task)
+	PVOID volatile pendingDescResamplers; // DescResamplerChange for the task (NULL if none, see compDescfrom6DOF_outputRate())
+	long heldDesc[MAX_NUM_VIOLINS][RESAMPLER_HOLD_FRAMES][N_DESC]; // integer descriptors of the last frames (ring, see outputResampledDescriptors())
+	int heldDescPos[MAX_NUM_VIOLINS];
+	int numHeldDescFrames[MAX_NUM_VIOLINS]; // (up to RESAMPLER_HOLD_FRAMES)
+	DescriptorSignalUpsampler *signalUpsampler; // descriptor signal outlets (NULL if none)
+	unsigned int derived3dFields; // Derived3dData fields computed by the task (see compDescfrom6DOF_fields())
+	bool isBufferSinkEnabled; // frames are written to buffer~s instead of output as lists
+	t_symbol *bufferSinkNames[numBufferSinkStreams];
+	t_buffer *bufferSinkBuffers[numBufferSinkStreams]; // bound during a task call (NULL if missing)
+	unsigned long bufferSinkFrameCount; // frames written since bufferSink
+	void *bufferSinkPos_out; // (NULL if not created)
+	DescriptorRingWriter *ringWriter; // shared memory publishing (NULL if not publishing, only replaced by the task)
+	PVOID volatile pendingRingWriter; // RingWriterChange for the task (NULL if none, see compDescfrom6DOF_publish())
+	const CalibrationCacheEntry *calibration; // (from calibrationCache_, NULL before start)
 	//bool running;
 	CBuffer *circularBuffer;
 	bool waitingforBow;
@@ -83,6 +236,19 @@ typedef struct _compDescfrom6DOF // Data structure for this object
 	char scoreName[MAX_PATH];
 	char calibFileName[MAX_PATH];
 	long ntake;
+	OscReceiver *oscReceiver; // native QTM OSC receiver (NULL if not used)
+	long oscPort; // UDP port for oscReceiver (0: use 6DOF messages)
+	OscSender *oscSender; // for replaying captured packets to oscReceiver
+	SixDofCaptureWriter *captureWriter; // (NULL if not capturing)
+	SixDofCaptureReader *replayReader;
+	void *m_clock_replay;
+	double replaySpeed; // <= 0: as fast as possible
+	int replayIdx;
+	double replayStartTimeMs;
+	bool isReplaying;
+	unsigned long numFramesWritten; // (to circular buffer)
+	unsigned long numFramesOverrun;
+	unsigned long numFramesProcessed;
 	void *descInst_out[MAX_NUM_VIOLINS];//desc_out[N_DESC]; 
 	void *transformedBetas_out[MAX_NUM_VIOLINS];
 } t_compDescfrom6DOF;
@@ -90,26 +256,89 @@ typedef struct _compDescfrom6DOF // Data structure for this object
 
 
 // Prototypes for methods: need a method for each incoming message
-void *compDescfrom6DOF_new(void); // object creation method
+void *compDescfrom6DOF_new(long numSignalViolins, long hasBufferSinkOutlet); // object creation method
+void compDescfrom6DOF_free(t_compDescfrom6DOF *compDescfrom6DOF);
 void compDescfrom6DOF_start(t_compDescfrom6DOF *compDescfrom6DOF); // method for start message
 void compDescfrom6DOF_stop(t_compDescfrom6DOF *compDescfrom6DOF); // method for start message
 void compDescfrom6DOF_startRecording(t_compDescfrom6DOF *compDescfrom6DOF); // method for start message
 void compDescfrom6DOF_stopRecording(t_compDescfrom6DOF *compDescfrom6DOF); // method for start message
 void compDescfrom6DOF_sampleRate(t_compDescfrom6DOF *compDescfrom6DOF, double sr); 
+void compDescfrom6DOF_schedule(t_compDescfrom6DOF *compDescfrom6DOF, long mode);
+void compDescfrom6DOF_maxBatch(t_compDescfrom6DOF *compDescfrom6DOF, long maxFrames);
 void compDescfrom6DOF_task(t_compDescfrom6DOF *compDescfrom6DOF); //method for the scheduled task
 void compDescfrom6DOF_assist(t_compDescfrom6DOF *compDescfrom6DOFr, Object *b, long msg, long arg, char *s);
-void initSmoothingFilter(FilterFir &filter, int size);
+void computeSmoothingCoeffs(float *coeffs, int size);
+// Gaussian smoothers of 5 (velocity), 5, 5 and 9 taps (acceleration):
+template<unsigned int NUM_CHANNELS>
+void initBowDerivatives(FusedDerivativeSmoother<NUM_CHANNELS> &derivatives)
+{
+	derivatives.init(bowSmoother5_, bowSmoother5_, bowSmoother5_, bowSmoother9_);
+}
+void initBowKalman(t_compDescfrom6DOF *compDescfrom6DOF);
+void correctBowForce(const double *bowForce, const double *bowDisplacement, float *forceCorrected, int n);
+void processBowKalman(KinematicKalmanFilter &filter, bool isBowOnString, double bowDisplacement, double dt, float &bowVel, float &bowAccel);
+void commitFrameToCircularBuffer(t_compDescfrom6DOF *compDescfrom6DOF);
+void writeFrameToCircularBuffer(t_compDescfrom6DOF *compDescfrom6DOF, const TrackerSample *bodies);
+int computeBatchSize(t_compDescfrom6DOF *compDescfrom6DOF, int numAvailFrames);
 void compDescfrom6DOF_6DOF(t_compDescfrom6DOF *compDescfrom6DOF, Symbol *s, short argc, t_atom *argv);
 void compDescfrom6DOF_setScoreName(t_compDescfrom6DOF *compDescfrom6DOF, Symbol *s);
 void compDescfrom6DOF_setDir(t_compDescfrom6DOF *compDescfrom6DOF, Symbol *s);
 void compDescfrom6DOF_setTake(t_compDescfrom6DOF *compDescfrom6DOF, long ntake);
 t_int *compDescfrom6DOF_perform(t_int *w);
 void compDescfrom6DOF_dsp(t_compDescfrom6DOF *compDescfrom6DOF, t_signal **sp, short *count);
-void compDescfrom6DOF_AsynchWrite(t_compDescfrom6DOF *compDescfrom6DOF);
+void compDescfrom6DOF_ioStats(t_compDescfrom6DOF *compDescfrom6DOF);
+void compDescfrom6DOF_ioStatsReset(t_compDescfrom6DOF *compDescfrom6DOF);
+void compDescfrom6DOF_adaptiveDrain(t_compDescfrom6DOF *compDescfrom6DOF, long isAdaptive);
+void compDescfrom6DOF_chunkCrc(t_compDescfrom6DOF *compDescfrom6DOF, long kBytes);
+void compDescfrom6DOF_verifyArchive(t_compDescfrom6DOF *compDescfrom6DOF, Symbol *s);
 void compDescfrom6DOF_setCalibFileName(t_compDescfrom6DOF *compDescfrom6DOF, Symbol *s);
-
-
-void sendTrackerDataToHistoryBuffer(LibertyTracker::ItemDataIterator iter, int numTrackerFrames, int numTrackerSensors); 
+void compDescfrom6DOF_oscReceive(t_compDescfrom6DOF *compDescfrom6DOF, long port);
+void compDescfrom6DOF_oscCapture(t_compDescfrom6DOF *compDescfrom6DOF, Symbol *s);
+void compDescfrom6DOF_oscReplay(t_compDescfrom6DOF *compDescfrom6DOF, Symbol *s, double speed);
+void compDescfrom6DOF_oscStats(t_compDescfrom6DOF *compDescfrom6DOF);
+bool startOscReceiver(t_compDescfrom6DOF *compDescfrom6DOF);
+void stopOscReceiver(t_compDescfrom6DOF *compDescfrom6DOF);
+void oscFrameCallback(void *context);
+void readOscReceiverFrames(t_compDescfrom6DOF *compDescfrom6DOF);
+void compDescfrom6DOF_capture(t_compDescfrom6DOF *compDescfrom6DOF, Symbol *s);
+void compDescfrom6DOF_replay(t_compDescfrom6DOF *compDescfrom6DOF, Symbol *s, double speed);
+void compDescfrom6DOF_replayStop(t_compDescfrom6DOF *compDescfrom6DOF);
+void compDescfrom6DOF_replayTask(t_compDescfrom6DOF *compDescfrom6DOF);
+void compDescfrom6DOF_benchmark(t_compDescfrom6DOF *compDescfrom6DOF, long numInstruments, long rate, double seconds);
+void compDescfrom6DOF_generateCapture(t_compDescfrom6DOF *compDescfrom6DOF, Symbol *s, long numInstruments, long rate, double seconds);
+void compDescfrom6DOF_estimator(t_compDescfrom6DOF *compDescfrom6DOF, long mode, double bandwidth);
+void compDescfrom6DOF_compareEstimators(t_compDescfrom6DOF *compDescfrom6DOF, Symbol *s);
+void compDescfrom6DOF_outputRate(t_compDescfrom6DOF *compDescfrom6DOF, double rate);
+void outputResampledDescriptors(t_compDescfrom6DOF *compDescfrom6DOF, int iViolin);
+void applyPendingOutputChanges(t_compDescfrom6DOF *compDescfrom6DOF);
+void deleteDescResamplerChange(DescResamplerChange *change);
+void deleteRingWriterChange(RingWriterChange *change);
+void compDescfrom6DOF_signalLatency(t_compDescfrom6DOF *compDescfrom6DOF, double ms);
+void compDescfrom6DOF_signalStats(t_compDescfrom6DOF *compDescfrom6DOF);
+void compDescfrom6DOF_bufferSink(t_compDescfrom6DOF *compDescfrom6DOF, Symbol *s);
+int bindBufferSink(t_compDescfrom6DOF *compDescfrom6DOF);
+void releaseBufferSink(t_compDescfrom6DOF *compDescfrom6DOF);
+void writeFrameToBufferSink(t_compDescfrom6DOF *compDescfrom6DOF, int iViolin, const float *betas);
+void getTransformedBetas(const Derived3dData &derived3dData, float *betas);
+void compDescfrom6DOF_publish(t_compDescfrom6DOF *compDescfrom6DOF, Symbol *s, long capacity);
+void compDescfrom6DOF_publishBenchmark(t_compDescfrom6DOF *compDescfrom6DOF, long numRecords, double rate);
+void publishFrameToRing(t_compDescfrom6DOF *compDescfrom6DOF, int iViolin, DWORD frameNumber, int playedString, const ViolinPerformanceDescriptors &descriptors, const float *betas);
+void compDescfrom6DOF_contactGate(t_compDescfrom6DOF *compDescfrom6DOF, double distanceCm);
+void compDescfrom6DOF_fields(t_compDescfrom6DOF *compDescfrom6DOF, long fields);
+void compDescfrom6DOF_comparePrecision(t_compDescfrom6DOF *compDescfrom6DOF, long numInstruments, double seconds);
+int getReferenceString(const Derived3dData &derived3dData);
+int captureToFrames(const SixDofCaptureReader &reader, TrackerCalibration &calibration, std::vector<TrackerSample> &frames);
+int getCircularBufferSize(t_compDescfrom6DOF *compDescfrom6DOF, int numViolins);
+void prepareRecordingWriters(t_compDescfrom6DOF *compDescfrom6DOF);
+void finishRecordingWriters();
+void compDescfrom6DOF_preRoll(t_compDescfrom6DOF *compDescfrom6DOF, double seconds);
+void startHistory(t_compDescfrom6DOF *compDescfrom6DOF);
+void compDescfrom6DOF_allocationCheck(t_compDescfrom6DOF *compDescfrom6DOF, long numCycles);
+void compDescfrom6DOF_rotationCheck(t_compDescfrom6DOF *compDescfrom6DOF, long numSensors);
+double maxAbsDifference(const Matrix3x3 &a, const Matrix3x3 &b);
+
+
+void sendTrackerDataToHistoryBuffer(TrackerSampleIterator iter, int numTrackerFrames, int numTrackerSensors); 
 void sendTrackerDataToHistoryBufferSingleFrame(const RawSensorData &frame);
 bool writeHeaderFile(const char *filename,	const double str1Br[3], const double str2Br[3], const double str3Br[3], const double str4Br[3], 
 														const double str1Wd[3], const double str2Wd[3], const double str3Wd[3], const double str4Wd[3], 
@@ -118,10 +347,13 @@ bool writeHeaderFile(const char *filename,	const double str1Br[3], const double
 int main(void)
 {
 	// set up our class: create a class definition
-	setup((t_messlist**) &compDescfrom6DOF_class, (method)compDescfrom6DOF_new, (method)dsp_free, (short)sizeof(t_compDescfrom6DOF), 0L, 0);
+	setup((t_messlist**) &compDescfrom6DOF_class, (method)compDescfrom6DOF_new, (method)compDescfrom6DOF_free, (short)sizeof(t_compDescfrom6DOF), 0L, A_DEFLONG, A_DEFLONG, 0);
 	addmess((method)compDescfrom6DOF_dsp, "dsp", A_CANT, 0);
 	dsp_initclass();
-	addmess((method)compDescfrom6DOF_sampleRate, "sampleRate", A_FLOAT, 0); 
+	addmess((method)compDescfrom6DOF_sampleRate, "sampleRate", A_FLOAT, 0); // (kept for old patches, same as taskInterval)
+	addmess((method)compDescfrom6DOF_sampleRate, "taskInterval", A_FLOAT, 0); 
+	addmess((method)compDescfrom6DOF_schedule, "schedule", A_LONG, 0);
+	addmess((method)compDescfrom6DOF_maxBatch, "maxBatch", A_LONG, 0);
 	addmess((method)compDescfrom6DOF_start, "start", 0);
 	addmess((method)compDescfrom6DOF_stop, "stop", 0);
 	addmess((method)compDescfrom6DOF_startRecording, "startRec", 0);
@@ -132,17 +364,56 @@ int main(void)
 	addmess((method)compDescfrom6DOF_setDir, "dirBase", A_SYM, A_NOTHING);
 	addmess((method)compDescfrom6DOF_setTake, "take", A_LONG, 0);
 	addmess((method)compDescfrom6DOF_setCalibFileName, "calibFile", A_SYM, A_NOTHING);
+	addmess((method)compDescfrom6DOF_oscReceive, "oscReceive", A_LONG, 0);
+	addmess((method)compDescfrom6DOF_oscCapture, "oscCapture", A_DEFSYM, 0);
+	addmess((method)compDescfrom6DOF_oscReplay, "oscReplay", A_SYM, A_DEFFLOAT, 0);
+	addmess((method)compDescfrom6DOF_oscStats, "oscStats", 0);
+	addmess((method)compDescfrom6DOF_ioStats, "ioStats", 0);
+	addmess((method)compDescfrom6DOF_ioStatsReset, "ioStatsReset", 0);
+	addmess((method)compDescfrom6DOF_adaptiveDrain, "adaptiveDrain", A_LONG, 0);
+	addmess((method)compDescfrom6DOF_chunkCrc, "chunkCrc", A_LONG, 0);
+	addmess((method)compDescfrom6DOF_verifyArchive, "verifyArchive", A_DEFSYM, 0);
+	addmess((method)compDescfrom6DOF_capture, "capture", A_DEFSYM, 0);
+	addmess((method)compDescfrom6DOF_replay, "replay", A_SYM, A_FLOAT, 0);
+	addmess((method)compDescfrom6DOF_replayStop, "replayStop", 0);
+	addmess((method)compDescfrom6DOF_benchmark, "benchmark", A_LONG, A_LONG, A_FLOAT, 0);
+	addmess((method)compDescfrom6DOF_generateCapture, "generateCapture", A_SYM, A_LONG, A_LONG, A_FLOAT, 0);
+	addmess((method)compDescfrom6DOF_estimator, "estimator", A_LONG, A_DEFFLOAT, 0);
+	addmess((method)compDescfrom6DOF_compareEstimators, "compareEstimators", A_SYM, 0);
+	addmess((method)compDescfrom6DOF_outputRate, "outputRate", A_FLOAT, 0);
+	addmess((method)compDescfrom6DOF_signalLatency, "signalLatency", A_FLOAT, 0);
+	addmess((method)compDescfrom6DOF_signalStats, "signalStats", 0);
+	addmess((method)compDescfrom6DOF_bufferSink, "bufferSink", A_DEFSYM, 0);
+	ps_buffer = gensym("buffer~");
+	addmess((method)compDescfrom6DOF_publish, "publish", A_DEFSYM, A_DEFLONG, 0);
+	addmess((method)compDescfrom6DOF_publishBenchmark, "publishBenchmark", A_LONG, A_DEFFLOAT, 0);
+	addmess((method)compDescfrom6DOF_contactGate, "contactGate", A_FLOAT, 0);
+	addmess((method)compDescfrom6DOF_fields, "fields", A_LONG, 0);
+	addmess((method)compDescfrom6DOF_comparePrecision, "comparePrecision", A_LONG, A_FLOAT, 0);
+	addmess((method)compDescfrom6DOF_allocationCheck, "allocationCheck", A_LONG, 0);
+	addmess((method)compDescfrom6DOF_rotationCheck, "rotationCheck", A_LONG, 0);
+	addmess((method)compDescfrom6DOF_preRoll, "preRoll", A_FLOAT, 0);
 		 
 	//class_register(compDescfrom6DOF_class, CLASS_BOX);
 }
 
-void *compDescfrom6DOF_new(void)
+// Arguments: 
+// - number of instruments (from the first) with descriptor signal outlets (see 
+//   DescriptorSignalUpsampler), 0 (default) for none
+// - 1 for a buffer~ sink write position outlet (see compDescfrom6DOF_bufferSink()), 0 
+//   (default) for none
+void *compDescfrom6DOF_new(long numSignalViolins, long hasBufferSinkOutlet)
 {
 	t_compDescfrom6DOF *compDescfrom6DOF;
 	// create the new instance and return a pointer to it
 	compDescfrom6DOF = (t_compDescfrom6DOF *)newobject(compDescfrom6DOF_class);
 	dsp_setup((t_pxobject *)compDescfrom6DOF, 1); // left? inlet
 	outlet_new((t_pxobject *)compDescfrom6DOF, "signal"); // signal outlet
+	// Descriptor signal outlets, left of the above (outlets are created right to left):
+	numSignalViolins=MIN(MAX(numSignalViolins, 0), MAX_NUM_VIOLINS);
+	for (int i=(int)numSignalViolins*DescriptorSignalFrame::NUM_SIGNALS-1;i>=0;i--)
+		outlet_new((t_pxobject *)compDescfrom6DOF, "signal");
+	compDescfrom6DOF->bufferSinkPos_out=(hasBufferSinkOutlet!=0) ? intout(compDescfrom6DOF) : NULL;
 	for (int i=MAX_NUM_VIOLINS-1;i>=0;i--)
 		compDescfrom6DOF->transformedBetas_out[i]=listout(compDescfrom6DOF);
 	//compDescfrom6DOF->descInst4_out=listout(compDescfrom6DOF);
@@ -151,24 +422,72 @@ void *compDescfrom6DOF_new(void)
 	
 
 
+	numInstances_++;
 	compDescfrom6DOF->m_clock_compDesc = clock_new((t_object *)compDescfrom6DOF, (method)compDescfrom6DOF_task); //create the clock	
 	compDescfrom6DOF->clock_compDesc_Delay=100;
-	compDescfrom6DOF->m_clock_write = clock_new((t_object *)compDescfrom6DOF, (method)compDescfrom6DOF_AsynchWrite); //create the clock	
+	compDescfrom6DOF->scheduleMode=SCHEDULE_PERIODIC;
+	compDescfrom6DOF->batchBound=1;
+	compDescfrom6DOF->maxBatchBound=24; // = frames per violin of a 100 ms periodic task at 240 Hz
 	compDescfrom6DOF->clock_write_Delay=100;
+	compDescfrom6DOF->preRollSeconds=0;
+	compDescfrom6DOF->chunkCrcKBytes=0;
 	compDescfrom6DOF->verbose=true;
 	//compDescfrom6DOF->running=false;
 	trackerState_=TRACKER_DISCONNECTED;
 	compDescfrom6DOF->waitingforBow=false;
-
-	initSmoothingFilter(compDescfrom6DOF->bowVelSmoother_, 5);
-	initSmoothingFilter(compDescfrom6DOF->bowAccelSmoother1_, 5);
-	initSmoothingFilter(compDescfrom6DOF->bowAccelSmoother2_, 5);
-	initSmoothingFilter(compDescfrom6DOF->bowAccelSmoother3_, 9); // XXX: was 10 in Esteban code, but needs to be odd for symmetric filter
-
-	initSmoothingFilter(compDescfrom6DOF->bowSensorVelSmoother_, 5);
-	initSmoothingFilter(compDescfrom6DOF->bowSensorAccelSmoother1_, 5);
-	initSmoothingFilter(compDescfrom6DOF->bowSensorAccelSmoother2_, 5);
-	initSmoothingFilter(compDescfrom6DOF->bowSensorAccelSmoother3_, 9); // XXX: was 10 in Esteban code, but needs to be odd for symmetric filter
+	compDescfrom6DOF->oscReceiver=NULL;
+	compDescfrom6DOF->oscPort=0;
+	compDescfrom6DOF->oscSender=NULL;
+	compDescfrom6DOF->captureWriter=NULL;
+	compDescfrom6DOF->replayReader=NULL;
+	compDescfrom6DOF->m_clock_replay = clock_new((t_object *)compDescfrom6DOF, (method)compDescfrom6DOF_replayTask); //create the clock	
+	compDescfrom6DOF->replaySpeed=1;
+	compDescfrom6DOF->replayIdx=0;
+	compDescfrom6DOF->replayStartTimeMs=0;
+	compDescfrom6DOF->isReplaying=false;
+	compDescfrom6DOF->numFramesWritten=0;
+	compDescfrom6DOF->numFramesOverrun=0;
+	compDescfrom6DOF->numFramesProcessed=0;
+	compDescfrom6DOF->derived3dFields=TASK_DERIVED3D_FIELDS;
+
+	// (shared by all instances: only computed by the first one, then read only)
+	if (bowSmoother5_[0]==0)
+	{
+		computeSmoothingCoeffs(bowSmoother5_, 5);
+		computeSmoothingCoeffs(bowSmoother9_, 9); // XXX: 9 was 10 in Esteban code, but needs to be odd for symmetric filter
+	}
+	compDescfrom6DOF->calibration=NULL;
+	initBowDerivatives(compDescfrom6DOF->bowDerivatives_);
+	compDescfrom6DOF->estimatorMode=ESTIMATOR_FIR;
+	compDescfrom6DOF->estimatorBandwidth=ESTIMATOR_DEFAULT_BANDWIDTH;
+	initBowKalman(compDescfrom6DOF);
+	compDescfrom6DOF->outputRate=0;
+	compDescfrom6DOF->pendingDescResamplers=NULL;
+	for (int i=0;i<MAX_NUM_VIOLINS;i++)
+	{
+		compDescfrom6DOF->descResampler[i]=NULL;
+		compDescfrom6DOF->heldDescPos[i]=0;
+		compDescfrom6DOF->numHeldDescFrames[i]=0;
+	}
+	compDescfrom6DOF->signalUpsampler=NULL;
+	if (numSignalViolins>0)
+	{
+		compDescfrom6DOF->signalUpsampler=new DescriptorSignalUpsampler;
+		compDescfrom6DOF->signalUpsampler->init(numSignalViolins, trackerSampleRate, SIGNAL_FIFO_SECONDS*trackerSampleRate);
+	}
+	compDescfrom6DOF->isBufferSinkEnabled=false;
+	for (int i=0;i<numBufferSinkStreams;i++)
+	{
+		compDescfrom6DOF->bufferSinkNames[i]=NULL;
+		compDescfrom6DOF->bufferSinkBuffers[i]=NULL;
+	}
+	compDescfrom6DOF->bufferSinkFrameCount=0;
+	compDescfrom6DOF->ringWriter=NULL;
+	compDescfrom6DOF->pendingRingWriter=NULL;
+	// Runtime buffers, allocated once (start only reallocates the tracker FIFO if a longer 
+	// task interval needs more room, see compDescfrom6DOF_start()):
+	compDescfrom6DOF->circularBuffer=new CBuffer(getCircularBufferSize(compDescfrom6DOF, MAX_NUM_VIOLINS));
+	compDescfrom6DOF->transformedBetas=new Atom[trackerCalibDataSize];
 	
 	//to compensate force sensitivity
 	//int INC_FORCE_SIZE=8;
@@ -176,16 +495,20 @@ void *compDescfrom6DOF_new(void)
 	//to compensate force with position
 	float incForceMatrix[INC_FORCE_SIZE][2]= {{0, 0.47},{10,	+0.47},{20,	+0.5},{30,	+0.57},{40,	+0.65},{50,	+0.85},{60, +1.4},{67, +1.4}};
 		//{{0, 0.25},{5, -0.08},{10,	-0.45},{15,	-0.77},{20,	-1.0},{25,	-1.4},{30,	-1.77},{35,	-2.17},{40,	-2.59},{45,	-2.95},{50,	-3.4},{55,	-3.9},{60, -4.6},{65, -5.12}};
-	//BPF incForce
-	for (int i=0;i<INC_FORCE_SIZE;i++)
-		incForce.add(incForceMatrix[i][0], incForceMatrix[i][1]);
-	//BPF sensitForceMatrix
-	for (int i=0;i<INC_FORCE_SIZE;i++)
-		sensitForce.add(sensitForceMatrix[i][0], sensitForceMatrix[i][1]);
+	// (shared by all instances: only filled in by the first one, then read only)
+	if (incForce.size()==0)
+	{
+		//BPF incForce
+		for (int i=0;i<INC_FORCE_SIZE;i++)
+			incForce.add(incForceMatrix[i][0], incForceMatrix[i][1]);
+		incForce.compile();
+		//BPF sensitForceMatrix
+		for (int i=0;i<INC_FORCE_SIZE;i++)
+			sensitForce.add(sensitForceMatrix[i][0], sensitForceMatrix[i][1]);
+		sensitForce.compile();
+	}
 
 	
-	audioCh1Writer_ = NULL;
-	trackerWriter_ = NULL; 
 	compDescfrom6DOF->ntake=0;
 	strcpy(compDescfrom6DOF->baseDir,"");
 	strcpy(compDescfrom6DOF->scoreName,"");
@@ -205,6 +528,16 @@ void compDescfrom6DOF_assist(t_compDescfrom6DOF *compDescfrom6DOF, Object *b, lo
 	}
 	else if (arg>MAX_NUM_VIOLINS && arg<MAX_NUM_VIOLINS*2)
 		sprintf(s, "Instr%d: Transformed betas", (arg % MAX_NUM_VIOLINS)+1);
+	else if (msg == ASSIST_OUTLET && arg==MAX_NUM_VIOLINS*2 && compDescfrom6DOF->bufferSinkPos_out!=NULL)
+		sprintf(s, "buffer~ sink: frames written");
+	else if (msg == ASSIST_OUTLET && compDescfrom6DOF->signalUpsampler!=NULL)
+	{
+		static const char *signalNames[DescriptorSignalFrame::NUM_SIGNALS]={"vel", "force", "bbd", "position"};
+		const int iSignal=arg-MAX_NUM_VIOLINS*2-((compDescfrom6DOF->bufferSinkPos_out!=NULL) ? 1 : 0);
+		if (iSignal<0 || iSignal>=compDescfrom6DOF->signalUpsampler->getNumSignals())
+			return;
+		sprintf(s, "Instr%d: %s (signal)", iSignal/DescriptorSignalFrame::NUM_SIGNALS+1, signalNames[iSignal%DescriptorSignalFrame::NUM_SIGNALS]);
+	}
 }
 
 
@@ -234,20 +567,29 @@ void compDescfrom6DOF_startRecording(t_compDescfrom6DOF *compDescfrom6DOF)
 		char fname[MAX_PATH];
 		char take[4];
 
-		//Create async writers
-		int sampleRate=44100;
-		int maxSecondsPerBar=2;
-		float tolerance=5.0;
-		audioCh1Writer_ = new AsynchFileWriter(); //(t_object *)compDescfrom6DOF);
-		audioCh1Writer_->setFileWriter(WaveFileWriter(1, sampleRate));
-		audioCh1Writer_->allocate(compDescfrom6DOF->clock_write_Delay, sampleRate, tolerance, maxSecondsPerBar*sampleRate);
-		audioCh1Writer_->startConsumerThread();
- 
-		
-		trackerWriter_ = new AsynchFileWriter(); //(t_object *)compDescfrom6DOF);
-		trackerWriter_->setFileWriter(DatFileWriter(numItemsPerFrameQualisys*numViolins_, trackerSampleRate, 1));
-		trackerWriter_->allocate(compDescfrom6DOF->clock_write_Delay, numItemsPerFrameQualisys*numViolins_*trackerSampleRate, tolerance, numItemsPerFrameQualisys*maxSecondsPerBar*trackerSampleRate);
-		trackerWriter_->startConsumerThread();
+		//Create (first take) or reuse async writers, already fed with history when pre-rolling
+		if (isHistoryEnabled_)
+			finishRecordingWriters();
+		else
+			prepareRecordingWriters(compDescfrom6DOF);
+
+		// Pre-roll: the same time span for both streams, limited to what they've received 
+		// since the history started (unwrapped frame counts):
+		double preRoll=0.0;
+		if (isHistoryEnabled_)
+		{
+			const double audioSeconds=audioCh1Writer_->getUnwrappedWriteIdxFrames()/(double)audioRecordingSampleRate;
+			const double trackerSeconds=trackerWriter_->getUnwrappedWriteIdxFrames()/(double)trackerSampleRate;
+			if (trackerWriter_->getFrameSize()!=numItemsPerFrameQualisys*numViolins_)
+				post("[r]WARNING: tracker history frames don't match %d violins, no pre-roll", numViolins_);
+			else
+			{
+				// (both streams are fed from the same start, unless the audio is off)
+				if (audioSeconds>0 && fabs(audioSeconds-trackerSeconds)>PRE_ROLL_MAX_SKEW_SECONDS)
+					post("[r]WARNING: pre-roll history of audio (%.2f s) and tracker (%.2f s) differ", audioSeconds, trackerSeconds);
+				preRoll=MIN(compDescfrom6DOF->preRollSeconds, MIN(audioSeconds, trackerSeconds));
+			}
+		}
 
 
 		// Start audio recording:
@@ -259,7 +601,7 @@ void compDescfrom6DOF_startRecording(t_compDescfrom6DOF *compDescfrom6DOF)
 		strcat(fname, take);
 		strcat(fname, "-ch1.wav");
 		//char *audioCh1Filename = "testch1.wav";
-		audioCh1Writer_->postStartDiskWriteEvent((const char *)fname, 0);
+		audioCh1Writer_->postStartDiskWriteEvent((const char *)fname, (int)(preRoll*audioRecordingSampleRate));
 
 		// Start tracker recording:
 		strcpy(fname, compDescfrom6DOF->baseDir);	
@@ -270,7 +612,7 @@ void compDescfrom6DOF_startRecording(t_compDescfrom6DOF *compDescfrom6DOF)
 		strcat(fname, take);
 		strcat(fname, "-tracker.dat");
 		//char *trackerFilename = "testtracker.dat";
-		trackerWriter_->postStartDiskWriteEvent((const char *)fname, 0);
+		trackerWriter_->postStartDiskWriteEvent((const char *)fname, (int)(preRoll*trackerSampleRate));
 	// Write header file (raw binary):
 	// NOTE: This file is written synchronously (to reduce code size), but 
 	// it is only few data.
@@ -304,7 +646,6 @@ void compDescfrom6DOF_startRecording(t_compDescfrom6DOF *compDescfrom6DOF)
 			post("[r]ERROR: Failed writing recording header file!");
 		}
 		trackerState_ = TRACKER_RECORDING;
-		clock_fdelay(compDescfrom6DOF->m_clock_write, compDescfrom6DOF->clock_write_Delay);
 	}
 }
 
@@ -365,15 +706,101 @@ bool writeHeaderFile(const char *filename,	const double str1Br[3], const double
 		return true;
 }
 
-void compDescfrom6DOF_AsynchWrite(t_compDescfrom6DOF *compDescfrom6DOF)
-{	
-	if (audioCh1Writer_!=NULL)
+// Creates the writers for the first take, later takes reuse them and their buffers (see 
+// AsynchFileWriter::allocate()), only the tracker file writer is replaced when the number 
+// of violins changed. A previous take still being finished by the writer service (see 
+// compDescfrom6DOF_stopRecording()) is finished here first.
+// The buffers are sized for the longest pre-roll and MAX_NUM_VIOLINS whatever the current 
+// configuration (about 7 MB, mostly the audio history): the writers are shared by the 
+// instances, and a larger pre-roll or ensemble would otherwise free buffers that perform 
+// or the task may be writing into. They are only reallocated if the writer service 
+// interval changes.
+void prepareRecordingWriters(t_compDescfrom6DOF *compDescfrom6DOF)
+{
+	int sampleRate=audioRecordingSampleRate;
+	float maxSecondsPerBar=2+PRE_ROLL_MAX_SECONDS; // (+ history)
+	float tolerance=5.0;
+
+#ifdef IS_COUNTING_ALLOCATIONS
+	// (an unchanged configuration reuses all buffers, see compDescfrom6DOF_allocationCheck())
+	const bool isSameConfiguration=(audioCh1Writer_!=NULL && trackerWriterNumViolins_==numViolins_ && 
+		writersIntervalMilliseconds_==compDescfrom6DOF->clock_write_Delay && writerService_.isRunning());
+	ScopedAllocationCount allocationCount;
+#endif
+	AsynchFileWriterService::ScopedLock lock(writerService_); // (the writer thread doesn't drain while reconfiguring)
+	finishRecordingWriters();
+
+	if (audioCh1Writer_==NULL)
+	{
+		audioCh1Writer_ = new AsynchFileWriter(); //(t_object *)compDescfrom6DOF);
+		audioCh1Writer_->setFileWriter(WaveFileWriter(1, sampleRate));
+	}
+	audioCh1Writer_->allocate(compDescfrom6DOF->clock_write_Delay, sampleRate, tolerance, (int)(maxSecondsPerBar*sampleRate));
+	audioCh1Writer_->startConsumerThread();
+
+	if (trackerWriter_==NULL)
+		trackerWriter_ = new AsynchFileWriter(); //(t_object *)compDescfrom6DOF);
+	if (trackerWriterNumViolins_!=numViolins_)
+	{
+		trackerWriter_->setFileWriter(DatFileWriter(numItemsPerFrameQualisys*numViolins_, trackerSampleRate, 1));
+		trackerWriterNumViolins_=numViolins_;
+	}
+	trackerWriter_->allocate(compDescfrom6DOF->clock_write_Delay, numItemsPerFrameQualisys*MAX_NUM_VIOLINS*trackerSampleRate, tolerance, (int)(numItemsPerFrameQualisys*MAX_NUM_VIOLINS*maxSecondsPerBar*trackerSampleRate));
+	trackerWriter_->startConsumerThread();
+
+	audioCh1Writer_->setChunkCrcSize(compDescfrom6DOF->chunkCrcKBytes*1024);
+	trackerWriter_->setChunkCrcSize(compDescfrom6DOF->chunkCrcKBytes*1024);
+
+	// One writer thread for both streams (large sequential writes rather than interleaved 
+	// small ones, see AsynchFileWriterService):
+	writerService_.addWriter(audioCh1Writer_, "audio ch1");
+	writerService_.addWriter(trackerWriter_, "tracker");
+	writerService_.start((int)compDescfrom6DOF->clock_write_Delay);
+	writersIntervalMilliseconds_=compDescfrom6DOF->clock_write_Delay;
+
+#ifdef IS_COUNTING_ALLOCATIONS
+	if (isSameConfiguration && allocationCount.getCount()>0)
+		post("[r]WARNING: preparing the writers allocated %ld times (unchanged configuration)", allocationCount.getCount());
+#endif
+}
+
+// Finishes a previous take still being written by the writer service (see 
+// compDescfrom6DOF_stopRecording()).
+void finishRecordingWriters()
+{
+	// (handles the pending start and stop events and writes the rest)
+	writerService_.drainAll();
+}
+
+// Keeps the last seconds of audio and tracker data in the writers' buffers while connected, 
+// so startRecording includes them (aligned by time, see compDescfrom6DOF_startRecording()). 
+// 0 turns it off (the writers are then only fed while recording).
+void compDescfrom6DOF_preRoll(t_compDescfrom6DOF *compDescfrom6DOF, double seconds)
+{
+	if (trackerState_==TRACKER_RECORDING)
+	{
+		post("preRoll: can't change while recording");
+		return;
+	}
+	compDescfrom6DOF->preRollSeconds=(float)MIN(MAX(seconds, 0.0), (double)PRE_ROLL_MAX_SECONDS);
+	if (trackerState_==TRACKER_CONNECTED)
+		startHistory(compDescfrom6DOF);
+	post("preRoll=%.1f s", compDescfrom6DOF->preRollSeconds);
+}
+
+// Starts feeding the writers with the history, on start and preRoll. Writers already fed 
+// are kept as they are (their buffers hold the longest pre-roll, see 
+// prepareRecordingWriters()), the pre-roll only sets how much of it startRecording takes.
+void startHistory(t_compDescfrom6DOF *compDescfrom6DOF)
+{
+	if (compDescfrom6DOF->preRollSeconds<=0)
 	{
-		audioCh1Writer_->timerCallback();
-		trackerWriter_->timerCallback();
-		//post("timer triggered");
-		clock_fdelay(compDescfrom6DOF->m_clock_write, compDescfrom6DOF->clock_write_Delay); //schedule the clock again
+		isHistoryEnabled_=false;
+		return;
 	}
+	if (!isHistoryEnabled_ || trackerWriterNumViolins_!=numViolins_)
+		prepareRecordingWriters(compDescfrom6DOF);
+	isHistoryEnabled_=true;
 }
 
 void compDescfrom6DOF_stopRecording(t_compDescfrom6DOF *compDescfrom6DOF)
@@ -382,14 +809,11 @@ void compDescfrom6DOF_stopRecording(t_compDescfrom6DOF *compDescfrom6DOF)
 	{
 		// Stop audio/tracker/arduino recording:
 		trackerState_ = TRACKER_CONNECTED;
+		// (the writer service writes the rest and closes the files, the writers are kept for 
+		// the next take, see prepareRecordingWriters())
 		audioCh1Writer_->postStopDiskWriteEvent();
-		audioCh1Writer_->stopConsumerThread(); // (blocking)
-		delete audioCh1Writer_;
-		audioCh1Writer_ = NULL;
 		trackerWriter_->postStopDiskWriteEvent();
-		trackerWriter_->stopConsumerThread(); // (blocking)
-		delete trackerWriter_;
-		trackerWriter_ = NULL;
+		writerService_.wake();
 	post("Stop recording");
 	}
 
@@ -397,28 +821,36 @@ void compDescfrom6DOF_stopRecording(t_compDescfrom6DOF *compDescfrom6DOF)
 
 void compDescfrom6DOF_start(t_compDescfrom6DOF *compDescfrom6DOF)
 {
+	if (trackerState_==TRACKER_RECORDING)
+		compDescfrom6DOF_stopRecording(compDescfrom6DOF); // (closes the take before the writers are prepared again)
 	post("Start reading 6DOF...");		
 	
 	//Load 6RigidBody XML file from Qualisys software
 	//trackerCalibration_.init(1);
-	bool ok = trackerCalibration_.loadFrom6DOFXMLFile(compDescfrom6DOF->calibFileName);
+	// (only parsed if no instance has it loaded already, or it changed since)
+	const CalibrationCacheEntry *calibration = calibrationCache_.acquire(compDescfrom6DOF->calibFileName);
+	bool ok = (calibration != NULL);
 	if (ok)
 	{
+		calibrationCache_.release(compDescfrom6DOF->calibration);
+		compDescfrom6DOF->calibration=calibration;
+		trackerCalibration_=calibration->calibration;
 		post("Calibration file loaded correctly");
+		if (compDescfrom6DOF->verbose)
+			post("calibration cache: %d files, %d parsed, %d shared", calibrationCache_.getNumEntries(), calibrationCache_.getNumMisses(), calibrationCache_.getNumHits());
 
 		if (!compDescfrom6DOF->clock_compDesc_Delay)
 			compDescfrom6DOF->clock_compDesc_Delay=100;
 
 		trackerState_=TRACKER_CONNECTED;
-		numViolins_=trackerCalibration_.getNumberViolins();
-		float consumptionInterval=compDescfrom6DOF->clock_compDesc_Delay/1000;
-		float prodConsRate= 2*numViolins_*trackerSampleRate;
-		float tolerance=10.0;
+		numViolins_=MIN(trackerCalibration_.getNumberViolins(), MAX_NUM_VIOLINS); // (frameData, RawSensorData slots)
 		
-		//What if start is pressed twice? CBUFFER must be deleted.
-		
-		compDescfrom6DOF->circularBuffer=new CBuffer(consumptionInterval*prodConsRate*tolerance);
-		compDescfrom6DOF->transformedBetas = new Atom[trackerCalibDataSize*numViolins_];
+		// (allocated in new, only reallocated if the task interval grew)
+		compDescfrom6DOF->circularBuffer->cbResize(getCircularBufferSize(compDescfrom6DOF, numViolins_));
+		startHistory(compDescfrom6DOF);
+
+		if (compDescfrom6DOF->oscPort!=0)
+			startOscReceiver(compDescfrom6DOF);
 	
 		clock_fdelay(compDescfrom6DOF->m_clock_compDesc, compDescfrom6DOF->clock_compDesc_Delay);
 	}
@@ -430,18 +862,66 @@ void compDescfrom6DOF_start(t_compDescfrom6DOF *compDescfrom6DOF)
 	}
 	
 }
+// Tracker FIFO size (samples) for the task interval:
+int getCircularBufferSize(t_compDescfrom6DOF *compDescfrom6DOF, int numViolins)
+{
+	float consumptionInterval=compDescfrom6DOF->clock_compDesc_Delay/1000;
+	float prodConsRate= 2*numViolins*trackerSampleRate;
+	float tolerance=10.0;
+	return (int)(consumptionInterval*prodConsRate*tolerance);
+}
+
+void compDescfrom6DOF_free(t_compDescfrom6DOF *compDescfrom6DOF)
+{
+	// (the receiver thread and the replay set the clocks, stop them before freeing those)
+	compDescfrom6DOF_replayStop(compDescfrom6DOF);
+	stopOscReceiver(compDescfrom6DOF);
+	dsp_free((t_pxobject *)compDescfrom6DOF);
+	freeobject((t_object *)compDescfrom6DOF->m_clock_compDesc);
+	freeobject((t_object *)compDescfrom6DOF->m_clock_replay);
+	if (--numInstances_==0) // (otherwise the other instances still record through the shared writers)
+	{
+		compDescfrom6DOF_stopRecording(compDescfrom6DOF);
+		writerService_.stop(); // (closes a take still being written)
+		isHistoryEnabled_=false; // (the next instance prepares the writers and starts the service again)
+	}
+	calibrationCache_.release(compDescfrom6DOF->calibration);
+
+	delete compDescfrom6DOF->oscReceiver;
+	delete compDescfrom6DOF->oscSender;
+	delete compDescfrom6DOF->replayReader;
+	if (compDescfrom6DOF->captureWriter!=NULL)
+	{
+		compDescfrom6DOF->captureWriter->close();
+		delete compDescfrom6DOF->captureWriter;
+	}
+	delete compDescfrom6DOF->signalUpsampler;
+	applyPendingOutputChanges(compDescfrom6DOF); // (changes the task didn't pick up)
+	for (int i=0;i<MAX_NUM_VIOLINS;i++)
+		delete compDescfrom6DOF->descResampler[i];
+	delete compDescfrom6DOF->ringWriter;
+	delete compDescfrom6DOF->circularBuffer;
+	delete[] compDescfrom6DOF->transformedBetas;
+}
+
 void compDescfrom6DOF_stop(t_compDescfrom6DOF *compDescfrom6DOF)
 {
 	//compDescfrom6DOF->running=false;
+	compDescfrom6DOF_replayStop(compDescfrom6DOF);
 	trackerState_=TRACKER_DISCONNECTED;
+	stopOscReceiver(compDescfrom6DOF);
 	compDescfrom6DOF->circularBuffer->resetIdxs();
 }
 
 
 void compDescfrom6DOF_6DOF(t_compDescfrom6DOF *compDescfrom6DOF, Symbol *s, short argc, t_atom *argv)
 {
+	if (compDescfrom6DOF->captureWriter!=NULL && !compDescfrom6DOF->isReplaying)
+		compDescfrom6DOF->captureWriter->write(argc, argv);
 	if (trackerState_==TRACKER_DISCONNECTED)
 		return;
+	if (compDescfrom6DOF->oscReceiver!=NULL && compDescfrom6DOF->oscReceiver->isRunning())
+		return; // (frames come from the native receiver, don't mix both)
 	if (argc < 7 || argc > 8)
 	{ //post("6DOF must be 6 floats, received %d", argc);
 		return;
@@ -457,24 +937,15 @@ void compDescfrom6DOF_6DOF(t_compDescfrom6DOF *compDescfrom6DOF, Symbol *s, shor
 		if (beginning!=NULL)
 		{
 			//post("data: %s", beginning);
-			if(frameCount!=0) //if its not the first frame, save previous data to circBuffer and reset violin and BowData.
+			if(frameCount!=0) //if its not the first frame, save previous data to circBuffer (unless already done when it got complete) and reset violin and BowData.
 			{//save last frame data
-				if (compDescfrom6DOF->circularBuffer->getSize()-compDescfrom6DOF->circularBuffer->getCount()<2) //cbIsFull())
-					post("Overwritting frames in circular buffer: data overrun.");
-				else
-				{
-					compDescfrom6DOF->circularBuffer->cbWrite(&violinData[0]);
-					compDescfrom6DOF->circularBuffer->cbWrite(&bowData[0]);
-					compDescfrom6DOF->circularBuffer->cbWrite(&violinData[1]);
-					compDescfrom6DOF->circularBuffer->cbWrite(&bowData[1]);
-				}
+				if (!isFrameCommitted_)
+					commitFrameToCircularBuffer(compDescfrom6DOF);
 				//prepare new data
-				for (int i=0;i<numViolins_;i++)
+				for (int i=0;i<2*numViolins_;i++)
 				{
-					violinData[i]=LibertyTracker::ItemData();
-					violinData[i].frameCount=argv[4].a_w.w_long;
-					bowData[i]=LibertyTracker::ItemData();
-					bowData[i].frameCount=argv[4].a_w.w_long;
+					frameData[i].initToZero();
+					frameData[i].frameCount=argv[4].a_w.w_long;
 				}			
 				frameCount++;
 				if(argv[4].a_w.w_long != frameCount)
@@ -484,6 +955,8 @@ void compDescfrom6DOF_6DOF(t_compDescfrom6DOF *compDescfrom6DOF, Symbol *s, shor
 			}
 			else //its the first arriving frame
 				frameCount=argv[4].a_w.w_long;
+			receivedBodiesMask_=0;
+			isFrameCommitted_=false;
 		}
 		
 		beginning=strstr(argv[0].a_w.w_sym->s_name, sixDOFStr);
@@ -492,317 +965,1773 @@ void compDescfrom6DOF_6DOF(t_compDescfrom6DOF *compDescfrom6DOF, Symbol *s, shor
 		{
 			if (strcmp(beginning+strlen(sixDOFStr),trackerCalibration_.getLabels()[iLabel].c_str())==0)
 			{
-				violinData[iLabel].position[0]= argv[1].a_w.w_float/10;
-				violinData[iLabel].position[1]= argv[2].a_w.w_float/10;
-				violinData[iLabel].position[2]= argv[3].a_w.w_float/10;
-				violinData[iLabel].orientation[0]= argv[4].a_w.w_float;
-				violinData[iLabel].orientation[1]= argv[5].a_w.w_float;
-				violinData[iLabel].orientation[2]= argv[6].a_w.w_float;		
+				TrackerSample &body=frameData[violinSampleIdx(iLabel)];
+				body.position[0]= argv[1].a_w.w_float/10;
+				body.position[1]= argv[2].a_w.w_float/10;
+				body.position[2]= argv[3].a_w.w_float/10;
+				body.orientation[0]= argv[4].a_w.w_float;
+				body.orientation[1]= argv[5].a_w.w_float;
+				body.orientation[2]= argv[6].a_w.w_float;
+				receivedBodiesMask_ |= 1 << violinSampleIdx(iLabel);
 				break;
 				//post("received 6DOF Violin: %f,%f,%f,%f,%f,%f... waiting for bow,", newData.position[0],newData.position[1],newData.position[2],newData.orientation[0],newData.orientation[1],newData.orientation[2]);
 			}
 			else if(strcmp(beginning+strlen(sixDOFStr),trackerCalibration_.getBowLabels()[iLabel].c_str())==0)
 			{
-				bowData[iLabel].position[0]= argv[1].a_w.w_float/10;
-				bowData[iLabel].position[1]= argv[2].a_w.w_float/10;
-				bowData[iLabel].position[2]= argv[3].a_w.w_float/10;
-				bowData[iLabel].orientation[0]= argv[4].a_w.w_float;
-				bowData[iLabel].orientation[1]= argv[5].a_w.w_float;
-				bowData[iLabel].orientation[2]= argv[6].a_w.w_float;
+				TrackerSample &body=frameData[bowSampleIdx(iLabel)];
+				body.position[0]= argv[1].a_w.w_float/10;
+				body.position[1]= argv[2].a_w.w_float/10;
+				body.position[2]= argv[3].a_w.w_float/10;
+				body.orientation[0]= argv[4].a_w.w_float;
+				body.orientation[1]= argv[5].a_w.w_float;
+				body.orientation[2]= argv[6].a_w.w_float;
+				receivedBodiesMask_ |= 1 << bowSampleIdx(iLabel);
 				break;
 				//post("received 6DOF Bow: %f,%f,%f,%f,%f,%f... waiting for violin,", newData.position[0],newData.position[1],newData.position[2],newData.orientation[0],newData.orientation[1],newData.orientation[2]);
 			}
 		}
-		
+
+		// Commit the frame as soon as all its rigid bodies have arrived, instead of waiting 
+		// for the header of the next frame (saves one tracker period of latency):
+		const unsigned int allBodiesMask = (1 << (2*numViolins_)) - 1;
+		if (frameCount!=0 && !isFrameCommitted_ && receivedBodiesMask_==allBodiesMask)
+			commitFrameToCircularBuffer(compDescfrom6DOF);
 	}
 }
 
-void compDescfrom6DOF_sampleRate(t_compDescfrom6DOF *compDescfrom6DOF, double sr)
+void commitFrameToCircularBuffer(t_compDescfrom6DOF *compDescfrom6DOF)
 {
-	compDescfrom6DOF->clock_compDesc_Delay=sr;
-}
-
-void compDescfrom6DOF_dsp(t_compDescfrom6DOF *compDescfrom6DOF, t_signal **sp, short *count)
-{/*The first parameter in dsp_add() is the name of your perform method, the second
-number indicates the number of arguments in the perform method, followed by the
-arguments, all of which must be the size of a pointer or a long and appears in your
-perform method as an array of t_int. The second parameter passed to the dsp
-method, t_signal **sp, is an array of pointers to struct t_signal
- */
-	post("compDescfrom6DOF~ sr: %f", sp[0]->s_sr);
-	post("compDescfrom6DOF~ size of buffer: %d", sp[0]->s_n);
-	//sp[0]->s_sr=240;
-	//sp[0]->s_n=240;
-	dsp_add(compDescfrom6DOF_perform, 3, sp[0]->s_vec, sp[1]->s_vec, sp[0]->s_n);
-		 //3, sp[0]->s_vec, sp[1]->s_vec, sp[0]->s_n);
+	writeFrameToCircularBuffer(compDescfrom6DOF, frameData);
+	isFrameCommitted_=true;
+
+	// In event-driven mode trigger the task right away. A zero delay clock is used rather 
+	// than a qelem so it runs at scheduler priority; re-setting a pending clock just 
+	// reschedules it, so frames arriving in a burst are coalesced into a single task call.
+	if (compDescfrom6DOF->scheduleMode==SCHEDULE_ON_FRAME)
+		clock_fdelay(compDescfrom6DOF->m_clock_compDesc, 0);
 }
 
-
-t_int *compDescfrom6DOF_perform(t_int *w)
+// Writes the first 2*numViolins_ bodies of a frame (whole frame or nothing, so the reader 
+// stays aligned to frames).
+void writeFrameToCircularBuffer(t_compDescfrom6DOF *compDescfrom6DOF, const TrackerSample *bodies)
 {
-	//t_reverbObj *reverbObj = (t_reverbObj *)(w[1]);
-    t_float *in = (t_float *)(w[1]);
-    t_float *out = (t_float *)(w[2]);
-    int n = (int)(w[3]);
-	int m=n;
-	t_float *auxIn=in;
-	while (m--)
-		*out++ = *in++;
-	//post("llamando perform");
-	if(trackerState_ == TRACKER_RECORDING)
-	{
-		// Send to history buffer:
-		//post("recording audioBuffer");
-		int result=audioCh1Writer_->writeData(auxIn, n); //audioBuffer.getSampleData(0), audioBuffer.getNumSamples());
-		//post("result=%d",result);
-		if (result==0) 
-			post("data not correctly saved");
-	}
-
-	return(w + 4); // always add one more than the 2nd argument in dsp_add()
-}
-
-//function that will do something when the clock is executed
-void compDescfrom6DOF_task(t_compDescfrom6DOF *compDescfrom6DOF)
-{		
-	const int numTrackerItems = compDescfrom6DOF->circularBuffer->getCount(); //tracker_.queryFrames(beginBuffer);
-	const int numTrackerSensors =numViolins_*2; //tracker_.getNumEnabledSensors(); // num items per frame
-	const int numTrackerFrames =  numTrackerItems/numTrackerSensors;
-	const int readIdx=compDescfrom6DOF->circularBuffer->getRIdx();
-	const int bufferSize=compDescfrom6DOF->circularBuffer->getSize();
-
-	if (trackerState_==TRACKER_DISCONNECTED) return; //(compDescfrom6DOF->running==false) return;
-	if (numTrackerFrames==0)
+	const int numBodies=2*numViolins_;
+	if (compDescfrom6DOF->circularBuffer->getSize()-compDescfrom6DOF->circularBuffer->getCount()<numBodies) //cbIsFull())
 	{
-		clock_fdelay(compDescfrom6DOF->m_clock_compDesc, compDescfrom6DOF->clock_compDesc_Delay); //schedule the clock again
-		//post("No data found in buffer");
-		return;
+		compDescfrom6DOF->numFramesOverrun++;
+		if (!compDescfrom6DOF->isReplaying) // (counted and reported at end of replay instead)
+			post("Overwritting frames in circular buffer: data overrun.");
 	}
-
-	ViolinPerformanceDescriptors descriptors;
-	LibertyTracker::ItemDataIterator beginBuffer(compDescfrom6DOF->circularBuffer->cbGetBuffer(), readIdx, bufferSize);
-	//advance circular buffer
-	LibertyTracker::ItemData elem;
-	for (int i=0; i<numTrackerItems;i++)
-		compDescfrom6DOF->circularBuffer->cbRead(&elem);
-
-	//if (trackerState_==TRACKER_RECORDING)
-	//{
-	//	//call function to record polhemus
-	//	sendTrackerDataToHistoryBuffer(beginBuffer, numTrackerFrames, numTrackerSensors);
-	//}
-
-	for (int i = 0; i < numTrackerFrames; ++i)
-	//	int i=numTrackerFrames-1;
+	else
 	{
-		// Compute 'raw' descriptors for current frame:
-		rawSensorData = computeDescriptors_.trackerDataToRawSensorData(beginBuffer,numViolins_,0);
-
-		if (trackerState_==TRACKER_RECORDING)
-		{
-			//call function to record polhemus
-			//sendTrackerDataToHistoryBuffer(beginBuffer, numTrackerFrames, numTrackerSensors);
-			// Send current frame to history buffer
-			sendTrackerDataToHistoryBufferSingleFrame(rawSensorData);
-		}
-		//bool useAutoString=true;
-		bool isCalibratingForce=false;
-		bool isAutoStringEnabled_=true;
-		CalibrationAngles anglesCalibration_; //anglesCalibration_ NOT USED ANYMORE. TODO:remove it
-		
-		for (int iViolin=0; iViolin<numViolins_; iViolin++)
-		{
-			Derived3dData derived3dData = computeDescriptors_.computeDerived3dData(rawSensorData, trackerCalibration_, isAutoStringEnabled_, anglesCalibration_, isCalibratingForce, NULL, iViolin);
-			// XXX: above descriptors are computed twice
-			descriptors = computeDescriptors_.computeViolinPerformanceDescriptors(rawSensorData, derived3dData);
-			// Next frame:
-			beginBuffer.advance(numTrackerSensors);				
-
-			//Compute descriptors. Do it for all received frames??
-			float bowVel=0, bowVelSmooth=0;
-			float bowAccel=0, bowAccelSmooth=0;	
-			for(int i=0;i<N_DESC;i++)
-			{				
-				if (!strcmp(pDescNames[i],"string"))
-					SETLONG(&compDescfrom6DOF->desc[i], (long)derived3dData.playedString);
-				else if (!strcmp(pDescNames[i],"position"))
-					SETFLOAT(&compDescfrom6DOF->desc[i],descriptors.bowDisplacement);
-				else if (!strcmp(pDescNames[i],"bbd"))
-					SETFLOAT(&compDescfrom6DOF->desc[i],descriptors.bowBridgeDistance);
-				else if (!strcmp(pDescNames[i],"vel"))
-				{
-					//compDescfrom6DOF->desc[i]=descriptors.bowVel;
-					bowVel = compDescfrom6DOF->compBowVel_.compute((float)descriptors.bowDisplacement, 240.0f/numTrackerFrames);			
-					compDescfrom6DOF->bowVelSmoother_.process(&bowVel, &bowVelSmooth, 1);
-					SETFLOAT(&compDescfrom6DOF->desc[i], bowVelSmooth);
-				}
-				else if (!strcmp(pDescNames[i],"acc"))
-				{	//compDescfrom6DOF->desc[i]=descriptors.bowAccel;
-					bowAccel = compDescfrom6DOF->compBowAccel_.compute(bowVel, 240.0f/numTrackerFrames);
-					compDescfrom6DOF->bowAccelSmoother1_.process(&bowAccel, &bowAccelSmooth, 1);
-					compDescfrom6DOF->bowAccelSmoother2_.process(&bowAccelSmooth, &bowAccelSmooth, 1);
-					compDescfrom6DOF->bowAccelSmoother3_.process(&bowAccelSmooth, &bowAccelSmooth, 1);
-					SETFLOAT(&compDescfrom6DOF->desc[i], bowAccelSmooth);
-				}
-				else if (!strcmp(pDescNames[i],"force")) 
-				{
-					float forceCorrected=descriptors.bowForce+incForce.get(descriptors.bowDisplacement);
-					forceCorrected=forceCorrected/sensitForce.get(descriptors.bowDisplacement)*2.5;
-					forceCorrected=MIN(forceCorrected,3);
-					forceCorrected=MAX(forceCorrected,-0.5);
-					SETFLOAT(&compDescfrom6DOF->desc[i], forceCorrected);
-					for (int j=0;j<FORCE_BUFF+FORCE_BUFF_DELAY;j++)
-					{
-						compDescfrom6DOF->forceBuffer[j]=compDescfrom6DOF->forceBuffer[j]+1;
-					}
-					compDescfrom6DOF->forceBuffer[FORCE_BUFF+FORCE_BUFF_DELAY]=forceCorrected; //descriptors.bowForce;
-				}
-				//outlet_float(compDescfrom6DOF->desc_out[i], compDescfrom6DOF->desc[i]);
-				outlet_list(compDescfrom6DOF->descInst_out[iViolin], (t_symbol *)"list", N_DESC, compDescfrom6DOF->desc);
-			}
-			//transformed Betas		
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[0], derived3dData.posStr1Bridge(0,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[1], derived3dData.posStr1Bridge(1,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[2], derived3dData.posStr1Bridge(2,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[3], derived3dData.posStr2Bridge(0,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[4], derived3dData.posStr2Bridge(1,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[5], derived3dData.posStr2Bridge(2,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[6], derived3dData.posStr3Bridge(0,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[7], derived3dData.posStr3Bridge(1,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[8], derived3dData.posStr3Bridge(2,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[9], derived3dData.posStr4Bridge(0,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[10], derived3dData.posStr4Bridge(1,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[11], derived3dData.posStr4Bridge(2,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[12], derived3dData.posStr1Wood(0,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[13], derived3dData.posStr1Wood(1,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[14], derived3dData.posStr1Wood(2,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[15], derived3dData.posStr2Wood(0,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[16], derived3dData.posStr2Wood(1,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[17], derived3dData.posStr2Wood(2,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[18], derived3dData.posStr3Wood(0,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[19], derived3dData.posStr3Wood(1,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[20], derived3dData.posStr3Wood(2,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[21], derived3dData.posStr4Wood(0,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[22], derived3dData.posStr4Wood(1,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[23], derived3dData.posStr4Wood(2,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[24], derived3dData.posStr1Fb(0,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[25], derived3dData.posStr1Fb(1,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[26], derived3dData.posStr1Fb(2,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[27], derived3dData.posStr2Fb(0,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[28], derived3dData.posStr2Fb(1,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[29], derived3dData.posStr2Fb(2,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[30], derived3dData.posStr3Fb(0,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[31], derived3dData.posStr3Fb(1,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[32], derived3dData.posStr3Fb(2,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[33], derived3dData.posStr4Fb(0,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[34], derived3dData.posStr4Fb(1,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[35], derived3dData.posStr4Fb(2,0));
-
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[36], derived3dData.posBowFrogLhs(0,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[37], derived3dData.posBowFrogLhs(1,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[38], derived3dData.posBowFrogLhs(2,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[39], derived3dData.posBowFrogRhs(0,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[40], derived3dData.posBowFrogRhs(1,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[41], derived3dData.posBowFrogRhs(2,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[42], derived3dData.posBowTipLhs(0,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[43], derived3dData.posBowTipLhs(1,0)); 
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[44], derived3dData.posBowTipLhs(2,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[45], derived3dData.posBowTipRhs(0,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[46], derived3dData.posBowTipRhs(1,0));
-			SETFLOAT(&compDescfrom6DOF->transformedBetas[47], derived3dData.posBowTipRhs(2,0));
-			outlet_list(compDescfrom6DOF->transformedBetas_out[iViolin], (t_symbol *)"list", trackerCalibDataSize, compDescfrom6DOF->transformedBetas);
-		} 
+		for (int i=0;i<numBodies;i++)
+			compDescfrom6DOF->circularBuffer->cbWrite(&bodies[i]);
+		compDescfrom6DOF->numFramesWritten++;
 	}
-	//post("task done....");
-	if (trackerState_==TRACKER_CONNECTED || trackerState_==TRACKER_RECORDING) //compDescfrom6DOF->running==true)
-		clock_fdelay(compDescfrom6DOF->m_clock_compDesc, compDescfrom6DOF->clock_compDesc_Delay); //schedule the clock again
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-void sendTrackerDataToHistoryBuffer(LibertyTracker::ItemDataIterator iter, int numTrackerFrames, int numTrackerSensors)
+// Sets the UDP port of the native OSC receiver (0 stops it and goes back to the 6DOF 
+// messages). Note: udpreceive must not be bound to the same port.
+void compDescfrom6DOF_oscReceive(t_compDescfrom6DOF *compDescfrom6DOF, long port)
 {
-	// Process tracker frames:
-	for (int i = 0; i < numTrackerFrames; ++i)
-	{
-		// Compute 'raw' descriptors for current frame:
-		RawSensorData rawSensorData = computeDescriptors_.trackerDataToRawSensorData(iter, 1, 0);
-
-		// Compute frame count of frame:
-		frameCount = iter.item().frameCount; // don't offset first frame to avoid not having a lhs frame for interpolation
-
-		bool dropCurFrame = false;
+	stopOscReceiver(compDescfrom6DOF);
+	compDescfrom6DOF->oscPort=port;
+	if (port!=0 && trackerState_!=TRACKER_DISCONNECTED) // (otherwise started by start, once labels are known)
+		startOscReceiver(compDescfrom6DOF);
+}
 
+bool startOscReceiver(t_compDescfrom6DOF *compDescfrom6DOF)
+{
+	if (compDescfrom6DOF->oscReceiver==NULL)
+		compDescfrom6DOF->oscReceiver=new OscReceiver;
 
-		// Use current frame if it's not dropped:
-		if (!dropCurFrame)
-		{
-			// Send current frame to history buffer
-			sendTrackerDataToHistoryBufferSingleFrame(rawSensorData);
-		}
+	std::vector<std::string> violinLabels, bowLabels;
+	for (int i=0;i<numViolins_;i++)
+	{
+		violinLabels.push_back(trackerCalibration_.getLabels()[i]);
+		bowLabels.push_back(trackerCalibration_.getBowLabels()[i]);
+	}
+	compDescfrom6DOF->oscReceiver->setLabels(numViolins_, violinLabels, bowLabels);
+	compDescfrom6DOF->oscReceiver->setFrameCallback(oscFrameCallback, compDescfrom6DOF);
 
-		// Next frame:
-		iter.advance(numTrackerSensors);
+	// Same headroom as the circular buffer (in frames):
+	const int fifoCapacityFrames=compDescfrom6DOF->circularBuffer->getSize()/(2*numViolins_);
+	if (!compDescfrom6DOF->oscReceiver->start(compDescfrom6DOF->oscPort, fifoCapacityFrames))
+	{
+		post("WARNING: OSC receiver failed to start on port %d.", compDescfrom6DOF->oscPort);
+		return false;
 	}
+	if (compDescfrom6DOF->verbose)
+		post("OSC receiver listening on port %d", compDescfrom6DOF->oscPort);
+	return true;
 }
 
-void sendTrackerDataToHistoryBufferSingleFrame(const RawSensorData &frame)
+void stopOscReceiver(t_compDescfrom6DOF *compDescfrom6DOF)
 {
-	static float trackerFrame[numItemsPerFrameQualisys];
-
-	// sensor 1 (violin body):
-	trackerFrame[0] = (float)frame.violinBodySensPos[0](0, 0);
-	trackerFrame[1] = (float)frame.violinBodySensPos[0](1, 0);
-	trackerFrame[2] = (float)frame.violinBodySensPos[0](2, 0);
-	trackerFrame[3] = (float)frame.violinBodySensOrientation[0](0, 0);
-	trackerFrame[4] = (float)frame.violinBodySensOrientation[0](1, 0);
-	trackerFrame[5] = (float)frame.violinBodySensOrientation[0](2, 0);
- 
-	// sensor 2 (bow):
-	trackerFrame[6] = (float)frame.bowSensPos[0](0, 0);
-	trackerFrame[7] = (float)frame.bowSensPos[0](1, 0);
-	trackerFrame[8] = (float)frame.bowSensPos[0](2, 0);
-	trackerFrame[9] = (float)frame.bowSensOrientation[0](0, 0);
-	trackerFrame[10] = (float)frame.bowSensOrientation[0](1, 0);
-	trackerFrame[11] = (float)frame.bowSensOrientation[0](2, 0);
-
-	int n=trackerWriter_->writeData(trackerFrame, numItemsPerFrameQualisys); // (internally checks and logs if not all of the requested items could be written)
-	int a=n;// Note: Write entire frame as a single atomic operation.
+	if (compDescfrom6DOF->oscSender!=NULL)
+		compDescfrom6DOF->oscSender->stopReplayThread();
+	if (compDescfrom6DOF->oscReceiver!=NULL)
+		compDescfrom6DOF->oscReceiver->stop(); // (blocking, max. receive timeout)
 }
 
-void compDescfrom6DOF_setDir(t_compDescfrom6DOF *compDescfrom6DOF, Symbol *s)
+// Called from the receiver thread after each frame. Setting a clock is thread-safe.
+void oscFrameCallback(void *context)
 {
-	strcpy(compDescfrom6DOF->baseDir,s->s_name);
-	if (compDescfrom6DOF->verbose)
-		post("dirBase=%s",compDescfrom6DOF->baseDir);	
+	t_compDescfrom6DOF *compDescfrom6DOF=(t_compDescfrom6DOF *)context;
+	if (compDescfrom6DOF->scheduleMode==SCHEDULE_ON_FRAME)
+		clock_fdelay(compDescfrom6DOF->m_clock_compDesc, 0);
 }
 
-void compDescfrom6DOF_setScoreName(t_compDescfrom6DOF *compDescfrom6DOF, Symbol *s)
+// Moves frames assembled by the receiver thread to the circular buffer (scheduler thread, 
+// so the circular buffer itself is still only accessed from a single thread).
+void readOscReceiverFrames(t_compDescfrom6DOF *compDescfrom6DOF)
 {
-	strcpy(compDescfrom6DOF->scoreName,s->s_name);
-	if (compDescfrom6DOF->verbose)
-		post("scoreName=%s",compDescfrom6DOF->scoreName);	
+	const int maxFramesPerRead=16;
+	TrackerFrame frames[maxFramesPerRead];
+	int numFrames;
+	do
+	{
+		numFrames=compDescfrom6DOF->oscReceiver->readFrames(frames, maxFramesPerRead);
+		for (int i=0;i<numFrames;i++)
+			writeFrameToCircularBuffer(compDescfrom6DOF, frames[i].bodies);
+	} while (numFrames==maxFramesPerRead);
 }
 
-void compDescfrom6DOF_setTake(t_compDescfrom6DOF *compDescfrom6DOF, long ntake)
+// Starts/stops capturing the packets received by the native OSC receiver to a file 
+// (no argument stops).
+void compDescfrom6DOF_oscCapture(t_compDescfrom6DOF *compDescfrom6DOF, Symbol *s)
 {
-	compDescfrom6DOF->ntake=ntake;
+	if (compDescfrom6DOF->oscReceiver==NULL)
+		compDescfrom6DOF->oscReceiver=new OscReceiver;
+
+	if (s==NULL || s->s_name[0]=='\0')
+	{
+		compDescfrom6DOF->oscReceiver->stopPacketCapture();
+		post("OSC capture stopped");
+	}
+	else if (compDescfrom6DOF->oscReceiver->startPacketCapture(s->s_name))
+		post("OSC capture to %s", s->s_name);
+	else
+		post("WARNING: Failed to open OSC capture file %s", s->s_name);
 }
 
-void compDescfrom6DOF_setCalibFileName(t_compDescfrom6DOF *compDescfrom6DOF, Symbol *s)
+// Replays a capture to the native receiver port on 127.0.0.1 (speed 1: original timing, 
+// N: N times faster, 0: as fast as possible).
+void compDescfrom6DOF_oscReplay(t_compDescfrom6DOF *compDescfrom6DOF, Symbol *s, double speed)
 {
-	strcpy(compDescfrom6DOF->calibFileName, s->s_name);
-	if (compDescfrom6DOF->verbose)
-		post("calibFileName=%s",compDescfrom6DOF->calibFileName);	
+	if (compDescfrom6DOF->oscPort==0)
+	{
+		post("WARNING: set oscReceive port before replaying");
+		return;
+	}
+	if (compDescfrom6DOF->oscSender==NULL)
+		compDescfrom6DOF->oscSender=new OscSender;
+	if (!compDescfrom6DOF->oscSender->isOpen() && !compDescfrom6DOF->oscSender->open("127.0.0.1", compDescfrom6DOF->oscPort))
+	{
+		post("WARNING: Failed to open OSC sender socket");
+		return;
+	}
+	if (!compDescfrom6DOF->oscSender->startReplayThread(s->s_name, speed))
+		post("WARNING: Failed to start OSC replay of %s", s->s_name);
 }
 
-void initSmoothingFilter(FilterFir &filter, int size)
+// Starts capturing all incoming 6DOF messages (with arrival times) to a file, for replaying 
+// them later without the tracker (no argument stops).
+void compDescfrom6DOF_capture(t_compDescfrom6DOF *compDescfrom6DOF, Symbol *s)
 {
-	if (size <= 0)
+	if (compDescfrom6DOF->captureWriter!=NULL)
+	{
+		post("Capture stopped (%u messages)", compDescfrom6DOF->captureWriter->getNumMessages());
+		delete compDescfrom6DOF->captureWriter;
+		compDescfrom6DOF->captureWriter=NULL;
+	}
+	if (s==NULL || s->s_name[0]=='\0')
 		return;
 
-	float *coeffs = new float[size];
-
-	// compute gaussian window for n points:
+	compDescfrom6DOF->captureWriter=new SixDofCaptureWriter;
+	if (compDescfrom6DOF->captureWriter->open(s->s_name))
+		post("Capturing 6DOF messages to %s", s->s_name);
+	else
+	{
+		post("WARNING: Failed to open capture file %s", s->s_name);
+		delete compDescfrom6DOF->captureWriter;
+		compDescfrom6DOF->captureWriter=NULL;
+	}
+}
+
+// Feeds a capture back into compDescfrom6DOF_6DOF() (object must be started). speed 1 
+// replays with the original timing, N N times faster, <= 0 as fast as possible. Message 
+// due times are relative to the replay start, so scheduler jitter doesn't accumulate.
+void compDescfrom6DOF_replay(t_compDescfrom6DOF *compDescfrom6DOF, Symbol *s, double speed)
+{
+	compDescfrom6DOF_replayStop(compDescfrom6DOF);
+	if (trackerState_==TRACKER_DISCONNECTED)
+	{
+		post("WARNING: start before replaying");
+		return;
+	}
+
+	if (compDescfrom6DOF->replayReader==NULL)
+		compDescfrom6DOF->replayReader=new SixDofCaptureReader;
+	if (!compDescfrom6DOF->replayReader->load(s->s_name))
+	{
+		post("WARNING: Failed to load capture file %s", s->s_name);
+		return;
+	}
+	post("Replaying %d messages from %s", (int)compDescfrom6DOF->replayReader->getMessages().size(), s->s_name);
+
+	compDescfrom6DOF->replaySpeed=speed;
+	compDescfrom6DOF->replayIdx=0;
+	compDescfrom6DOF->numFramesWritten=0;
+	compDescfrom6DOF->numFramesOverrun=0;
+	compDescfrom6DOF->numFramesProcessed=0;
+	compDescfrom6DOF->isReplaying=true;
+	compDescfrom6DOF->replayStartTimeMs=getSixDofCaptureTimeMs();
+	clock_fdelay(compDescfrom6DOF->m_clock_replay, 0);
+}
+
+void compDescfrom6DOF_replayStop(t_compDescfrom6DOF *compDescfrom6DOF)
+{
+	if (!compDescfrom6DOF->isReplaying)
+		return;
+
+	clock_unset(compDescfrom6DOF->m_clock_replay);
+	compDescfrom6DOF->isReplaying=false;
+
+	const double elapsedMs=getSixDofCaptureTimeMs()-compDescfrom6DOF->replayStartTimeMs;
+	post("Replay: %d messages in %.1f ms (%.0f messages/s), %lu frames written, %lu overrun, %lu processed", 
+		compDescfrom6DOF->replayIdx, elapsedMs, (elapsedMs > 0) ? compDescfrom6DOF->replayIdx*1000.0/elapsedMs : 0.0,
+		compDescfrom6DOF->numFramesWritten, compDescfrom6DOF->numFramesOverrun, compDescfrom6DOF->numFramesProcessed);
+}
+
+void compDescfrom6DOF_replayTask(t_compDescfrom6DOF *compDescfrom6DOF)
+{
+	if (!compDescfrom6DOF->isReplaying)
+		return;
+
+	const std::vector<SixDofCaptureReader::Message> &messages=compDescfrom6DOF->replayReader->getMessages();
+	const int numMessages=(int)messages.size();
+	Symbol *sixDofSym=gensym("6DOF");
+
+	if (compDescfrom6DOF->replaySpeed>0)
+	{
+		// Dispatch all messages that are due, then sleep until the next one:
+		const double elapsedMs=getSixDofCaptureTimeMs()-compDescfrom6DOF->replayStartTimeMs;
+		while (compDescfrom6DOF->replayIdx<numMessages && messages[compDescfrom6DOF->replayIdx].timeMs/compDescfrom6DOF->replaySpeed<=elapsedMs)
+		{
+			const SixDofCaptureReader::Message &message=messages[compDescfrom6DOF->replayIdx++];
+			compDescfrom6DOF_6DOF(compDescfrom6DOF, sixDofSym, message.argc, (t_atom *)message.argv);
+		}
+		if (compDescfrom6DOF->replayIdx<numMessages)
+		{
+			clock_fdelay(compDescfrom6DOF->m_clock_replay, messages[compDescfrom6DOF->replayIdx].timeMs/compDescfrom6DOF->replaySpeed-elapsedMs);
+			return;
+		}
+	}
+	else
+	{
+		// As fast as possible, but in chunks (and without overfilling the circular buffer) so 
+		// the descriptor task gets to run in between:
+		const int halfBufferSize=compDescfrom6DOF->circularBuffer->getSize()/2;
+		for (int i=0; i<REPLAY_MAX_SPEED_CHUNK && compDescfrom6DOF->replayIdx<numMessages && compDescfrom6DOF->circularBuffer->getCount()<halfBufferSize; i++)
+		{
+			const SixDofCaptureReader::Message &message=messages[compDescfrom6DOF->replayIdx++];
+			compDescfrom6DOF_6DOF(compDescfrom6DOF, sixDofSym, message.argc, (t_atom *)message.argv);
+		}
+		if (compDescfrom6DOF->replayIdx<numMessages)
+		{
+			clock_fdelay(compDescfrom6DOF->m_clock_replay, 0);
+			return;
+		}
+	}
+
+	compDescfrom6DOF_replayStop(compDescfrom6DOF); // (done)
+}
+
+void compDescfrom6DOF_oscStats(t_compDescfrom6DOF *compDescfrom6DOF)
+{
+	if (compDescfrom6DOF->oscReceiver==NULL)
+		return;
+	post("OSC receiver: %u packets, %u malformed, %u frames dropped, %s", 
+		compDescfrom6DOF->oscReceiver->getNumPacketsReceived(), 
+		compDescfrom6DOF->oscReceiver->getNumMalformedPackets(), 
+		compDescfrom6DOF->oscReceiver->getNumFramesDropped(),
+		(compDescfrom6DOF->oscSender!=NULL && compDescfrom6DOF->oscSender->isReplaying()) ? "replaying" : "not replaying");
+}
+
+// Posts the disk throughput, buffer fill levels and overflows of the recording streams 
+// (see AsynchFileWriterService), e.g. to size the writer buffers (prepareRecordingWriters()) 
+// from a take.
+void compDescfrom6DOF_ioStats(t_compDescfrom6DOF *compDescfrom6DOF)
+{
+	AsynchFileWriterService::StreamStats stats;
+	for (int i=0;writerService_.getStreamStats(i, stats);i++)
+	{
+		post("%s: %.0f items/s, fill %.0f%% (max. %.0f%%, high-water %.0f%%), drain %.2f ms (max. %.2f ms), %u items written", stats.name, 
+			stats.itemsPerSecond, 100*stats.fillLevel, 100*stats.maxFillLevel, 100*stats.highWaterLevel, 
+			stats.drainMilliseconds, stats.maxDrainMilliseconds, stats.numItemsWritten);
+		if (stats.numOverflows>0)
+			post("WARNING: %s: %u overflows, %u items dropped", stats.name, stats.numOverflows, stats.numItemsDropped);
+	}
+	post("Writer service %s, interval %d ms%s", writerService_.isRunning() ? "running" : "not running", 
+		writerService_.getCurrentIntervalMilliseconds(), writerService_.isAdaptiveInterval() ? " (adaptive)" : "");
+}
+
+void compDescfrom6DOF_ioStatsReset(t_compDescfrom6DOF *compDescfrom6DOF)
+{
+	writerService_.resetStats();
+}
+
+// Writes the CRC32 of every kBytes of sample data of the take files to <take file>.crc (see 
+// ChunkCrcWriter), from the next take on; 0 turns it off.
+void compDescfrom6DOF_chunkCrc(t_compDescfrom6DOF *compDescfrom6DOF, long kBytes)
+{
+	compDescfrom6DOF->chunkCrcKBytes=MAX(kBytes, 0);
+	if (audioCh1Writer_!=NULL && trackerState_!=TRACKER_RECORDING)
+	{
+		// (the writers are only prepared again for a take when not keeping a pre-roll)
+		audioCh1Writer_->setChunkCrcSize(compDescfrom6DOF->chunkCrcKBytes*1024);
+		trackerWriter_->setChunkCrcSize(compDescfrom6DOF->chunkCrcKBytes*1024);
+	}
+	post("chunkCrc=%ld kB", compDescfrom6DOF->chunkCrcKBytes);
+}
+
+// Checks the take files with CRC records in a directory (dirBase if none given) against 
+// their records, one file per processor in parallel. Blocks the scheduler while running.
+void compDescfrom6DOF_verifyArchive(t_compDescfrom6DOF *compDescfrom6DOF, Symbol *s)
+{
+	const char *dir=(s!=NULL && s->s_name[0]!='\0') ? s->s_name : compDescfrom6DOF->baseDir;
+	std::vector<std::string> filenames;
+	if (findChunkCrcFiles(dir, filenames)==0)
+	{
+		post("verifyArchive: no CRC files in %s", dir);
+		return;
+	}
+
+	std::vector<ChunkCrcVerifyResult> results(filenames.size());
+	for (size_t i=0;i<filenames.size();i++)
+		results[i].filename=filenames[i];
+	SYSTEM_INFO systemInfo;
+	GetSystemInfo(&systemInfo);
+	verifyChunkCrcsParallel(results, (int)systemInfo.dwNumberOfProcessors);
+
+	int numFailed=0;
+	for (size_t i=0;i<results.size();i++)
+	{
+		if (results[i].status==ChunkCrcVerifyResult::OK)
+			continue;
+		numFailed++;
+		if (results[i].status==ChunkCrcVerifyResult::CORRUPT)
+			post("[r]ERROR: %s: %d of %d chunks corrupt, first at byte %.0f", results[i].filename.c_str(), 
+				results[i].numBadChunks, results[i].numChunks, (double)results[i].firstBadChunk*results[i].chunkSizeBytes);
+		else
+			post("[r]ERROR: %s: %s", results[i].filename.c_str(), getChunkCrcStatusName(results[i].status));
+	}
+	post("verifyArchive: %d files checked, %d failed", (int)results.size(), numFailed);
+}
+
+// 1: the writer service wakes up sooner as the recording buffers fill up (see 
+// AsynchFileWriterService::setAdaptiveInterval()), 0: every clock_write_Delay ms.
+void compDescfrom6DOF_adaptiveDrain(t_compDescfrom6DOF *compDescfrom6DOF, long isAdaptive)
+{
+	writerService_.setAdaptiveInterval(isAdaptive!=0);
+	post("adaptiveDrain=%d", isAdaptive!=0);
+}
+
+// Runs the descriptor pipeline (raw sensor data, derived 3d data, descriptors, bow 
+// velocity/acceleration with smoothing, bow force correction) headless on synthetic frames of numInstruments 
+// instruments at rate Hz, as fast as possible, and reports the max. sustainable frame 
+// rate. Needs the calibration (start) for the instrument geometry. Blocks the scheduler 
+// while running, so don't use it during a performance.
+void compDescfrom6DOF_benchmark(t_compDescfrom6DOF *compDescfrom6DOF, long numInstruments, long rate, double seconds)
+{
+	if (trackerState_==TRACKER_DISCONNECTED || compDescfrom6DOF->calibration==NULL)
+	{
+		post("WARNING: start (load calibration) before running the benchmark");
+		return;
+	}
+	numInstruments=MIN(MAX(numInstruments, 1), TrackerStreamGenerator::MAX_NUM_INSTRUMENTS);
+	rate=MAX(rate, 1);
+	seconds=MIN(MAX(seconds, 0.1), BENCHMARK_MAX_SECONDS);
+	const int numFrames=(int)(seconds*rate);
+
+	// Generate all frames first, so only the pipeline is timed:
+	TrackerStreamGenerator generator;
+	generator.init(numInstruments, (double)rate, compDescfrom6DOF->calibration->calibration, numViolins_);
+	const int numBodies=2*numInstruments;
+	std::vector<TrackerSample> frames(numFrames*numBodies);
+	for (int i=0;i<numFrames;i++)
+		generator.generateFrame(&frames[i*numBodies]);
+
+	// Per instrument state (as the task has for a single instrument), bow velocity, 
+	// acceleration and force correction are computed for all instruments at once:
+	const int maxNumInstruments=TrackerStreamGenerator::MAX_NUM_INSTRUMENTS;
+	ComputeViolinPeformanceDescriptors *computeDescriptors=new ComputeViolinPeformanceDescriptors[numInstruments];
+	for (int j=0;j<numInstruments;j++)
+	{
+		computeDescriptors[j].setContactGateDistance(computeDescriptors_.getContactGateDistance());
+		computeDescriptors[j].setDerived3dFields(compDescfrom6DOF->derived3dFields);
+	}
+	FusedDerivativeSmoother<maxNumInstruments> *bowDerivatives=new FusedDerivativeSmoother<maxNumInstruments>;
+	initBowDerivatives(*bowDerivatives);
+	float bowDisplacement[maxNumInstruments]={0}, bowVel[maxNumInstruments], bowAccel[maxNumInstruments];
+	double bowForce[maxNumInstruments], bowForceDisplacement[maxNumInstruments];
+	float bowForceCorrected[maxNumInstruments];
+
+	const double degToRad=3.1415926535897932384626433832795/180.0;
+	CalibrationAngles anglesCalibration;
+	RawSensorData raw;
+	raw.extSyncFlag=false;
+	raw.stylusButtonPressed=false;
+	raw.areRotationsValid=false; // (orientations are set below)
+	unsigned long numContactFrames=0;
+	volatile float sink=0.0f; // (keeps the results from being optimized away)
+
+	const double startTimeMs=getSixDofCaptureTimeMs();
+	for (int i=0;i<numFrames;i++)
+	{
+		for (int j=0;j<numInstruments;j++)
+		{
+			// Instruments share the calibrated violin slots (geometry was generated for the 
+			// same calibration violin, see TrackerStreamGenerator::init()):
+			const int slot=j%numViolins_;
+			const TrackerSample &violin=frames[i*numBodies+violinSampleIdx(j)];
+			const TrackerSample &bow=frames[i*numBodies+bowSampleIdx(j)];
+			raw.violinBodySensPos[slot]=Matrix3x1(violin.position[0], violin.position[1], violin.position[2]);
+			raw.violinBodySensOrientation[slot]=Matrix3x1(violin.orientation[0]*degToRad, violin.orientation[1]*degToRad, violin.orientation[2]*degToRad);
+			raw.bowSensPos[slot]=Matrix3x1(bow.position[0], bow.position[1], bow.position[2]);
+			raw.bowSensOrientation[slot]=Matrix3x1(bow.orientation[0]*degToRad, bow.orientation[1]*degToRad, bow.orientation[2]*degToRad);
+
+			Derived3dData derived3dData=computeDescriptors[j].computeDerived3dData(raw, compDescfrom6DOF->calibration->calibration, true, anglesCalibration, false, NULL, slot);
+			ViolinPerformanceDescriptors descriptors=computeDescriptors[j].computeViolinPerformanceDescriptors(raw, derived3dData, true, numViolins_, slot, true, (float)rate);
+
+			bowDisplacement[j]=(float)descriptors.bowDisplacement;
+			bowForce[j]=descriptors.bowForce;
+			bowForceDisplacement[j]=descriptors.bowDisplacement;
+
+			if (derived3dData.playedString!=0)
+				numContactFrames++;
+			sink=sink+(float)descriptors.bowBridgeDistance;
+		}
+
+		bowDerivatives->process(bowDisplacement, (float)rate, bowVel, bowAccel);
+		correctBowForce(bowForce, bowForceDisplacement, bowForceCorrected, numInstruments);
+		sink=sink+bowVel[0]+bowAccel[0]+bowForceCorrected[0];
+	}
+	const double elapsedMs=getSixDofCaptureTimeMs()-startTimeMs;
+
+	unsigned long numGatedFrames=0;
+	for (int j=0;j<numInstruments;j++)
+		numGatedFrames+=computeDescriptors[j].getNumGatedFrames();
+	delete[] computeDescriptors;
+	delete bowDerivatives;
+
+	const double maxRate=(elapsedMs>0.0) ? numFrames*1000.0/elapsedMs : 0.0;
+	const double cpuShare=elapsedMs/(seconds*1000.0);
+	post("Benchmark: %ld instruments, %d frames in %.1f ms: max. %.0f frames/s (%.0f instrument frames/s)", 
+		numInstruments, numFrames, elapsedMs, maxRate, maxRate*numInstruments);
+	post("Benchmark: %ld Hz %s (%.1f%% of real time used), bow contact in %.0f%% of frames, %.0f%% gated (see contactGate)", 
+		rate, (cpuShare<1.0) ? "sustainable" : "NOT sustainable", cpuShare*100.0, 
+		100.0*numContactFrames/((double)numFrames*numInstruments), 
+		100.0*numGatedFrames/((double)numFrames*numInstruments));
+}
+
+// Compares the single precision descriptor geometry (DescriptorGeometry.hxx, Matrix3x1f) 
+// with the double precision pipeline on synthetic frames of numInstruments instruments 
+// (as benchmark): max. absolute error of each descriptor over the frames in contact (key 
+// points and angles over all frames), number of frames where contact differs, and the time 
+// of the geometry in both precisions. The double precision template is compared too, as 
+// a check that it matches the pipeline. Needs the calibration (start). Blocks the 
+// scheduler while running.
+void compDescfrom6DOF_comparePrecision(t_compDescfrom6DOF *compDescfrom6DOF, long numInstruments, double seconds)
+{
+	enum { DISPLACEMENT, BBD, FORCE_LHS, FORCE_RHS, FORCE, STICK_BRIDGE, VEL, ACC, TILT, INCLINATION, BOW_BRIDGE_ANGLE, KEY_POINTS, NUM_ERRORS };
+	const char *errorNames[NUM_ERRORS]={"position (cm)", "bbd (cm)", "forceLhs (cm)", "forceRhs (cm)", "force", "stickBridge (cm)", "vel (cm/s)", "acc (cm/s2)", 
+		"tilt (deg)", "inclination (deg)", "bowBridgeAngle (deg)", "key points (cm)"};
+
+	if (trackerState_==TRACKER_DISCONNECTED || compDescfrom6DOF->calibration==NULL)
+	{
+		post("WARNING: start (load calibration) before comparing precision");
+		return;
+	}
+	numInstruments=MIN(MAX(numInstruments, 1), TrackerStreamGenerator::MAX_NUM_INSTRUMENTS);
+	seconds=MIN(MAX(seconds, 0.1), BENCHMARK_MAX_SECONDS);
+	const int numFrames=(int)(seconds*trackerSampleRate);
+	const int numBodies=2*numInstruments;
+	const int maxNumInstruments=TrackerStreamGenerator::MAX_NUM_INSTRUMENTS;
+	const double degToRad=3.1415926535897932384626433832795/180.0;
+
+	TrackerStreamGenerator generator;
+	generator.init(numInstruments, (double)trackerSampleRate, compDescfrom6DOF->calibration->calibration, numViolins_);
+	std::vector<TrackerSample> frame(numBodies);
+
+	// Betas as the pipeline uses them (packed when the calibration was loaded, see CalibrationCache):
+	const InstrumentKeyPointsT<double> &betas=compDescfrom6DOF->calibration->betas[0];
+	InstrumentKeyPointsT<float> betasf;
+	for (int k=0;k<4;k++)
+	{
+		betasf.strBridge[k]=Matrix3x1f(betas.strBridge[k]);
+		betasf.strFb[k]=Matrix3x1f(betas.strFb[k]);
+	}
+	betasf.bowFrogLhs=Matrix3x1f(betas.bowFrogLhs);
+	betasf.bowFrogRhs=Matrix3x1f(betas.bowFrogRhs);
+	betasf.bowTipLhs=Matrix3x1f(betas.bowTipLhs);
+	betasf.bowTipRhs=Matrix3x1f(betas.bowTipRhs);
+
+	// Reference pipeline per instrument (not gated, descriptors not zeroed when not 
+	// playing), velocity and acceleration from the reference and the single precision 
+	// displacement through the same smoother:
+	ComputeViolinPeformanceDescriptors *computeDescriptors=new ComputeViolinPeformanceDescriptors[numInstruments];
+	for (int j=0;j<numInstruments;j++)
+		computeDescriptors[j].setContactGateDistance(0.0);
+	FusedDerivativeSmoother<maxNumInstruments> *derivatives=new FusedDerivativeSmoother<maxNumInstruments>;
+	FusedDerivativeSmoother<maxNumInstruments> *derivativesf=new FusedDerivativeSmoother<maxNumInstruments>;
+	initBowDerivatives(*derivatives);
+	initBowDerivatives(*derivativesf);
+	float displacement[maxNumInstruments]={0}, vel[maxNumInstruments], acc[maxNumInstruments];
+	float displacementf[maxNumInstruments]={0}, velf[maxNumInstruments], accf[maxNumInstruments];
+	bool isInContact[maxNumInstruments]={false};
+
+	// Poses and played strings, to time both precisions afterwards:
+	std::vector<Matrix3x1> poses(4*numFrames*numInstruments);
+	std::vector<int> playedStrings(numFrames*numInstruments);
+
+	double maxError[NUM_ERRORS]={0}, maxErrorDouble[NUM_ERRORS]={0};
+	unsigned long numContactFrames=0, numContactMismatches=0;
+	CalibrationAngles anglesCalibration;
+	RawSensorData raw;
+	raw.extSyncFlag=false;
+	raw.stylusButtonPressed=false;
+	raw.areRotationsValid=false; // (orientations are set below)
+	DescriptorGeometryT<double> geometry;
+	DescriptorGeometryT<float> geometryf;
+
+	for (int i=0;i<numFrames;i++)
+	{
+		generator.generateFrame(&frame[0]);
+		for (int j=0;j<numInstruments;j++)
+		{
+			const int slot=j%numViolins_;
+			const TrackerSample &violin=frame[violinSampleIdx(j)];
+			const TrackerSample &bow=frame[bowSampleIdx(j)];
+			raw.violinBodySensPos[slot]=Matrix3x1(violin.position[0], violin.position[1], violin.position[2]);
+			raw.violinBodySensOrientation[slot]=Matrix3x1(violin.orientation[0]*degToRad, violin.orientation[1]*degToRad, violin.orientation[2]*degToRad);
+			raw.bowSensPos[slot]=Matrix3x1(bow.position[0], bow.position[1], bow.position[2]);
+			raw.bowSensOrientation[slot]=Matrix3x1(bow.orientation[0]*degToRad, bow.orientation[1]*degToRad, bow.orientation[2]*degToRad);
+
+			Derived3dData derived3dData=computeDescriptors[j].computeDerived3dData(raw, compDescfrom6DOF->calibration->calibration, true, anglesCalibration, false, NULL, slot);
+			ViolinPerformanceDescriptors descriptors=computeDescriptors[j].computeViolinPerformanceDescriptors(raw, derived3dData, false, numViolins_, slot, true, (float)trackerSampleRate);
+			const int playedString=getReferenceString(derived3dData);
+
+			Matrix3x1 *pose=&poses[4*(i*numInstruments+j)];
+			pose[0]=raw.violinBodySensPos[slot];
+			pose[1]=raw.violinBodySensOrientation[slot];
+			pose[2]=raw.bowSensPos[slot];
+			pose[3]=raw.bowSensOrientation[slot];
+			playedStrings[i*numInstruments+j]=playedString;
+
+			computeDescriptorGeometry(betas, pose[0], pose[1], pose[2], pose[3], playedString, geometry);
+			computeDescriptorGeometry(betasf, Matrix3x1f(pose[0]), Matrix3x1f(pose[1]), Matrix3x1f(pose[2]), Matrix3x1f(pose[3]), playedString, geometryf);
+
+			// Errors of both precisions:
+			for (int precision=0;precision<2;precision++)
+			{
+				double *errors=(precision==0) ? maxErrorDouble : maxError;
+				double value[NUM_ERRORS], keyPointsError=0.0;
+				const Matrix3x1 *refPoints[12]={&derived3dData.posStr1Bridge, &derived3dData.posStr2Bridge, &derived3dData.posStr3Bridge, &derived3dData.posStr4Bridge, 
+					&derived3dData.posStr1Fb, &derived3dData.posStr2Fb, &derived3dData.posStr3Fb, &derived3dData.posStr4Fb, 
+					&derived3dData.posBowFrogLhs, &derived3dData.posBowFrogRhs, &derived3dData.posBowTipLhs, &derived3dData.posBowTipRhs};
+				Matrix3x1 points[12];
+				if (precision==0)
+				{
+					value[DISPLACEMENT]=geometry.bowDisplacement;
+					value[BBD]=geometry.bowBridgeDistance;
+					value[FORCE_LHS]=geometry.bowForceLhs;
+					value[FORCE_RHS]=geometry.bowForceRhs;
+					value[FORCE]=computeDescriptors[j].computeBowForce(geometry.bowDisplacement, geometry.bowForceLhs, geometry.bowForceRhs, geometry.bowLength);
+					value[STICK_BRIDGE]=geometry.stickBridgeDistance;
+					value[TILT]=geometry.bowTiltAngleDegrees;
+					value[INCLINATION]=geometry.bowInclinationDegrees;
+					value[BOW_BRIDGE_ANGLE]=geometry.bowBridgeAngleDegrees;
+					for (int k=0;k<4;k++)
+					{
+						points[k]=geometry.points.strBridge[k];
+						points[4+k]=geometry.points.strFb[k];
+					}
+					points[8]=geometry.points.bowFrogLhs;
+					points[9]=geometry.points.bowFrogRhs;
+					points[10]=geometry.points.bowTipLhs;
+					points[11]=geometry.points.bowTipRhs;
+				}
+				else
+				{
+					value[DISPLACEMENT]=geometryf.bowDisplacement;
+					value[BBD]=geometryf.bowBridgeDistance;
+					value[FORCE_LHS]=geometryf.bowForceLhs;
+					value[FORCE_RHS]=geometryf.bowForceRhs;
+					value[FORCE]=computeDescriptors[j].computeBowForce(geometryf.bowDisplacement, geometryf.bowForceLhs, geometryf.bowForceRhs, geometryf.bowLength);
+					value[STICK_BRIDGE]=geometryf.stickBridgeDistance;
+					value[TILT]=geometryf.bowTiltAngleDegrees;
+					value[INCLINATION]=geometryf.bowInclinationDegrees;
+					value[BOW_BRIDGE_ANGLE]=geometryf.bowBridgeAngleDegrees;
+					for (int k=0;k<4;k++)
+					{
+						points[k]=Matrix3x1(geometryf.points.strBridge[k]);
+						points[4+k]=Matrix3x1(geometryf.points.strFb[k]);
+					}
+					points[8]=Matrix3x1(geometryf.points.bowFrogLhs);
+					points[9]=Matrix3x1(geometryf.points.bowFrogRhs);
+					points[10]=Matrix3x1(geometryf.points.bowTipLhs);
+					points[11]=Matrix3x1(geometryf.points.bowTipRhs);
+				}
+				for (int k=0;k<12;k++)
+					for (int c=0;c<3;c++)
+						keyPointsError=MAX(keyPointsError, fabs(points[k](c, 0)-(*refPoints[k])(c, 0)));
+
+				errors[TILT]=MAX(errors[TILT], fabs(value[TILT]-derived3dData.bowTiltAngleDegrees));
+				errors[INCLINATION]=MAX(errors[INCLINATION], fabs(value[INCLINATION]-derived3dData.bowInclinationDegrees));
+				errors[BOW_BRIDGE_ANGLE]=MAX(errors[BOW_BRIDGE_ANGLE], fabs(value[BOW_BRIDGE_ANGLE]-derived3dData.bowBridgeAngleDegrees));
+				errors[KEY_POINTS]=MAX(errors[KEY_POINTS], keyPointsError);
+				if (derived3dData.isInterRefLhsInsideStringAndBow || derived3dData.isInterRefRhsInsideStringAndBow)
+				{
+					errors[DISPLACEMENT]=MAX(errors[DISPLACEMENT], fabs(value[DISPLACEMENT]-descriptors.bowDisplacement));
+					errors[BBD]=MAX(errors[BBD], fabs(value[BBD]-descriptors.bowBridgeDistance));
+					errors[FORCE_LHS]=MAX(errors[FORCE_LHS], fabs(value[FORCE_LHS]-descriptors.bowForceLhs));
+					errors[FORCE_RHS]=MAX(errors[FORCE_RHS], fabs(value[FORCE_RHS]-descriptors.bowForceRhs));
+					errors[FORCE]=MAX(errors[FORCE], fabs(value[FORCE]-descriptors.bowForce));
+					errors[STICK_BRIDGE]=MAX(errors[STICK_BRIDGE], fabs(value[STICK_BRIDGE]-descriptors.stickBridgeDistance));
+				}
+			}
+
+			isInContact[j]=derived3dData.isInterRefLhsInsideStringAndBow || derived3dData.isInterRefRhsInsideStringAndBow;
+			if (isInContact[j])
+				numContactFrames++;
+			if (geometryf.isInContact!=isInContact[j])
+				numContactMismatches++;
+			displacement[j]=(float)descriptors.bowDisplacement;
+			displacementf[j]=geometryf.bowDisplacement;
+		}
+
+		derivatives->process(displacement, (float)trackerSampleRate, vel, acc);
+		derivativesf->process(displacementf, (float)trackerSampleRate, velf, accf);
+		for (int j=0;j<numInstruments;j++)
+		{
+			if (!isInContact[j])
+				continue;
+			maxError[VEL]=MAX(maxError[VEL], fabs((double)velf[j]-vel[j]));
+			maxError[ACC]=MAX(maxError[ACC], fabs((double)accf[j]-acc[j]));
+		}
+	}
+	delete[] computeDescriptors;
+	delete derivatives;
+	delete derivativesf;
+
+	// Time the geometry in both precisions (poses converted beforehand, as a single 
+	// precision pipeline would get them from the tracker):
+	const int numItems=numFrames*numInstruments;
+	std::vector<Matrix3x1f> posesf(poses.size());
+	for (size_t k=0;k<poses.size();k++)
+		posesf[k]=Matrix3x1f(poses[k]);
+	volatile double sink=0.0; // (keeps the results from being optimized away)
+	double startTimeMs=getSixDofCaptureTimeMs();
+	for (int k=0;k<numItems;k++)
+	{
+		computeDescriptorGeometry(betas, poses[4*k], poses[4*k+1], poses[4*k+2], poses[4*k+3], playedStrings[k], geometry);
+		sink=sink+geometry.bowDisplacement+geometry.bowForceLhs;
+	}
+	const double elapsedMs=getSixDofCaptureTimeMs()-startTimeMs;
+	startTimeMs=getSixDofCaptureTimeMs();
+	for (int k=0;k<numItems;k++)
+	{
+		computeDescriptorGeometry(betasf, posesf[4*k], posesf[4*k+1], posesf[4*k+2], posesf[4*k+3], playedStrings[k], geometryf);
+		sink=sink+geometryf.bowDisplacement+geometryf.bowForceLhs;
+	}
+	const double elapsedMsf=getSixDofCaptureTimeMs()-startTimeMs;
+
+	post("comparePrecision: %ld instruments, %d frames (%lu in contact): contact differs in %lu frames", 
+		numInstruments, numFrames, numContactFrames, numContactMismatches);
+	for (int k=0;k<NUM_ERRORS;k++)
+	{
+		if (k==VEL || k==ACC)
+			post("  %s: max. error float %g", errorNames[k], maxError[k]);
+		else
+			post("  %s: max. error float %g, double %g", errorNames[k], maxError[k], maxErrorDouble[k]);
+	}
+	post("comparePrecision: geometry double %.3f us, float %.3f us per instrument frame", 
+		elapsedMs*1000.0/numItems, elapsedMsf*1000.0/numItems);
+}
+
+// Played string (1 to 4) the reference string of the frame was taken from (also when 
+// not in contact, when playedString is 0).
+int getReferenceString(const Derived3dData &derived3dData)
+{
+	const Matrix3x1 *strBridge[4]={&derived3dData.posStr1Bridge, &derived3dData.posStr2Bridge, &derived3dData.posStr3Bridge, &derived3dData.posStr4Bridge};
+	for (int k=0;k<4;k++)
+	{
+		if ((*strBridge[k])(0, 0)==derived3dData.posStrRefBridge(0, 0) && (*strBridge[k])(1, 0)==derived3dData.posStrRefBridge(1, 0) 
+			&& (*strBridge[k])(2, 0)==derived3dData.posStrRefBridge(2, 0))
+			return k+1;
+	}
+	return 1;
+}
+
+// Writes synthetic frames as an OSC capture (see oscCapture), to be replayed to the native 
+// receiver with oscReplay. Labels are the calibrated ones, reused when there are more 
+// instruments than calibrated violins (the receiver then only keeps one of the bodies 
+// with the same label, so this is mainly useful for network/parsing load).
+void compDescfrom6DOF_generateCapture(t_compDescfrom6DOF *compDescfrom6DOF, Symbol *s, long numInstruments, long rate, double seconds)
+{
+	if (trackerState_==TRACKER_DISCONNECTED || compDescfrom6DOF->calibration==NULL)
+	{
+		post("WARNING: start (load calibration) before generating a capture");
+		return;
+	}
+	numInstruments=MIN(MAX(numInstruments, 1), TrackerStreamGenerator::MAX_NUM_INSTRUMENTS);
+	rate=MAX(rate, 1);
+
+	// (labels and geometry of this instance's calibration, not of the one started last)
+	TrackerCalibration calibration=compDescfrom6DOF->calibration->calibration;
+	std::vector<std::string> violinLabels, bowLabels;
+	for (int i=0;i<numInstruments;i++)
+	{
+		violinLabels.push_back(calibration.getLabels()[i%numViolins_]);
+		bowLabels.push_back(calibration.getBowLabels()[i%numViolins_]);
+	}
+
+	TrackerStreamGenerator generator;
+	generator.init(numInstruments, (double)rate, calibration, numViolins_);
+	const int numFrames=(int)(MAX(seconds, 0.0)*rate);
+	if (generator.writeOscCapture(s->s_name, numFrames, violinLabels, bowLabels))
+		post("Generated %d frames (%ld instruments, %ld Hz) to %s", numFrames, numInstruments, rate, s->s_name);
+	else
+		post("WARNING: Failed to write %s", s->s_name);
+}
+
+// Selects the bow velocity/acceleration estimator (EstimatorMode). For ESTIMATOR_KALMAN an 
+// optional bandwidth (Hz) sets the noise/lag trade-off: higher follows faster with less 
+// delay, lower is smoother.
+void compDescfrom6DOF_estimator(t_compDescfrom6DOF *compDescfrom6DOF, long mode, double bandwidth)
+{
+	if (mode!=ESTIMATOR_FIR && mode!=ESTIMATOR_KALMAN)
+	{
+		post("estimator must be 0 (fir) or 1 (kalman)");
+		return;
+	}
+	compDescfrom6DOF->estimatorMode=mode;
+	if (bandwidth>0)
+		compDescfrom6DOF->estimatorBandwidth=bandwidth;
+	initBowKalman(compDescfrom6DOF);
+	if (compDescfrom6DOF->verbose)
+	{
+		if (mode==ESTIMATOR_KALMAN)
+			post("estimator=kalman (%.1f Hz)", compDescfrom6DOF->estimatorBandwidth);
+		else
+			post("estimator=fir");
+	}
+}
+
+void initBowKalman(t_compDescfrom6DOF *compDescfrom6DOF)
+{
+	const double processNoise=KinematicKalmanFilter::processNoiseForBandwidth(compDescfrom6DOF->estimatorBandwidth, ESTIMATOR_MEASUREMENT_NOISE, trackerSampleRate);
+	for (int i=0;i<MAX_NUM_VIOLINS;i++)
+		compDescfrom6DOF->bowKalman_[i].init(processNoise, ESTIMATOR_MEASUREMENT_NOISE);
+}
+
+// Compensates bow force for its dependence on bow position (incForce, sensitForce) and 
+// clips it to the output range.
+void correctBowForce(const double *bowForce, const double *bowDisplacement, float *forceCorrected, int n)
+{
+	double inc[FORCE_CORRECTION_BATCH], sensit[FORCE_CORRECTION_BATCH];
+	for (int i0=0;i0<n;i0+=FORCE_CORRECTION_BATCH)
+	{
+		const int batchSize=MIN(n-i0, FORCE_CORRECTION_BATCH);
+		incForce.get(bowDisplacement+i0, inc, batchSize);
+		sensitForce.get(bowDisplacement+i0, sensit, batchSize);
+		for (int i=0;i<batchSize;i++)
+		{
+			float force=bowForce[i0+i]+inc[i];
+			force=force/sensit[i]*2.5;
+			force=MIN(force,3);
+			force=MAX(force,-0.5);
+			forceCorrected[i0+i]=force;
+		}
+	}
+}
+
+// Bow displacement is zeroed while the bow is off the string (see 
+// computeViolinPerformanceDescriptors()), so the filter restarts at each contact instead 
+// of following the jump.
+void processBowKalman(KinematicKalmanFilter &filter, bool isBowOnString, double bowDisplacement, double dt, float &bowVel, float &bowAccel)
+{
+	if (!isBowOnString)
+	{
+		filter.reset();
+		bowVel=0.0f;
+		bowAccel=0.0f;
+		return;
+	}
+	filter.process(bowDisplacement, dt, NULL, &bowVel, &bowAccel);
+}
+
+// Offline comparison of the bow velocity/acceleration estimators on a capture (see 
+// capture): runs the descriptor pipeline on all its frames and reports lag, error and 
+// roughness of the FIR and Kalman (current bandwidth) estimates per violin, against a 
+// zero phase reference (see EstimatorComparison). Blocks the scheduler while running.
+void compDescfrom6DOF_compareEstimators(t_compDescfrom6DOF *compDescfrom6DOF, Symbol *s)
+{
+	if (trackerState_==TRACKER_DISCONNECTED || compDescfrom6DOF->calibration==NULL)
+	{
+		post("WARNING: start (load calibration) before comparing estimators");
+		return;
+	}
+	SixDofCaptureReader reader;
+	if (!reader.load(s->s_name))
+	{
+		post("WARNING: Failed to load capture file %s", s->s_name);
+		return;
+	}
+	// (labels and geometry of this instance's calibration, not of the one started last)
+	TrackerCalibration calibration=compDescfrom6DOF->calibration->calibration;
+	std::vector<TrackerSample> frames;
+	const int numFrames=captureToFrames(reader, calibration, frames);
+	if (numFrames==0)
+	{
+		post("WARNING: No complete frames in %s", s->s_name);
+		return;
+	}
+
+	const float *referenceWindow=bowSmoother9_;
+	const double rate=trackerSampleRate;
+	const double msPerFrame=1000.0/rate;
+	const int numBodies=2*numViolins_;
+	const double processNoise=KinematicKalmanFilter::processNoiseForBandwidth(compDescfrom6DOF->estimatorBandwidth, ESTIMATOR_MEASUREMENT_NOISE, rate);
+	CalibrationAngles anglesCalibration;
+
+	for (int iViolin=0;iViolin<numViolins_;iViolin++)
+	{
+		ComputeViolinPeformanceDescriptors *computeDescriptors=new ComputeViolinPeformanceDescriptors;
+		computeDescriptors->setDerived3dFields(compDescfrom6DOF->derived3dFields);
+		FusedDerivativeSmoother<> *firEstimator=new FusedDerivativeSmoother<>;
+		initBowDerivatives(*firEstimator);
+		KinematicKalmanFilter kalmanEstimator;
+		kalmanEstimator.init(processNoise, ESTIMATOR_MEASUREMENT_NOISE);
+
+		std::vector<float> displacement(numFrames);
+		std::vector<bool> isBowOnString(numFrames);
+		std::vector<float> firVel(numFrames), firAccel(numFrames), kalmanVel(numFrames), kalmanAccel(numFrames);
+		RawSensorData raw;
+		for (int i=0;i<numFrames;i++)
+		{
+			TrackerSampleIterator iter(&frames[i*numBodies], 0, numBodies);
+			computeDescriptors->trackerDataToRawSensorData(iter, numViolins_, raw);
+			Derived3dData derived3dData=computeDescriptors->computeDerived3dData(raw, calibration, true, anglesCalibration, false, NULL, iViolin);
+			ViolinPerformanceDescriptors descriptors=computeDescriptors->computeViolinPerformanceDescriptors(raw, derived3dData, true, numViolins_, iViolin, false, (float)rate);
+
+			displacement[i]=(float)descriptors.bowDisplacement;
+			isBowOnString[i]=derived3dData.isInterRefLhsInsideStringAndBow || derived3dData.isInterRefRhsInsideStringAndBow;
+			firEstimator->process(&displacement[i], (float)rate, &firVel[i], &firAccel[i]);
+			processBowKalman(kalmanEstimator, isBowOnString[i], displacement[i], 1.0/rate, kalmanVel[i], kalmanAccel[i]);
+		}
+		delete computeDescriptors;
+		delete firEstimator;
+
+		EstimatorComparison comparison;
+		comparison.init(displacement, isBowOnString, rate, referenceWindow, 9, ESTIMATOR_COMPARISON_MAX_LAG);
+		const EstimatorComparison::Stats firVelStats=comparison.evaluateVel(firVel);
+		const EstimatorComparison::Stats kalmanVelStats=comparison.evaluateVel(kalmanVel);
+		const EstimatorComparison::Stats firAccelStats=comparison.evaluateAccel(firAccel);
+		const EstimatorComparison::Stats kalmanAccelStats=comparison.evaluateAccel(kalmanAccel);
+
+		post("Estimators violin %d: %d frames, %d evaluated (bow on string), kalman %.1f Hz (fir / kalman):", 
+			iViolin, numFrames, firVelStats.numFrames, compDescfrom6DOF->estimatorBandwidth);
+		post("  vel: lag %.1f / %.1f ms, error %.2f / %.2f cm/s, roughness %.2f / %.2f cm/s", 
+			firVelStats.lag*msPerFrame, kalmanVelStats.lag*msPerFrame, firVelStats.error, kalmanVelStats.error, firVelStats.roughness, kalmanVelStats.roughness);
+		post("  acc: lag %.1f / %.1f ms, error %.1f / %.1f cm/s2, roughness %.1f / %.1f cm/s2", 
+			firAccelStats.lag*msPerFrame, kalmanAccelStats.lag*msPerFrame, firAccelStats.error, kalmanAccelStats.error, firAccelStats.roughness, kalmanAccelStats.roughness);
+	}
+}
+
+// Assembles the 6DOF messages of a capture into frames of 2*numViolins_ bodies (same 
+// parsing as compDescfrom6DOF_6DOF(), with the labels of calibration), keeping only 
+// complete frames. Returns the number of frames.
+int captureToFrames(const SixDofCaptureReader &reader, TrackerCalibration &calibration, std::vector<TrackerSample> &frames)
+{
+	const char *sixDOFStr="/qtm/6d_euler/";
+	const char *frameNumStr="/qtm/data";
+	const int numBodies=2*numViolins_;
+	const unsigned int allBodiesMask=(1 << numBodies) - 1;
+	TrackerSample bodies[2*MAX_NUM_VIOLINS];
+	unsigned int receivedMask=0;
+	bool isFrameStarted=false;
+
+	frames.clear();
+	const std::vector<SixDofCaptureReader::Message> &messages=reader.getMessages();
+	for (size_t m=0;m<=messages.size();m++)
+	{
+		const bool isEnd=(m==messages.size());
+		const SixDofCaptureReader::Message *message=isEnd ? NULL : &messages[m];
+		if (!isEnd && (message->argc<7 || message->argv[0].a_type!=A_SYM))
+			continue;
+		const char *address=isEnd ? NULL : message->argv[0].a_w.w_sym->s_name;
+
+		if (isEnd || strstr(address, frameNumStr)!=NULL)
+		{
+			if (isFrameStarted && receivedMask==allBodiesMask)
+				frames.insert(frames.end(), bodies, bodies+numBodies);
+			if (isEnd)
+				break;
+			for (int i=0;i<numBodies;i++)
+			{
+				bodies[i].initToZero();
+				bodies[i].frameCount=message->argv[4].a_w.w_long;
+			}
+			receivedMask=0;
+			isFrameStarted=true;
+			continue;
+		}
+
+		const char *beginning=strstr(address, sixDOFStr);
+		if (beginning==NULL || !isFrameStarted)
+			continue;
+		for (int iLabel=0;iLabel<numViolins_;iLabel++)
+		{
+			int idx=-1;
+			if (strcmp(beginning+strlen(sixDOFStr),calibration.getLabels()[iLabel].c_str())==0)
+				idx=violinSampleIdx(iLabel);
+			else if (strcmp(beginning+strlen(sixDOFStr),calibration.getBowLabels()[iLabel].c_str())==0)
+				idx=bowSampleIdx(iLabel);
+			if (idx<0)
+				continue;
+			TrackerSample &body=bodies[idx];
+			body.position[0]=message->argv[1].a_w.w_float/10;
+			body.position[1]=message->argv[2].a_w.w_float/10;
+			body.position[2]=message->argv[3].a_w.w_float/10;
+			body.orientation[0]=message->argv[4].a_w.w_float;
+			body.orientation[1]=message->argv[5].a_w.w_float;
+			body.orientation[2]=message->argv[6].a_w.w_float;
+			receivedMask |= 1 << idx;
+			break;
+		}
+	}
+	return (int)frames.size()/numBodies;
+}
+
+// Resamples the descriptor outlets from the tracker rate to rate Hz (e.g. 172.265625 for 
+// the 44100/256 synthesis frame rate), so they are on the synthesis frame grid instead of 
+// following the tracker frames (delayed by about 4 tracker frames, see 
+// PolyphaseResampler). 0 goes back to one output per tracker frame.
+void compDescfrom6DOF_outputRate(t_compDescfrom6DOF *compDescfrom6DOF, double rate)
+{
+	if (rate<0)
+	{
+		post("outputRate must be >= 0");
+		return;
+	}
+
+	// All resamplers are built and validated before any of them is used, the task swaps them 
+	// in (it may be processing with the current ones meanwhile):
+	DescResamplerChange *change=new DescResamplerChange;
+	for (int i=0;i<MAX_NUM_VIOLINS;i++)
+		change->resamplers[i]=NULL;
+	for (int i=0;i<MAX_NUM_VIOLINS && rate>0;i++)
+	{
+		change->resamplers[i]=new PolyphaseResampler;
+		if (!change->resamplers[i]->init(trackerSampleRate, rate, N_DESC) || change->resamplers[i]->getMaxNumOutputFrames(1)>RESAMPLER_MAX_OUTPUT_FRAMES)
+		{
+			deleteDescResamplerChange(change);
+			post("WARNING: Can't resample from %d to %.3f Hz", trackerSampleRate, rate);
+			return;
+		}
+	}
+	compDescfrom6DOF->outputRate=rate;
+	if (compDescfrom6DOF->verbose)
+	{
+		if (rate==0)
+			post("outputRate=tracker frames");
+		else
+			post("outputRate=%.3f Hz (%d/%d of tracker rate, latency %.1f ms)", rate, 
+				change->resamplers[0]->getUpFactor(), change->resamplers[0]->getDownFactor(), 
+				change->resamplers[0]->getLatency()*1000.0/trackerSampleRate);
+	}
+
+	// (replaces a change the task didn't pick up yet)
+	deleteDescResamplerChange((DescResamplerChange *)InterlockedExchangePointer(&compDescfrom6DOF->pendingDescResamplers, change));
+}
+
+void deleteDescResamplerChange(DescResamplerChange *change)
+{
+	if (change==NULL)
+		return;
+	for (int i=0;i<MAX_NUM_VIOLINS;i++)
+		delete change->resamplers[i];
+	delete change;
+}
+
+// Swaps in the resamplers and ring writer handed over by compDescfrom6DOF_outputRate() and 
+// compDescfrom6DOF_publish(), from the task so they're never replaced while it's using 
+// them (the previous ones are deleted here).
+void applyPendingOutputChanges(t_compDescfrom6DOF *compDescfrom6DOF)
+{
+	DescResamplerChange *resamplerChange=(DescResamplerChange *)InterlockedExchangePointer(&compDescfrom6DOF->pendingDescResamplers, NULL);
+	if (resamplerChange!=NULL)
+	{
+		for (int i=0;i<MAX_NUM_VIOLINS;i++)
+		{
+			PolyphaseResampler *previous=compDescfrom6DOF->descResampler[i];
+			compDescfrom6DOF->descResampler[i]=resamplerChange->resamplers[i];
+			resamplerChange->resamplers[i]=previous;
+			compDescfrom6DOF->heldDescPos[i]=0;
+			compDescfrom6DOF->numHeldDescFrames[i]=0;
+		}
+		deleteDescResamplerChange(resamplerChange); // (the previous resamplers)
+	}
+
+	RingWriterChange *ringWriterChange=(RingWriterChange *)InterlockedExchangePointer(&compDescfrom6DOF->pendingRingWriter, NULL);
+	if (ringWriterChange!=NULL)
+	{
+		DescriptorRingWriter *previous=compDescfrom6DOF->ringWriter;
+		compDescfrom6DOF->ringWriter=ringWriterChange->writer;
+		ringWriterChange->writer=previous;
+		deleteRingWriterChange(ringWriterChange); // (the previous writer)
+	}
+}
+
+// Feeds the descriptors of the current frame (desc) to the violin's resampler and outputs 
+// the resampled frames that became available (none or one, or more when upsampling). 
+// Integer descriptors (string) are categorical, they aren't interpolated (which would 
+// give strings that aren't played around string crossings): they are sample-and-hold, 
+// from the input frame the resampler latency back (the nearest to the output frames).
+void outputResampledDescriptors(t_compDescfrom6DOF *compDescfrom6DOF, int iViolin)
+{
+	PolyphaseResampler *resampler=compDescfrom6DOF->descResampler[iViolin];
+	float input[N_DESC];
+	float output[RESAMPLER_MAX_OUTPUT_FRAMES*N_DESC];
+	long *held=compDescfrom6DOF->heldDesc[iViolin][compDescfrom6DOF->heldDescPos[iViolin]];
+	for (int i=0;i<N_DESC;i++)
+	{
+		const Atom &a=compDescfrom6DOF->desc[i];
+		input[i]=(a.a_type==A_FLOAT) ? a.a_w.w_float : 0.0f; // (integer channels are not used)
+		held[i]=(a.a_type==A_LONG) ? a.a_w.w_long : 0;
+	}
+
+	// (before the first frame the signal is constant, as for the resampler)
+	int &numHeld=compDescfrom6DOF->numHeldDescFrames[iViolin];
+	const int delay=MIN((int)floor(resampler->getLatency()+0.5), MIN(numHeld, RESAMPLER_HOLD_FRAMES-1));
+	const long *delayed=compDescfrom6DOF->heldDesc[iViolin][(compDescfrom6DOF->heldDescPos[iViolin]-delay+RESAMPLER_HOLD_FRAMES)%RESAMPLER_HOLD_FRAMES];
+	compDescfrom6DOF->heldDescPos[iViolin]=(compDescfrom6DOF->heldDescPos[iViolin]+1)%RESAMPLER_HOLD_FRAMES;
+	numHeld=MIN(numHeld+1, RESAMPLER_HOLD_FRAMES);
+
+	const int numOutputFrames=resampler->process(input, 1, output);
+	Atom resampled[N_DESC];
+	for (int k=0;k<numOutputFrames;k++)
+	{
+		for (int i=0;i<N_DESC;i++)
+		{
+			if (compDescfrom6DOF->desc[i].a_type==A_LONG)
+				SETLONG(&resampled[i], delayed[i]);
+			else
+				SETFLOAT(&resampled[i], output[k*N_DESC+i]);
+		}
+		outlet_list(compDescfrom6DOF->descInst_out[iViolin], (t_symbol *)"list", N_DESC, resampled);
+	}
+}
+
+// Sets the time the descriptor signals are delayed to absorb task jitter and batching
+// (should be above the task interval in periodic mode).
+void compDescfrom6DOF_signalLatency(t_compDescfrom6DOF *compDescfrom6DOF, double ms)
+{
+	if (compDescfrom6DOF->signalUpsampler==NULL)
+	{
+		post("No descriptor signal outlets (see object argument)");
+		return;
+	}
+	compDescfrom6DOF->signalUpsampler->setLatency((int)ceil(ms*trackerSampleRate/1000.0));
+	if (compDescfrom6DOF->verbose)
+		post("signalLatency=%d frames (%.1f ms)", compDescfrom6DOF->signalUpsampler->getLatency(), 
+			compDescfrom6DOF->signalUpsampler->getLatency()*1000.0/trackerSampleRate);
+}
+
+void compDescfrom6DOF_signalStats(t_compDescfrom6DOF *compDescfrom6DOF)
+{
+	if (compDescfrom6DOF->signalUpsampler==NULL)
+		return;
+	post("Descriptor signals: %u frames dropped (FIFO full), %u skipped (above latency), %u underruns", 
+		compDescfrom6DOF->signalUpsampler->getNumFramesDropped(), 
+		compDescfrom6DOF->signalUpsampler->getNumFramesSkipped(), 
+		compDescfrom6DOF->signalUpsampler->getNumUnderruns());
+}
+
+// Writes frames to buffer~s named <prefix>.<stream> instead of outputting them as lists, 
+// where stream is a descriptor name (see pDescNames) or beta0..beta47 (transformed 
+// betas), with a channel per instrument (instruments beyond the number of channels are 
+// not written). Frame n goes to frame n % (number of frames) of each buffer~ (a ring, 
+// buffer~s may have different sizes); the number of frames written is sent out of the 
+// write position outlet after each task call. Only existing buffer~s are written, so a 
+// patch creates the ones it reads (e.g. with index~ or peek~). No prefix: lists again.
+void compDescfrom6DOF_bufferSink(t_compDescfrom6DOF *compDescfrom6DOF, Symbol *s)
+{
+	if (s==NULL || s->s_name[0]==0)
+	{
+		compDescfrom6DOF->isBufferSinkEnabled=false;
+		if (compDescfrom6DOF->verbose)
+			post("bufferSink off");
+		return;
+	}
+
+	char name[MAX_PATH];
+	for (int i=0;i<numBufferSinkStreams;i++)
+	{
+		if (i<N_DESC)
+			sprintf(name, "%.200s.%s", s->s_name, pDescNames[i]);
+		else
+			sprintf(name, "%.200s.beta%d", s->s_name, i-N_DESC);
+		compDescfrom6DOF->bufferSinkNames[i]=gensym(name);
+	}
+	compDescfrom6DOF->bufferSinkFrameCount=0;
+	compDescfrom6DOF->isBufferSinkEnabled=true;
+
+	const int numBound=bindBufferSink(compDescfrom6DOF);
+	releaseBufferSink(compDescfrom6DOF);
+	if (compDescfrom6DOF->verbose)
+		post("bufferSink %s: %d of %d buffer~s found", s->s_name, numBound, numBufferSinkStreams);
+}
+
+// Looks up the sink buffer~s (they may have been created, deleted or resized since the 
+// last task call) and marks them in use, returns the number found.
+int bindBufferSink(t_compDescfrom6DOF *compDescfrom6DOF)
+{
+	int numBound=0;
+	for (int i=0;i<numBufferSinkStreams;i++)
+	{
+		t_symbol *name=compDescfrom6DOF->bufferSinkNames[i];
+		t_buffer *b=(t_buffer *)(name->s_thing);
+		compDescfrom6DOF->bufferSinkBuffers[i]=NULL;
+		if (b==NULL || ob_sym(b)!=ps_buffer)
+			continue;
+		ATOMIC_INCREMENT(&b->b_inuse);
+		if (!b->b_valid || b->b_frames<1)
+		{
+			ATOMIC_DECREMENT(&b->b_inuse);
+			continue;
+		}
+		compDescfrom6DOF->bufferSinkBuffers[i]=b;
+		numBound++;
+	}
+	return numBound;
+}
+
+void releaseBufferSink(t_compDescfrom6DOF *compDescfrom6DOF)
+{
+	for (int i=0;i<numBufferSinkStreams;i++)
+	{
+		if (compDescfrom6DOF->bufferSinkBuffers[i]!=NULL)
+			ATOMIC_DECREMENT(&compDescfrom6DOF->bufferSinkBuffers[i]->b_inuse);
+		compDescfrom6DOF->bufferSinkBuffers[i]=NULL;
+	}
+}
+
+// Writes the descriptors (desc) and transformed betas of the current frame to channel 
+// iViolin of the bound sink buffer~s.
+void writeFrameToBufferSink(t_compDescfrom6DOF *compDescfrom6DOF, int iViolin, const float *betas)
+{
+	const unsigned long frame=compDescfrom6DOF->bufferSinkFrameCount;
+	for (int i=0;i<numBufferSinkStreams;i++)
+	{
+		t_buffer *b=compDescfrom6DOF->bufferSinkBuffers[i];
+		if (b==NULL || iViolin>=b->b_nchans)
+			continue;
+		float value;
+		if (i<N_DESC)
+		{
+			const Atom &a=compDescfrom6DOF->desc[i];
+			value=(a.a_type==A_LONG) ? (float)a.a_w.w_long : (a.a_type==A_FLOAT) ? a.a_w.w_float : 0.0f;
+		}
+		else
+			value=betas[i-N_DESC];
+		b->b_samples[(frame % (unsigned long)b->b_frames)*b->b_nchans + iViolin]=value;
+	}
+}
+
+// Points of the transformed betas, 3 coordinates each: strings 1-4 at the bridge, the 
+// wood and the fingerboard end, bow frog lhs/rhs, bow tip lhs/rhs.
+void getTransformedBetas(const Derived3dData &derived3dData, float *betas)
+{
+	const Matrix3x1 *points[trackerCalibDataSize/3]=
+	{
+		&derived3dData.posStr1Bridge, &derived3dData.posStr2Bridge, &derived3dData.posStr3Bridge, &derived3dData.posStr4Bridge, 
+		&derived3dData.posStr1Wood, &derived3dData.posStr2Wood, &derived3dData.posStr3Wood, &derived3dData.posStr4Wood, 
+		&derived3dData.posStr1Fb, &derived3dData.posStr2Fb, &derived3dData.posStr3Fb, &derived3dData.posStr4Fb, 
+		&derived3dData.posBowFrogLhs, &derived3dData.posBowFrogRhs, &derived3dData.posBowTipLhs, &derived3dData.posBowTipRhs
+	};
+	for (int i=0;i<trackerCalibDataSize/3;i++)
+	{
+		for (int j=0;j<3;j++)
+			betas[3*i+j]=(float)(*points[i])(j,0);
+	}
+}
+
+// Publishes every computed frame (per instrument) to the named shared memory ring for 
+// other processes (see DescriptorRing), with capacity records (0: default). No name: stops.
+void compDescfrom6DOF_publish(t_compDescfrom6DOF *compDescfrom6DOF, Symbol *s, long capacity)
+{
+	// (the task swaps the writer in, it may be publishing with the current one meanwhile)
+	RingWriterChange *change=new RingWriterChange;
+	change->writer=NULL;
+	if (s==NULL || s->s_name[0]==0)
+	{
+		if (compDescfrom6DOF->verbose)
+			post("publish off");
+	}
+	else
+	{
+		DescriptorRingWriter *writer=new DescriptorRingWriter;
+		if (!writer->open(s->s_name, (capacity>0) ? capacity : DescriptorRingWriter::DEFAULT_CAPACITY))
+		{
+			post("Could not open shared memory ring %s (in use with a different layout?)", s->s_name);
+			delete writer;
+			delete change;
+			return;
+		}
+		change->writer=writer;
+		if (compDescfrom6DOF->verbose)
+			post("publish %s: %d records of %d bytes", s->s_name, writer->getCapacity(), (int)sizeof(DescriptorRingRecord));
+	}
+
+	// (replaces a change the task didn't pick up yet)
+	deleteRingWriterChange((RingWriterChange *)InterlockedExchangePointer(&compDescfrom6DOF->pendingRingWriter, change));
+}
+
+void deleteRingWriterChange(RingWriterChange *change)
+{
+	if (change==NULL)
+		return;
+	delete change->writer;
+	delete change;
+}
+
+// Latency and throughput of the shared memory ring with a reader on another thread, 
+// publishing at rate records/s (0: as fast as possible, e.g. 960 for 4 instruments at 
+// 240 Hz). Blocks the scheduler while running.
+void compDescfrom6DOF_publishBenchmark(t_compDescfrom6DOF *compDescfrom6DOF, long numRecords, double rate)
+{
+	DescriptorRingBenchmarkResult result;
+	numRecords=MAX(numRecords, 1);
+	if (!runDescriptorRingBenchmark(numRecords, DescriptorRingWriter::DEFAULT_CAPACITY, rate, result))
+	{
+		post("publishBenchmark: could not create the ring");
+		return;
+	}
+	post("publishBenchmark: written %.0f records/s, read %.0f records/s (%u read, %u lost), latency mean %.1f us, max %.1f us", 
+		result.writeRate, result.readRate, result.numRead, result.numLost, result.meanLatency*1e6, result.maxLatency*1e6);
+}
+
+// Publishes the poses, key points (betas) and descriptors (desc, descriptors) of the 
+// current frame of an instrument.
+void publishFrameToRing(t_compDescfrom6DOF *compDescfrom6DOF, int iViolin, DWORD frameNumber, int playedString, const ViolinPerformanceDescriptors &descriptors, const float *betas)
+{
+	DescriptorRingRecord &record=compDescfrom6DOF->ringWriter->beginRecord();
+	record.frameNumber=frameNumber;
+	record.instrument=iViolin;
+	for (int j=0;j<3;j++)
+	{
+		record.violinPosition[j]=(float)rawSensorData.violinBodySensPos[iViolin](j,0);
+		record.violinOrientation[j]=(float)rawSensorData.violinBodySensOrientation[iViolin](j,0);
+		record.bowPosition[j]=(float)rawSensorData.bowSensPos[iViolin](j,0);
+		record.bowOrientation[j]=(float)rawSensorData.bowSensOrientation[iViolin](j,0);
+	}
+	for (int k=0;k<trackerCalibDataSize;k++)
+		record.keyPoints[k]=betas[k];
+	record.playedString=playedString;
+	record.bowForceLhs=(float)descriptors.bowForceLhs;
+	record.bowForceRhs=(float)descriptors.bowForceRhs;
+	record.bowForce=(float)descriptors.bowForce;
+	record.bowDisplacement=(float)descriptors.bowDisplacement;
+	record.bowBridgeDistance=(float)descriptors.bowBridgeDistance;
+	record.stickBridgeDistance=(float)descriptors.stickBridgeDistance;
+	record.bowVel=(float)descriptors.bowVel;
+	record.bowAccel=(float)descriptors.bowAccel;
+	for (int i=0;i<N_DESC;i++)
+	{
+		const Atom &a=compDescfrom6DOF->desc[i];
+		record.descriptors[i]=(a.a_type==A_LONG) ? (float)a.a_w.w_long : (a.a_type==A_FLOAT) ? a.a_w.w_float : 0.0f;
+	}
+	compDescfrom6DOF->ringWriter->publish();
+}
+
+// Sets the task interval in ms (only used in SCHEDULE_PERIODIC mode).
+void compDescfrom6DOF_sampleRate(t_compDescfrom6DOF *compDescfrom6DOF, double sr)
+{
+	compDescfrom6DOF->clock_compDesc_Delay=sr;
+}
+
+void compDescfrom6DOF_schedule(t_compDescfrom6DOF *compDescfrom6DOF, long mode)
+{
+	if (mode!=SCHEDULE_PERIODIC && mode!=SCHEDULE_ON_FRAME)
+	{
+		post("schedule must be 0 (periodic) or 1 (on frame)");
+		return;
+	}
+	compDescfrom6DOF->scheduleMode=mode;
+	compDescfrom6DOF->batchBound=1;
+	if (compDescfrom6DOF->verbose)
+		post("schedule=%s", (mode==SCHEDULE_ON_FRAME) ? "on frame" : "periodic");
+
+	// Restart the task with the new schedule:
+	if (trackerState_!=TRACKER_DISCONNECTED)
+		clock_fdelay(compDescfrom6DOF->m_clock_compDesc, (mode==SCHEDULE_ON_FRAME) ? 0 : compDescfrom6DOF->clock_compDesc_Delay);
+}
+
+void compDescfrom6DOF_maxBatch(t_compDescfrom6DOF *compDescfrom6DOF, long maxFrames)
+{
+	compDescfrom6DOF->maxBatchBound=MAX(maxFrames, 1);
+	compDescfrom6DOF->batchBound=MIN(compDescfrom6DOF->batchBound, compDescfrom6DOF->maxBatchBound);
+}
+
+// Number of frames to process in the current task call. In periodic mode all available 
+// frames are processed. In event-driven mode the bound doubles while a backlog builds up 
+// (amortizing task overhead under load) and halves again once it drains, so under light 
+// load each frame is processed on its own as soon as it arrives.
+int computeBatchSize(t_compDescfrom6DOF *compDescfrom6DOF, int numAvailFrames)
+{
+	if (compDescfrom6DOF->scheduleMode==SCHEDULE_PERIODIC)
+		return numAvailFrames;
+
+	if (numAvailFrames > compDescfrom6DOF->batchBound)
+		compDescfrom6DOF->batchBound=MIN(compDescfrom6DOF->batchBound*2, compDescfrom6DOF->maxBatchBound);
+	else if (numAvailFrames*4 <= compDescfrom6DOF->batchBound)
+		compDescfrom6DOF->batchBound=MAX(compDescfrom6DOF->batchBound/2, 1);
+
+	return MIN(numAvailFrames, compDescfrom6DOF->batchBound);
+}
+
+void compDescfrom6DOF_dsp(t_compDescfrom6DOF *compDescfrom6DOF, t_signal **sp, short *count)
+{/*The first parameter in dsp_add() is the name of your perform method, the second
+number indicates the number of arguments in the perform method, followed by the
+arguments, all of which must be the size of a pointer or a long and appears in your
+perform method as an array of t_int. The second parameter passed to the dsp
+method, t_signal **sp, is an array of pointers to struct t_signal
+ */
+	post("compDescfrom6DOF~ sr: %f", sp[0]->s_sr);
+	post("compDescfrom6DOF~ size of buffer: %d", sp[0]->s_n);
+	//sp[0]->s_sr=240;
+	//sp[0]->s_n=240;
+	// sp: inlet, descriptor signal outlets, pass through outlet
+	const int numSignals=(compDescfrom6DOF->signalUpsampler!=NULL) ? compDescfrom6DOF->signalUpsampler->getNumSignals() : 0;
+	void *args[4+MAX_NUM_VIOLINS*DescriptorSignalFrame::NUM_SIGNALS];
+	args[0]=compDescfrom6DOF;
+	args[1]=sp[0]->s_vec;
+	args[2]=sp[1+numSignals]->s_vec;
+	args[3]=(void *)sp[0]->s_n;
+	for (int i=0;i<numSignals;i++)
+		args[4+i]=sp[1+i]->s_vec;
+	if (compDescfrom6DOF->signalUpsampler!=NULL)
+		compDescfrom6DOF->signalUpsampler->setSampleRate(sp[0]->s_sr);
+	dsp_addv(compDescfrom6DOF_perform, 4+numSignals, args);
+		 //3, sp[0]->s_vec, sp[1]->s_vec, sp[0]->s_n);
+}
+
+
+t_int *compDescfrom6DOF_perform(t_int *w)
+{
+	t_compDescfrom6DOF *compDescfrom6DOF = (t_compDescfrom6DOF *)(w[1]);
+    t_float *in = (t_float *)(w[2]);
+    t_float *out = (t_float *)(w[3]);
+    int n = (int)(w[4]);
+	int numSignals=0;
+	int m=n;
+	t_float *auxIn=in;
+	while (m--)
+		*out++ = *in++;
+	//post("llamando perform");
+	if(trackerState_ == TRACKER_RECORDING || (isHistoryEnabled_ && trackerState_ == TRACKER_CONNECTED))
+	{
+		// Send to history buffer:
+		//post("recording audioBuffer");
+		int result=audioCh1Writer_->writeData(auxIn, n); //audioBuffer.getSampleData(0), audioBuffer.getNumSamples());
+		//post("result=%d",result);
+		if (result==0) 
+			post("data not correctly saved");
+	}
+	// Descriptor signals (after the pass through, outlets may share the inlet's vector):
+	if (compDescfrom6DOF->signalUpsampler!=NULL)
+	{
+		numSignals=compDescfrom6DOF->signalUpsampler->getNumSignals();
+		compDescfrom6DOF->signalUpsampler->process((float **)(w + 5), n);
+	}
+
+	return(w + 5 + numSignals); // always add one more than the 2nd argument in dsp_add()
+}
+
+//function that will do something when the clock is executed
+void compDescfrom6DOF_task(t_compDescfrom6DOF *compDescfrom6DOF)
+{		
+	applyPendingOutputChanges(compDescfrom6DOF);
+	if (compDescfrom6DOF->oscReceiver!=NULL && compDescfrom6DOF->oscReceiver->isRunning())
+		readOscReceiverFrames(compDescfrom6DOF);
+
+	const int numTrackerItems = compDescfrom6DOF->circularBuffer->getCount(); //tracker_.queryFrames(beginBuffer);
+	const int numTrackerSensors =numViolins_*2; //tracker_.getNumEnabledSensors(); // num items per frame
+	const int numAvailFrames =  numTrackerItems/numTrackerSensors;
+	const int readIdx=compDescfrom6DOF->circularBuffer->getRIdx();
+	const int bufferSize=compDescfrom6DOF->circularBuffer->getSize();
+
+	if (trackerState_==TRACKER_DISCONNECTED) return; //(compDescfrom6DOF->running==false) return;
+	if (numAvailFrames==0)
+	{
+		if (compDescfrom6DOF->scheduleMode==SCHEDULE_PERIODIC)
+			clock_fdelay(compDescfrom6DOF->m_clock_compDesc, compDescfrom6DOF->clock_compDesc_Delay); //schedule the clock again
+		//post("No data found in buffer");
+		return;
+	}
+	const int numTrackerFrames = computeBatchSize(compDescfrom6DOF, numAvailFrames);
+
+	// Derivative rate: frames are consecutive tracker frames in both scheduling modes (the 
+	// batch size doesn't scale the derivatives).
+	const float derivativeRate = (float)trackerSampleRate;
+
+	const bool isBufferSinkEnabled=compDescfrom6DOF->isBufferSinkEnabled;
+	if (isBufferSinkEnabled)
+		bindBufferSink(compDescfrom6DOF);
+
+	computeDescriptors_.setDerived3dFields(compDescfrom6DOF->derived3dFields); // (computeDescriptors_ is shared by the instances)
+	ViolinPerformanceDescriptors descriptors;
+	TrackerSampleIterator beginBuffer(compDescfrom6DOF->circularBuffer->cbGetBuffer(), readIdx, bufferSize);
+	//advance circular buffer (frames are then read in place through beginBuffer, without copies)
+	compDescfrom6DOF->circularBuffer->cbSkip(numTrackerFrames*numTrackerSensors);
+	compDescfrom6DOF->numFramesProcessed+=numTrackerFrames;
+
+	//if (trackerState_==TRACKER_RECORDING)
+	//{
+	//	//call function to record polhemus
+	//	sendTrackerDataToHistoryBuffer(beginBuffer, numTrackerFrames, numTrackerSensors);
+	//}
+
+	for (int i = 0; i < numTrackerFrames; ++i)
+	//	int i=numTrackerFrames-1;
+	{
+		// Compute 'raw' descriptors for current frame:
+		computeDescriptors_.trackerDataToRawSensorData(beginBuffer,numViolins_,rawSensorData);
+
+		if (trackerState_==TRACKER_RECORDING || (isHistoryEnabled_ && trackerState_==TRACKER_CONNECTED))
+		{
+			//call function to record polhemus
+			//sendTrackerDataToHistoryBuffer(beginBuffer, numTrackerFrames, numTrackerSensors);
+			// Send current frame to history buffer
+			sendTrackerDataToHistoryBufferSingleFrame(rawSensorData);
+		}
+		//bool useAutoString=true;
+		bool isCalibratingForce=false;
+		bool isAutoStringEnabled_=true;
+		CalibrationAngles anglesCalibration_; //anglesCalibration_ NOT USED ANYMORE. TODO:remove it
+		
+		for (int iViolin=0; iViolin<numViolins_; iViolin++)
+		{
+			Derived3dData derived3dData = computeDescriptors_.computeDerived3dData(rawSensorData, trackerCalibration_, isAutoStringEnabled_, anglesCalibration_, isCalibratingForce, NULL, iViolin);
+			// XXX: above descriptors are computed twice
+			descriptors = computeDescriptors_.computeViolinPerformanceDescriptors(rawSensorData, derived3dData, true, numViolins_, iViolin, false, derivativeRate);
+
+			//Compute descriptors. Do it for all received frames??
+			float bowVelSmooth, bowAccelSmooth;
+			float forceCorrected=0.0f;
+			const float bowDisplacement=(float)descriptors.bowDisplacement;
+			if (compDescfrom6DOF->estimatorMode==ESTIMATOR_KALMAN)
+			{
+				// (frames are consecutive tracker frames, also in periodic mode)
+				const bool isBowOnString=derived3dData.isInterRefLhsInsideStringAndBow || derived3dData.isInterRefRhsInsideStringAndBow;
+				processBowKalman(compDescfrom6DOF->bowKalman_[iViolin], isBowOnString, bowDisplacement, 1.0/trackerSampleRate, bowVelSmooth, bowAccelSmooth);
+			}
+			else
+				compDescfrom6DOF->bowDerivatives_.process(&bowDisplacement, derivativeRate, &bowVelSmooth, &bowAccelSmooth);
+			for(int i=0;i<N_DESC;i++)
+			{				
+				if (!strcmp(pDescNames[i],"string"))
+					SETLONG(&compDescfrom6DOF->desc[i], (long)derived3dData.playedString);
+				else if (!strcmp(pDescNames[i],"position"))
+					SETFLOAT(&compDescfrom6DOF->desc[i],descriptors.bowDisplacement);
+				else if (!strcmp(pDescNames[i],"bbd"))
+					SETFLOAT(&compDescfrom6DOF->desc[i],descriptors.bowBridgeDistance);
+				else if (!strcmp(pDescNames[i],"vel"))
+					SETFLOAT(&compDescfrom6DOF->desc[i], bowVelSmooth);
+				else if (!strcmp(pDescNames[i],"acc"))
+					SETFLOAT(&compDescfrom6DOF->desc[i], bowAccelSmooth);
+				else if (!strcmp(pDescNames[i],"force")) 
+				{
+					correctBowForce(&descriptors.bowForce, &descriptors.bowDisplacement, &forceCorrected, 1);
+					SETFLOAT(&compDescfrom6DOF->desc[i], forceCorrected);
+					for (int j=0;j<FORCE_BUFF+FORCE_BUFF_DELAY;j++)
+					{
+						compDescfrom6DOF->forceBuffer[j]=compDescfrom6DOF->forceBuffer[j]+1;
+					}
+					compDescfrom6DOF->forceBuffer[FORCE_BUFF+FORCE_BUFF_DELAY]=forceCorrected; //descriptors.bowForce;
+				}
+				//outlet_float(compDescfrom6DOF->desc_out[i], compDescfrom6DOF->desc[i]);
+				if (compDescfrom6DOF->descResampler[iViolin]==NULL && !isBufferSinkEnabled)
+					outlet_list(compDescfrom6DOF->descInst_out[iViolin], (t_symbol *)"list", N_DESC, compDescfrom6DOF->desc);
+			}
+			if (compDescfrom6DOF->descResampler[iViolin]!=NULL && !isBufferSinkEnabled)
+				outputResampledDescriptors(compDescfrom6DOF, iViolin);
+			if (compDescfrom6DOF->signalUpsampler!=NULL && iViolin<compDescfrom6DOF->signalUpsampler->getNumViolins())
+			{
+				DescriptorSignalUpsampler *signals=compDescfrom6DOF->signalUpsampler;
+				signals->setValue(iViolin, DescriptorSignalFrame::VEL, bowVelSmooth);
+				signals->setValue(iViolin, DescriptorSignalFrame::FORCE, forceCorrected);
+				signals->setValue(iViolin, DescriptorSignalFrame::BBD, (float)descriptors.bowBridgeDistance);
+				signals->setValue(iViolin, DescriptorSignalFrame::POSITION, bowDisplacement);
+			}
+			//transformed Betas		
+			float betas[trackerCalibDataSize];
+			getTransformedBetas(derived3dData, betas);
+			if (compDescfrom6DOF->ringWriter!=NULL)
+				publishFrameToRing(compDescfrom6DOF, iViolin, beginBuffer.item().frameCount, derived3dData.playedString, descriptors, betas);
+			if (isBufferSinkEnabled)
+				writeFrameToBufferSink(compDescfrom6DOF, iViolin, betas);
+			else
+			{
+				for (int k=0;k<trackerCalibDataSize;k++)
+					SETFLOAT(&compDescfrom6DOF->transformedBetas[k], betas[k]);
+				outlet_list(compDescfrom6DOF->transformedBetas_out[iViolin], (t_symbol *)"list", trackerCalibDataSize, compDescfrom6DOF->transformedBetas);
+			}
+		} 
+		if (compDescfrom6DOF->signalUpsampler!=NULL)
+			compDescfrom6DOF->signalUpsampler->postFrame();
+		if (isBufferSinkEnabled)
+			compDescfrom6DOF->bufferSinkFrameCount++;
+		// Next frame:
+		beginBuffer.advance(numTrackerSensors);
+	}
+	if (isBufferSinkEnabled)
+	{
+		releaseBufferSink(compDescfrom6DOF);
+		if (compDescfrom6DOF->bufferSinkPos_out!=NULL)
+			outlet_int(compDescfrom6DOF->bufferSinkPos_out, (long)compDescfrom6DOF->bufferSinkFrameCount);
+	}
+	//post("task done....");
+	if (trackerState_==TRACKER_CONNECTED || trackerState_==TRACKER_RECORDING) //compDescfrom6DOF->running==true)
+	{
+		if (compDescfrom6DOF->scheduleMode==SCHEDULE_PERIODIC)
+			clock_fdelay(compDescfrom6DOF->m_clock_compDesc, compDescfrom6DOF->clock_compDesc_Delay); //schedule the clock again
+		else if (numAvailFrames > numTrackerFrames)
+			clock_fdelay(compDescfrom6DOF->m_clock_compDesc, 0); // drain remaining backlog on next scheduler pass
+	}
+}
+
+
+// Frames where the bow is more than distanceCm away from the strings (bounding boxes) 
+// skip the geometry and force computations and output as not played (0, the default, 
+// disables it). 
+// Posts the number of frames gated so far.
+void compDescfrom6DOF_contactGate(t_compDescfrom6DOF *compDescfrom6DOF, double distanceCm)
+{
+	computeDescriptors_.setContactGateDistance(MAX(distanceCm, 0.0));
+	post("contactGate=%.1f cm (%lu frames gated)", computeDescriptors_.getContactGateDistance(), computeDescriptors_.getNumGatedFrames());
+}
+
+// Derived3dData fields the task computes for this instance (Derived3dData::Field bits, e.g. 
+// 2 for the visualization frames) in addition to the ones it outputs (wood points and 
+// descriptor inputs, always computed). 0 computes only those, -1 all.
+void compDescfrom6DOF_fields(t_compDescfrom6DOF *compDescfrom6DOF, long fields)
+{
+	compDescfrom6DOF->derived3dFields=((unsigned int)fields | TASK_DERIVED3D_FIELDS) & Derived3dData::ALL_FIELDS;
+	if (compDescfrom6DOF->verbose)
+		post("fields=%u", compDescfrom6DOF->derived3dFields);
+}
+
+// Counts the heap allocations of numCycles start/stop and take changes (the buffer 
+// preparation of compDescfrom6DOF_start() and compDescfrom6DOF_startRecording(), after a 
+// first cycle that may allocate for a new configuration), which should be 0. Needs a debug 
+// build or COUNT_ALLOCATIONS, only allocations of the calling thread are counted (such 
+// builds also check every preparation, see prepareRecordingWriters()).
+void compDescfrom6DOF_allocationCheck(t_compDescfrom6DOF *compDescfrom6DOF, long numCycles)
+{
+#ifdef IS_COUNTING_ALLOCATIONS
+	if (trackerState_!=TRACKER_CONNECTED)
+	{
+		post("allocationCheck: needs a started object that is not recording");
+		return;
+	}
+	numCycles=MAX(numCycles, 1);
+
+	long numAllocations=0;
+	for (long i=0;i<=numCycles;i++)
+	{
+		ScopedAllocationCount allocationCount;
+		compDescfrom6DOF->circularBuffer->cbResize(getCircularBufferSize(compDescfrom6DOF, numViolins_));
+		prepareRecordingWriters(compDescfrom6DOF);
+		compDescfrom6DOF->circularBuffer->resetIdxs();
+		if (i>0)
+			numAllocations+=allocationCount.getCount();
+	}
+
+	post("allocationCheck: %ld allocations in %ld start/stop and take cycles", numAllocations, numCycles);
+#else
+	post("allocationCheck: needs a debug build (allocation hook) or COUNT_ALLOCATIONS");
+#endif
+}
+
+// Compares the block rotations of computeSensorRotations() (eulerZyxToRotationMatrices(), 
+// eulerZyxToQuaternions() and transpose() as inverse) with Matrix3x3::rotation_matrix_zyx() 
+// and inverse() of each sensor, on random euler angles: for numSensors sensors and for counts 
+// around EULER_BLOCK_SIZE (partial last blocks). Posts the max. absolute error of the matrix 
+// elements (and of the quaternion norms), and the number of rotations written past the 
+// count, which should be 0. Blocks the scheduler while running.
+void compDescfrom6DOF_rotationCheck(t_compDescfrom6DOF *compDescfrom6DOF, long numSensors)
+{
+	const double pi=3.1415926535897932384626433832795;
+	numSensors=MIN(MAX(numSensors, 1), ROTATION_CHECK_MAX_SENSORS);
+	const int counts[]={1, EULER_BLOCK_SIZE-1, EULER_BLOCK_SIZE, EULER_BLOCK_SIZE+1, 3*EULER_BLOCK_SIZE+5, (int)numSensors};
+	const int numCounts=sizeof(counts)/sizeof(counts[0]);
+	const int maxCount=MAX((int)numSensors, 3*EULER_BLOCK_SIZE+5);
+
+	std::vector<Matrix3x1> angles(maxCount);
+	std::vector<Matrix3x3> rotations(maxCount+1); // (+1: written past the count)
+	std::vector<Quaternion> quaternions(maxCount+1);
+	const Matrix3x3 unwritten(2.0, 2.0, 2.0, 2.0, 2.0, 2.0, 2.0, 2.0, 2.0);
+
+	double maxErrorMatrix=0.0;
+	double maxErrorQuaternion=0.0;
+	double maxErrorNorm=0.0;
+	double maxErrorInverse=0.0;
+	long numWritesPastCount=0;
+	long numRotations=0;
+	for (int k=0;k<numCounts;k++)
+	{
+		const int n=counts[k];
+		for (int i=0;i<n;i++)
+		{
+			angles[i]=Matrix3x1(pi*(2.0*rand()/RAND_MAX-1.0), pi*(2.0*rand()/RAND_MAX-1.0), pi*(2.0*rand()/RAND_MAX-1.0));
+		}
+		rotations[n]=unwritten;
+		quaternions[n].w=2.0;
+
+		eulerZyxToRotationMatrices(&angles[0], n, &rotations[0]);
+		eulerZyxToQuaternions(&angles[0], n, &quaternions[0]);
+
+		if (maxAbsDifference(rotations[n], unwritten)!=0.0)
+			numWritesPastCount++;
+		if (quaternions[n].w!=2.0)
+			numWritesPastCount++;
+
+		for (int i=0;i<n;i++)
+		{
+			const Matrix3x3 reference=Matrix3x3::rotation_matrix_zyx(angles[i](0, 0), angles[i](1, 0), angles[i](2, 0));
+			const Quaternion &q=quaternions[i];
+			maxErrorMatrix=MAX(maxErrorMatrix, maxAbsDifference(rotations[i], reference));
+			maxErrorQuaternion=MAX(maxErrorQuaternion, maxAbsDifference(rotation_matrix(q), reference));
+			maxErrorNorm=MAX(maxErrorNorm, fabs(q.w*q.w+q.x*q.x+q.y*q.y+q.z*q.z-1.0));
+			maxErrorInverse=MAX(maxErrorInverse, maxAbsDifference(transpose(rotations[i]), inverse(reference)));
+		}
+		numRotations+=n;
+	}
+
+	post("rotationCheck: %ld rotations (counts 1, %d, %d, %d, %d, %ld), %ld written past the count", 
+		numRotations, EULER_BLOCK_SIZE-1, EULER_BLOCK_SIZE, EULER_BLOCK_SIZE+1, 3*EULER_BLOCK_SIZE+5, numSensors, numWritesPastCount);
+	post("  matrices: max. error %g", maxErrorMatrix);
+	post("  quaternions: max. error %g (norm %g)", maxErrorQuaternion, maxErrorNorm);
+	post("  transpose vs. inverse: max. error %g", maxErrorInverse);
+}
+
+// Largest absolute difference of the elements of two 3x3 matrices:
+double maxAbsDifference(const Matrix3x3 &a, const Matrix3x3 &b)
+{
+	double result=0.0;
+	for (int i=0;i<3;i++)
+	{
+		for (int j=0;j<3;j++)
+			result=MAX(result, fabs(a(i, j)-b(i, j)));
+	}
+	return result;
+}
+
+void sendTrackerDataToHistoryBuffer(TrackerSampleIterator iter, int numTrackerFrames, int numTrackerSensors)
+{
+	RawSensorData rawSensorData;
+
+	// Process tracker frames:
+	for (int i = 0; i < numTrackerFrames; ++i)
+	{
+		// Compute 'raw' descriptors for current frame:
+		computeDescriptors_.trackerDataToRawSensorData(iter, numViolins_, rawSensorData);
+
+		// Compute frame count of frame:
+		frameCount = iter.item().frameCount; // don't offset first frame to avoid not having a lhs frame for interpolation
+
+		bool dropCurFrame = false;
+
+
+		// Use current frame if it's not dropped:
+		if (!dropCurFrame)
+		{
+			// Send current frame to history buffer
+			sendTrackerDataToHistoryBufferSingleFrame(rawSensorData);
+		}
+
+		// Next frame:
+		iter.advance(numTrackerSensors);
+	}
+}
+
+// Writes one tracker frame of all numViolins_ instruments (numItemsPerFrameQualisys items 
+// per violin, the frame size of trackerWriter_, see prepareRecordingWriters()).
+void sendTrackerDataToHistoryBufferSingleFrame(const RawSensorData &frame)
+{
+	static float trackerFrame[numItemsPerFrameQualisys*MAX_NUM_VIOLINS];
+
+	for (int v=0;v<numViolins_;v++)
+	{
+		float *slot=&trackerFrame[v*numItemsPerFrameQualisys];
+
+		// sensor 1 (violin body):
+		slot[0] = (float)frame.violinBodySensPos[v](0, 0);
+		slot[1] = (float)frame.violinBodySensPos[v](1, 0);
+		slot[2] = (float)frame.violinBodySensPos[v](2, 0);
+		slot[3] = (float)frame.violinBodySensOrientation[v](0, 0);
+		slot[4] = (float)frame.violinBodySensOrientation[v](1, 0);
+		slot[5] = (float)frame.violinBodySensOrientation[v](2, 0);
+
+		// sensor 2 (bow):
+		slot[6] = (float)frame.bowSensPos[v](0, 0);
+		slot[7] = (float)frame.bowSensPos[v](1, 0);
+		slot[8] = (float)frame.bowSensPos[v](2, 0);
+		slot[9] = (float)frame.bowSensOrientation[v](0, 0);
+		slot[10] = (float)frame.bowSensOrientation[v](1, 0);
+		slot[11] = (float)frame.bowSensOrientation[v](2, 0);
+	}
+
+	int n=trackerWriter_->writeData(trackerFrame, numItemsPerFrameQualisys*numViolins_); // (internally checks and logs if not all of the requested items could be written)
+	int a=n;// Note: Write entire frame as a single atomic operation.
+}
+
+void compDescfrom6DOF_setDir(t_compDescfrom6DOF *compDescfrom6DOF, Symbol *s)
+{
+	strcpy(compDescfrom6DOF->baseDir,s->s_name);
+	if (compDescfrom6DOF->verbose)
+		post("dirBase=%s",compDescfrom6DOF->baseDir);	
+}
+
+void compDescfrom6DOF_setScoreName(t_compDescfrom6DOF *compDescfrom6DOF, Symbol *s)
+{
+	strcpy(compDescfrom6DOF->scoreName,s->s_name);
+	if (compDescfrom6DOF->verbose)
+		post("scoreName=%s",compDescfrom6DOF->scoreName);	
+}
+
+void compDescfrom6DOF_setTake(t_compDescfrom6DOF *compDescfrom6DOF, long ntake)
+{
+	compDescfrom6DOF->ntake=ntake;
+}
+
+void compDescfrom6DOF_setCalibFileName(t_compDescfrom6DOF *compDescfrom6DOF, Symbol *s)
+{
+	strcpy(compDescfrom6DOF->calibFileName, s->s_name);
+	if (compDescfrom6DOF->verbose)
+		post("calibFileName=%s",compDescfrom6DOF->calibFileName);	
+}
+
+void computeSmoothingCoeffs(float *coeffs, int size)
+{
+	// compute gaussian window for n points:
 	computeGaussWindow(coeffs, size);
 
 	// scale so coefficients sum to unity:
@@ -811,9 +2740,4 @@ void initSmoothingFilter(FilterFir &filter, int size)
 		sum += coeffs[i];
 	for (int i = 0; i < size; ++i)
 		coeffs[i] /= sum;
-
-	// init fir filter:
-	filter.init(coeffs, size); // copies coeffs to internal memory
-
-	delete[] coeffs;
 }
@@ -69,10 +69,14 @@ private:
 // ---------------------------------------------------------------------------------------
 
 #include <cassert>
+#include <cstring>
 #include "concat/Utilities/StdInt.hxx"
+#include "MirroredRingMemory.hxx"
 
 // utility class to read serial port into
 // can be access using circular iterator
+// the buffer is mirrored if possible (see MirroredRingMemory), then bytes past the end 
+// of the buffer continue at its start, so iterator accesses and port reads don't wrap
 class ComPortReadBuffer
 {
 public:
@@ -86,20 +90,16 @@ public:
 
 		const concat::byte operator[](int index) const
 		{
-			assert(index >= 0);
-			assert(index < size_);
-			int i = offset_ + index;
-			if (i >= size_)
-				i -= size_;
-			return base_[i];
+			return *getPtrAt(index);
 		}
 
+		// if mirrored, the size_ - index bytes from the result on are contiguous
 		const concat::byte *getPtrAt(int index) const
 		{
 			assert(index >= 0);
 			assert(index < size_);
 			int i = offset_ + index;
-			if (i >= size_)
+			if (i >= size_ && !isMirrored_)
 				i -= size_;
 			return &base_[i];
 		}
@@ -112,6 +112,11 @@ public:
 		concat::uint32_t getUint32At(int indexBytes) const
 		{
 			concat::uint32_t result = 0;
+			if (isMirrored_)
+			{
+				std::memcpy(&result, getPtrAt(indexBytes), sizeof(result));
+				return result;
+			}
 			concat::byte *tmp = (concat::byte *)(&result);
 			tmp[0] = (*this)[indexBytes + 0];
 			tmp[1] = (*this)[indexBytes + 1];
@@ -124,6 +129,11 @@ public:
 		concat::int16_t getInt16At(int indexBytes) const
 		{
 			concat::int16_t result = 0;
+			if (isMirrored_)
+			{
+				std::memcpy(&result, getPtrAt(indexBytes), sizeof(result));
+				return result;
+			}
 			concat::byte *tmp = (concat::byte *)(&result);
 			tmp[0] = (*this)[indexBytes + 0];
 			tmp[1] = (*this)[indexBytes + 1];
@@ -143,6 +153,7 @@ public:
 		concat::byte *base_;
 		int offset_;
 		int size_;
+		bool isMirrored_;
 
 	private:
 		Iterator()
@@ -150,9 +161,10 @@ public:
 			base_ = NULL;
 			offset_ = 0;
 			size_ = 0;
+			isMirrored_ = false;
 		}
 
-		void assign(concat::byte *base, int offset, int size)
+		void assign(concat::byte *base, int offset, int size, bool isMirrored)
 		{
 			assert(base != NULL);
 			assert(offset >= 0);
@@ -161,6 +173,7 @@ public:
 			base_ = base;
 			offset_ = offset;
 			size_ = size;
+			isMirrored_ = isMirrored;
 		}
 
 		void advance(int n)
@@ -194,27 +207,28 @@ public:
 		bufferSize_ = 0;
 	}
 
+	// (bufferSize is rounded up to the MirroredRingMemory granularity)
 	void attach(ComPort &comPort, int bufferSize)
 	{
-		delete[] buffer_;
+		memory_.release();
 		buffer_ = NULL;
 		bufferSize_ = 0;
 
 		comPort_ = &comPort;
 
-		if (bufferSize > 0)
+		if (bufferSize > 0 && memory_.allocate(bufferSize))
 		{
-			buffer_ = new concat::byte[bufferSize];
-			bufferSize_ = bufferSize;
+			buffer_ = (concat::byte *)memory_.getPtr();
+			bufferSize_ = (int)memory_.getSize();
 
-			readIter_.assign(buffer_, 0, bufferSize_);
-			writeIter_.assign(buffer_, 0, bufferSize_);
+			readIter_.assign(buffer_, 0, bufferSize_, memory_.isMirrored());
+			writeIter_.assign(buffer_, 0, bufferSize_, memory_.isMirrored());
 		}
 	}
 
 	~ComPortReadBuffer()
 	{
-		delete[] buffer_;
+		memory_.release();
 		buffer_ = NULL;
 		bufferSize_ = 0;
 	}
@@ -256,7 +270,7 @@ public:
 			toRead = maxWrite;
 
 		const int endRead = writeIter_.getOffset() + toRead;
-		if (endRead > bufferSize_)
+		if (endRead > bufferSize_ && !memory_.isMirrored())
 		{
 			// Wrapped read/write:
 			const int n1 = bufferSize_ - writeIter_.getOffset();
@@ -304,7 +318,7 @@ public:
 		}
 		else
 		{
-			// Single read/write:
+			// Single read/write (mirrored: may continue in the mirror):
 			const int n = endRead - writeIter_.getOffset();
 			assert(n >= 0);
 			comPort_->readBlocking(writeIter_.getPtr(), n);
@@ -361,7 +375,8 @@ public:
 private:
 	ComPort *comPort_;
 
-	concat::byte *buffer_;
+	MirroredRingMemory memory_;
+	concat::byte *buffer_; // (memory_)
 	int bufferSize_;
 	Iterator readIter_;
 	Iterator writeIter_;
@@ -46,7 +46,7 @@ inline Matrix3x1 computeBeta(const Matrix3x1 &point, const Matrix3x1 &refSensPos
 {
 	Matrix3x1 result;
 	Matrix3x3 rot = Matrix3x3::rotation_matrix_zyx(refSensOrientation(0, 0), refSensOrientation(1, 0), refSensOrientation(2, 0));
-	Matrix3x3 invRot = inverse(rot);
+	Matrix3x3 invRot = transpose(rot); // (inverse of a rotation)
 	result = invRot*(point - refSensPos);
 	return result;
 }
@@ -12,6 +12,8 @@
 
 #include <algorithm> // min()/max()
 
+#include "MirroredRingMemory.hxx"
+
 // Single reader, single writer, lock-free FIFO class (implemented as a circular buffer, using Win32 API), 
 // adapted from example by gasm.
 //
@@ -36,6 +38,11 @@
 // When trying to write when the buffer is full, no data will be written (until data is read).
 // When trying to read when the buffer is empty, no data will be read (until data is written).
 //
+// Mirroring:
+// With reserveMirrored() the elements are stored in MirroredRingMemory, so the array put()/get() 
+// copy in one go across the wrap point and a reader can consume elements in place 
+// (getReadPtr()/advanceReadIdx()), e.g. to write them to a file without an intermediate copy.
+//
 // Limitations:
 // The source/destination of writes/reads can only be other memory, not e.g. a file on disk.
 template<typename Ty>
@@ -46,7 +53,9 @@ public:
 	~LockFreeFifo();
 
 	void reserve(int capacity); // actual capacity will be capacity - 1 (see above)
+	void reserveMirrored(int capacity); // actual capacity will be at least capacity - 1
 	int getCapacity() const; // returns actual capacity
+	bool isMirrored() const { return mirroredMemory_.isMirrored(); }
 
 	void clearBySettingToZero();
 	void clearBySettingReadIdxToWriteIdx();
@@ -72,6 +81,11 @@ public:
 
 	void decreaseReadIdx(LONG n);
 
+	// Reading in place (mirrored FIFOs only): the getReadAvail() elements from the read 
+	// index on are contiguous at getReadPtr(), advanceReadIdx() consumes them.
+	const Ty *getReadPtr() const;
+	void advanceReadIdx(LONG n);
+
 private:
 	volatile LONG *writeIdx_;
 	volatile LONG *readIdx_;
@@ -79,6 +93,8 @@ private:
 	// interlocked API (doesn't consider sign bit and must be volatile).
 
 	std::vector<Ty> buffer_;
+	MirroredRingMemory mirroredMemory_;
+	Ty *data_; // buffer_ or mirroredMemory_
 	LONG size_;
 
 	LockFreeFifo(const LockFreeFifo &); // non-copyable
@@ -103,6 +119,7 @@ LockFreeFifo<Ty>::LockFreeFifo()
 
 	// Initialize to empty:
 	clearBySettingToZero();
+	data_ = NULL;
 	size_ = 0;
 }
 
@@ -129,14 +146,47 @@ void LockFreeFifo<Ty>::reserve(int capacity)
 	
 	clearBySettingToZero();
 	buffer_.clear();
+	mirroredMemory_.release();
 
 	buffer_.reserve(capacity);
 	if (capacity > 0)
 		buffer_.insert(buffer_.end(), capacity, Ty());
 	
+	data_ = buffer_.empty() ? NULL : &buffer_[0];
 	size_ = (LONG)buffer_.size();
 }
 
+// Same as reserve(), but mirrored (see above) if possible, otherwise falls back to reserve().
+// The size is rounded up to whole granules of MirroredRingMemory holding whole elements 
+// (so the mirror starts at an element boundary), so the capacity may be bigger than 
+// requested. Only for plain data types: the elements are zero-filled, not constructed.
+template<typename Ty>
+void LockFreeFifo<Ty>::reserveMirrored(int capacity)
+{
+	assert(capacity >= 0);
+	reserve(0);
+	if (capacity <= 0)
+		return;
+
+	// Smallest block of granules that holds a whole number of elements:
+	const size_t granularity = MirroredRingMemory::getGranularity();
+	size_t numGranules = 1;
+	while (((numGranules*granularity) % sizeof(Ty)) != 0 && numGranules < 16)
+		++numGranules;
+	const size_t blockSize = numGranules*granularity;
+	const size_t numBlocks = ((size_t)capacity*sizeof(Ty) + blockSize - 1)/blockSize;
+
+	if ((blockSize % sizeof(Ty)) != 0 || !mirroredMemory_.allocate(numBlocks*blockSize) || !mirroredMemory_.isMirrored())
+	{
+		// (element size too odd, or no mirroring)
+		reserve(capacity);
+		return;
+	}
+
+	data_ = (Ty *)mirroredMemory_.getPtr();
+	size_ = (LONG)(mirroredMemory_.getSize()/sizeof(Ty));
+}
+
 template<typename Ty>
 int LockFreeFifo<Ty>::getCapacity() const
 {
@@ -179,7 +229,7 @@ int LockFreeFifo<Ty>::put(const Ty &datum, bool always)
 		return 0; // full
 
 	// Put value at current write index:
-	buffer_[(*writeIdx_)] = datum;
+	data_[(*writeIdx_)] = datum;
 
 	// Atomically update write index:
 	::InterlockedExchange(writeIdx_, nextWriteIdx);
@@ -196,7 +246,7 @@ int LockFreeFifo<Ty>::get(Ty &datum)
 		return 0; // empty
 
 	// Get value at current read index:
-	datum = buffer_[(*readIdx_)];
+	datum = data_[(*readIdx_)];
 
 	// Atomically update read index (with wrapping):
 	if (((*readIdx_) + 1) >= size_)
@@ -231,17 +281,17 @@ int LockFreeFifo<Ty>::put(const Ty *data, LONG size)
 	assert(nextWriteIdx >= 0 && nextWriteIdx < size_);
 
 	// Copy data:
-	if (nextWriteIdx >= *writeIdx_)
+	if (nextWriteIdx >= *writeIdx_ || isMirrored())
 	{
-		// Able to do one continuous copy:
-		std::copy(data, data + size, &buffer_[0] + *writeIdx_);
+		// Able to do one continuous copy (mirrored: continues in the mirror):
+		std::copy(data, data + size, data_ + *writeIdx_);
 	}
 	else
 	{
 		// Do wrapped, discontinuous copy in two parts:
 		const LONG n1 = size_ - *writeIdx_;
-		std::copy(data, data + n1, &buffer_[0] + *writeIdx_);
-		std::copy(data + n1, data + size, &buffer_[0]);
+		std::copy(data, data + n1, data_ + *writeIdx_);
+		std::copy(data + n1, data + size, data_);
 	}
 
 	// Atomically update write index:
@@ -272,17 +322,17 @@ int LockFreeFifo<Ty>::get(Ty *data, LONG size)
 	assert(nextReadIdx >= 0 && nextReadIdx < size_);
 
 	// Copy data:
-	if (nextReadIdx >= *readIdx_)
+	if (nextReadIdx >= *readIdx_ || isMirrored())
 	{
-		// Able to do one continuous copy:
-		std::copy(&buffer_[0] + *readIdx_, &buffer_[0] + *readIdx_ + size, data);
+		// Able to do one continuous copy (mirrored: continues in the mirror):
+		std::copy(data_ + *readIdx_, data_ + *readIdx_ + size, data);
 	}
 	else
 	{
 		// Do wrapped, discontinuous copy in two parts:
 		const LONG n1 = size_ - *readIdx_;
-		std::copy(&buffer_[0] + *readIdx_, &buffer_[0] + *readIdx_ + n1, data);
-		std::copy(&buffer_[0], &buffer_[0] + size - n1, data + n1);
+		std::copy(data_ + *readIdx_, data_ + *readIdx_ + n1, data);
+		std::copy(data_, data_ + size - n1, data + n1);
 	}
 
 	// Atomically update read index:
@@ -401,5 +451,27 @@ void LockFreeFifo<Ty>::decreaseReadIdx(LONG n)
 	::InterlockedExchange(readIdx_, newReadIdx);
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+template<typename Ty>
+const Ty *LockFreeFifo<Ty>::getReadPtr() const
+{
+	assert(isMirrored());
+	return data_ + (*readIdx_);
+}
+
+template<typename Ty>
+void LockFreeFifo<Ty>::advanceReadIdx(LONG n)
+{
+	assert(n >= 0 && n <= getReadAvail());
+
+	LONG nextReadIdx = (*readIdx_) + n;
+	if (nextReadIdx >= size_)
+		nextReadIdx -= size_;
+
+	// Atomically update read index:
+	::InterlockedExchange(readIdx_, nextReadIdx);
+}
+
 #endif
 
@@ -0,0 +1,143 @@
+#ifndef INCLUDED_MIRROREDRINGMEMORY_HXX
+#define INCLUDED_MIRROREDRINGMEMORY_HXX
+
+#include <cstddef>
+
+#define NOMINMAX // avoid min/max macros from windows.h
+#define NOGDI // avoid GDI stuff (messes up juce)
+#include <windows.h> // CreateFileMapping(), MapViewOfFileEx(), VirtualAlloc()
+
+// Backing memory for circular buffers (using Win32 API) of which the pages are mapped
+// twice, back-to-back, so byte i and byte i + getSize() are the same byte. Any window of
+// up to getSize() bytes starting inside the buffer is then contiguous in virtual memory,
+// so readers and writers can use plain pointer arithmetic and single copies across the
+// wrap point.
+//
+// The size is rounded up to the allocation granularity (64 kB normally). When the
+// double mapping isn't possible (no free address range, mapping calls failing),
+// allocate() falls back to ordinary memory of the same size, which isn't mirrored (see
+// isMirrored()), so users keep their wrapped copies for that case.
+//
+// Memory is zero-filled, nothing is constructed.
+class MirroredRingMemory
+{
+public:
+	MirroredRingMemory();
+	~MirroredRingMemory();
+
+	static size_t getGranularity();
+
+	bool allocate(size_t minSize); // returns false if no memory at all could be allocated
+	void release();
+
+	void *getPtr() const { return base_; }
+	size_t getSize() const { return size_; }
+	bool isMirrored() const { return isMirrored_; }
+
+private:
+	HANDLE mapping_;
+	char *base_;
+	size_t size_;
+	bool isMirrored_;
+
+	MirroredRingMemory(const MirroredRingMemory &); // non-copyable
+	MirroredRingMemory &operator=(const MirroredRingMemory &); // non-copyable
+};
+
+// ---------------------------------------------------------------------------------------
+
+inline MirroredRingMemory::MirroredRingMemory()
+{
+	mapping_ = NULL;
+	base_ = NULL;
+	size_ = 0;
+	isMirrored_ = false;
+}
+
+inline MirroredRingMemory::~MirroredRingMemory()
+{
+	release();
+}
+
+inline size_t MirroredRingMemory::getGranularity()
+{
+	SYSTEM_INFO info;
+	::GetSystemInfo(&info);
+	return (size_t)info.dwAllocationGranularity;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+inline bool MirroredRingMemory::allocate(size_t minSize)
+{
+	release();
+	if (minSize == 0)
+		return true;
+
+	const size_t granularity = getGranularity();
+	const size_t size = (minSize + granularity - 1)/granularity*granularity;
+
+	mapping_ = ::CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, (DWORD)size, NULL);
+	if (mapping_ != NULL)
+	{
+		// Find a free address range of twice the size and map the pages twice into it.
+		// Another thread may take the range between VirtualFree() and MapViewOfFileEx(),
+		// so retry a few times:
+		for (int attempt = 0; attempt < 8 && base_ == NULL; ++attempt)
+		{
+			char *range = (char *)::VirtualAlloc(NULL, 2*size, MEM_RESERVE, PAGE_NOACCESS);
+			if (range == NULL)
+				break; // no address space
+			::VirtualFree(range, 0, MEM_RELEASE);
+
+			void *first = ::MapViewOfFileEx(mapping_, FILE_MAP_ALL_ACCESS, 0, 0, size, range);
+			void *second = (first != NULL) ? ::MapViewOfFileEx(mapping_, FILE_MAP_ALL_ACCESS, 0, 0, size, range + size) : NULL;
+			if (second != NULL)
+				base_ = range;
+			else if (first != NULL)
+				::UnmapViewOfFile(first);
+		}
+
+		if (base_ == NULL)
+		{
+			::CloseHandle(mapping_);
+			mapping_ = NULL;
+		}
+	}
+
+	if (base_ != NULL)
+	{
+		size_ = size;
+		isMirrored_ = true;
+		return true;
+	}
+
+	// Not mirrored:
+	base_ = (char *)::VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+	if (base_ == NULL)
+		return false;
+	size_ = size;
+	isMirrored_ = false;
+	return true;
+}
+
+inline void MirroredRingMemory::release()
+{
+	if (isMirrored_)
+	{
+		::UnmapViewOfFile(base_);
+		::UnmapViewOfFile(base_ + size_);
+		::CloseHandle(mapping_);
+	}
+	else if (base_ != NULL)
+	{
+		::VirtualFree(base_, 0, MEM_RELEASE);
+	}
+
+	mapping_ = NULL;
+	base_ = NULL;
+	size_ = 0;
+	isMirrored_ = false;
+}
+
+#endif
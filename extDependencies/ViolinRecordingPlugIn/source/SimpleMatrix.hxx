@@ -5,22 +5,32 @@
 #include <cmath>
 
 // ---------------------------------------------------------------------------------------
-// Contains some very simple (and incomplete) classes for doing matrix calculations with 
+// Contains some very simple (and incomplete) classes for doing matrix calculations with
 // 3x1, 3x3 and 4x4 matrices.
+//
+// The classes are templates on the scalar type: Matrix3x1, Matrix3x3 and Matrix4x4 are
+// the double precision matrices used throughout (their memory layout is the plain array
+// of doubles, which is read and written as such), Matrix3x1f, Matrix3x3f and Matrix4x4f
+// are single precision (half the size, twice as many elements per SIMD register; the
+// tracker itself delivers floats). Scalar arguments of the free functions aren't used to
+// deduce the type, so e.g. v/2 or 0.5*v work for both.
 // ---------------------------------------------------------------------------------------
 
-class Matrix3x1
+template <typename T>
+class Matrix3x1T
 {
 public:
-	Matrix3x1()
+	typedef T Scalar;
+
+	Matrix3x1T()
 	{
 	}
 
-	Matrix3x1
+	Matrix3x1T
 		(
-		double v00,
-		double v10,
-		double v20
+		T v00,
+		T v10,
+		T v20
 		)
 	{
 		v_[0][0] = v00;
@@ -28,15 +38,24 @@ public:
 		v_[2][0] = v20;
 	}
 
+	// Conversion from other precision:
+	template <typename U>
+	explicit Matrix3x1T(const Matrix3x1T<U> &other)
+	{
+		v_[0][0] = (T)other(0, 0);
+		v_[1][0] = (T)other(1, 0);
+		v_[2][0] = (T)other(2, 0);
+	}
+
 	// -----------------------------------------------------------------------------------
 
-	double operator()(int col, int row) const
+	T operator()(int col, int row) const
 	{
 		// (unchecked)
 		return v_[col][row];
 	}
 
-	double &operator()(int col, int row)
+	T &operator()(int col, int row)
 	{
 		// (unchecked)
 		return v_[col][row];
@@ -44,7 +63,7 @@ public:
 
 	// -----------------------------------------------------------------------------------
 
-	Matrix3x1 &operator*=(double rhs)
+	Matrix3x1T &operator*=(T rhs)
 	{
 		v_[0][0] *= rhs;
 		v_[1][0] *= rhs;
@@ -57,68 +76,78 @@ public:
 
 	// -----------------------------------------------------------------------------------
 
-	const double *getPtr() const
+	const T *getPtr() const
 	{
-        return (double *)v_;
+        return (T *)v_;
 	}
 
 private:
-	double v_[3][1];
+	T v_[3][1];
 };
 
+typedef Matrix3x1T<double> Matrix3x1;
+typedef Matrix3x1T<float> Matrix3x1f;
+
 // ---------------------------------------------------------------------------------------
 
 // 3x1 + 3x1:
-inline Matrix3x1 operator+(const Matrix3x1 &lhs, const Matrix3x1 &rhs)
+template <typename T>
+inline Matrix3x1T<T> operator+(const Matrix3x1T<T> &lhs, const Matrix3x1T<T> &rhs)
 {
-	return Matrix3x1(
+	return Matrix3x1T<T>(
 		lhs(0, 0) + rhs(0,0),
 		lhs(1, 0) + rhs(1,0),
 		lhs(2, 0) + rhs(2,0));
 }
 
 // 3x1 - 3x1:
-inline Matrix3x1 operator-(const Matrix3x1 &lhs, const Matrix3x1 &rhs)
+template <typename T>
+inline Matrix3x1T<T> operator-(const Matrix3x1T<T> &lhs, const Matrix3x1T<T> &rhs)
 {
-	return Matrix3x1(
+	return Matrix3x1T<T>(
 		lhs(0, 0) - rhs(0,0),
 		lhs(1, 0) - rhs(1,0),
 		lhs(2, 0) - rhs(2,0));
 }
 
 // 3x1 .* 1x1:
-inline Matrix3x1 times(const Matrix3x1 &lhs, double rhs)
+template <typename T>
+inline Matrix3x1T<T> times(const Matrix3x1T<T> &lhs, typename Matrix3x1T<T>::Scalar rhs)
 {
-	return Matrix3x1(
+	return Matrix3x1T<T>(
 		lhs(0, 0)*rhs,
 		lhs(1, 0)*rhs,
 		lhs(2, 0)*rhs);
 }
 
-inline Matrix3x1 operator*(const Matrix3x1 &lhs, double rhs)
+template <typename T>
+inline Matrix3x1T<T> operator*(const Matrix3x1T<T> &lhs, typename Matrix3x1T<T>::Scalar rhs)
 {
 	return times(lhs, rhs);
 }
 
 // 1x1 .* 3x1:
-inline Matrix3x1 times(double lhs, const Matrix3x1 &rhs)
+template <typename T>
+inline Matrix3x1T<T> times(typename Matrix3x1T<T>::Scalar lhs, const Matrix3x1T<T> &rhs)
 {
-	return Matrix3x1(
+	return Matrix3x1T<T>(
 		lhs*rhs(0, 0),
 		lhs*rhs(1, 0),
 		lhs*rhs(2, 0));
 }
 
-inline Matrix3x1 operator*(double lhs, const Matrix3x1 &rhs)
+template <typename T>
+inline Matrix3x1T<T> operator*(typename Matrix3x1T<T>::Scalar lhs, const Matrix3x1T<T> &rhs)
 {
 	return times(lhs, rhs);
 }
 
 // 3x1 .* 3x1:
 // note: 3x1 * 3x1 is not possible
-inline Matrix3x1 times(const Matrix3x1 &lhs, const Matrix3x1 &rhs)
+template <typename T>
+inline Matrix3x1T<T> times(const Matrix3x1T<T> &lhs, const Matrix3x1T<T> &rhs)
 {
-	return Matrix3x1(
+	return Matrix3x1T<T>(
 		lhs(0, 0)*rhs(0, 0),
 		lhs(1, 0)*rhs(1, 0),
 		lhs(2, 0)*rhs(2, 0));
@@ -130,73 +159,83 @@ inline Matrix3x1 times(const Matrix3x1 &lhs, const Matrix3x1 &rhs)
 //}
 
 // 3x1 ./ 1x1:
-inline Matrix3x1 operator/(const Matrix3x1 &lhs, double rhs)
+template <typename T>
+inline Matrix3x1T<T> operator/(const Matrix3x1T<T> &lhs, typename Matrix3x1T<T>::Scalar rhs)
 {
-	return times(lhs, 1.0/rhs);
+	return times(lhs, (T)1/rhs);
 }
 
 // 3x1 . 3x1:
-inline double dot(const Matrix3x1 &lhs, const Matrix3x1 &rhs)
+template <typename T>
+inline T dot(const Matrix3x1T<T> &lhs, const Matrix3x1T<T> &rhs)
 {
 	return lhs(0, 0)*rhs(0, 0) + lhs(1, 0)*rhs(1, 0) + lhs(2, 0)*rhs(2, 0); // = sum(times(lhs, rhs))
 }
 
 // 3x1 x 3x1:
-inline Matrix3x1 cross(const Matrix3x1 &lhs, const Matrix3x1 &rhs)
+template <typename T>
+inline Matrix3x1T<T> cross(const Matrix3x1T<T> &lhs, const Matrix3x1T<T> &rhs)
 {
-	return Matrix3x1(
+	return Matrix3x1T<T>(
 		lhs(1, 0)*rhs(2, 0) - lhs(2, 0)*rhs(1, 0),
 		lhs(2, 0)*rhs(0, 0) - lhs(0, 0)*rhs(2, 0),
 		lhs(0, 0)*rhs(1, 0) - lhs(1, 0)*rhs(0, 0));
 }
 
 // sum(3x1):
-inline double sum(const Matrix3x1 &v)
+template <typename T>
+inline T sum(const Matrix3x1T<T> &v)
 {
 	return v(0, 0) + v(1, 0) + v(2, 0);
 }
 
 // 3x1^2:
-inline Matrix3x1 square(const Matrix3x1 &v)
+template <typename T>
+inline Matrix3x1T<T> square(const Matrix3x1T<T> &v)
 {
 	return times(v, v);
 }
 
 // ||3x1||:
-inline double euclidean_length(const Matrix3x1 &v)
+template <typename T>
+inline T euclidean_length(const Matrix3x1T<T> &v)
 {
-	return sqrt(sum(square(v)));
+	return std::sqrt(sum(square(v)));
 }
 
 // 3x1 ./ ||3x1||:
-inline Matrix3x1 normalize(const Matrix3x1 &v)
+template <typename T>
+inline Matrix3x1T<T> normalize(const Matrix3x1T<T> &v)
 {
-	const double m = euclidean_length(v);
-	if (m == 0.0)
+	const T m = euclidean_length(v);
+	if (m == (T)0)
 		return v;
 
-	return times(v, 1.0/m);
+	return times(v, (T)1/m);
 }
 
 // ---------------------------------------------------------------------------------------
 // ---------------------------------------------------------------------------------------
 // ---------------------------------------------------------------------------------------
 
-class Matrix3x3; // forward declaration
-Matrix3x3 operator*(const Matrix3x3 &lhs, const Matrix3x3 &rhs); // forward declaration
+template <typename T> class Matrix3x3T; // forward declaration
+template <typename T> Matrix3x3T<T> operator*(const Matrix3x3T<T> &lhs, const Matrix3x3T<T> &rhs); // forward declaration
 
-class Matrix3x3
+template <typename T>
+class Matrix3x3T
 {
 public:
-	Matrix3x3()
+	typedef T Scalar;
+
+	Matrix3x3T()
 	{
 	}
 
-	Matrix3x3
+	Matrix3x3T
 		(
-		double v00, double v01, double v02,
-		double v10, double v11, double v12,
-		double v20, double v21, double v22
+		T v00, T v01, T v02,
+		T v10, T v11, T v12,
+		T v20, T v21, T v22
 		)
 	{
 		v_[0][0] = v00; v_[0][1] = v01; v_[0][2] = v02;
@@ -204,15 +243,24 @@ public:
 		v_[2][0] = v20; v_[2][1] = v21; v_[2][2] = v22;
 	}
 
+	// Conversion from other precision:
+	template <typename U>
+	explicit Matrix3x3T(const Matrix3x3T<U> &other)
+	{
+		for (int c = 0; c < 3; ++c)
+			for (int r = 0; r < 3; ++r)
+				v_[c][r] = (T)other(c, r);
+	}
+
 	// -----------------------------------------------------------------------------------
 
-	double operator()(int col, int row) const
+	T operator()(int col, int row) const
 	{
 		// (unchecked)
 		return v_[col][row];
 	}
 
-	double &operator()(int col, int row)
+	T &operator()(int col, int row)
 	{
 		// (unchecked)
 		return v_[col][row];
@@ -220,12 +268,12 @@ public:
 
 	// -----------------------------------------------------------------------------------
 
-	Matrix3x3 &operator*=(double rhs)
+	Matrix3x3T &operator*=(T rhs)
 	{
 		v_[0][0] *= rhs; v_[0][1] *= rhs; v_[0][2] *= rhs;
 		v_[1][0] *= rhs; v_[1][1] *= rhs; v_[1][2] *= rhs;
 		v_[2][0] *= rhs; v_[2][1] *= rhs; v_[2][2] *= rhs;
-		
+
 		return *this;
 	}
 
@@ -233,109 +281,113 @@ public:
 
 	// -----------------------------------------------------------------------------------
 
-	static Matrix3x3 identity()
+	static Matrix3x3T identity()
 	{
-		return Matrix3x3(1.0, 0.0, 0.0, 
-						 0.0, 1.0, 0.0, 
-						 0.0, 0.0, 1.0);
+		return Matrix3x3T(1, 0, 0,
+						  0, 1, 0,
+						  0, 0, 1);
 	}
 
-	static Matrix3x3 rotation_matrix_x(double angleRadians)
+	static Matrix3x3T rotation_matrix_x(T angleRadians)
 	{
-		const double sr = sin(angleRadians);
-		const double cr = cos(angleRadians);
+		const T sr = std::sin(angleRadians);
+		const T cr = std::cos(angleRadians);
 
-		return Matrix3x3(
-			1.0, 0.0, 0.0,
-			0.0,  cr, -sr,
-			0.0,  sr,  cr);
+		return Matrix3x3T(
+			1,  0,   0,
+			0,  cr, -sr,
+			0,  sr,  cr);
 	}
 
-	static Matrix3x3 rotation_matrix_y(double angleRadians)
+	static Matrix3x3T rotation_matrix_y(T angleRadians)
 	{
-		const double sr = sin(angleRadians);
-		const double cr = cos(angleRadians);
+		const T sr = std::sin(angleRadians);
+		const T cr = std::cos(angleRadians);
 
-		return Matrix3x3(
-			 cr, 0.0,  sr,
-			0.0, 1.0, 0.0,
-			-sr, 0.0,  cr);
+		return Matrix3x3T(
+			 cr, 0,  sr,
+			 0,  1,  0,
+			-sr, 0,  cr);
 	}
 
-	static Matrix3x3 rotation_matrix_z(double angleRadians)
+	static Matrix3x3T rotation_matrix_z(T angleRadians)
 	{
-		const double sr = sin(angleRadians);
-		const double cr = cos(angleRadians);
-		
-		return Matrix3x3(
-			 cr, -sr, 0.0,
-			 sr,  cr, 0.0,
-			0.0, 0.0, 1.0);
+		const T sr = std::sin(angleRadians);
+		const T cr = std::cos(angleRadians);
+
+		return Matrix3x3T(
+			 cr, -sr, 0,
+			 sr,  cr, 0,
+			 0,   0,  1);
 	}
 
-	static Matrix3x3 rotation_matrix_zyx(double azimuth, double elevation, double roll)
+	// rot_z*rot_y*rot_x:
+	static Matrix3x3T rotation_matrix_zyx(T azimuth, T elevation, T roll)
 	{
-		//const double a = cos(roll);
-		//const double b = sin(roll);
-		//const double c = cos(elevation);
-		//const double d = sin(elevation);
-		//const double e = cos(azimuth);
-		//const double f = sin(azimuth);
-
-		//Matrix3x3 result(
-		//	c*e,			-c*f,			d,
-		//	b*d*e + a*f,	-b*d*f + a*e,	-b*c,
-		//	-a*d*e + b*f,	a*d*f + b*e,	a*c);
-
-		//return result;
-		// XXX: optimized algorithm doesn't seem to give the same result
+		return rotation_matrix_zyx(std::sin(azimuth), std::cos(azimuth), std::sin(elevation), std::cos(elevation), std::sin(roll), std::cos(roll));
+	}
 
-		Matrix3x3 rot_z = rotation_matrix_z(azimuth);
-		Matrix3x3 rot_y = rotation_matrix_y(elevation);
-		Matrix3x3 rot_x = rotation_matrix_x(roll);
+	// Same, from the sines and cosines of the angles. The product is expanded with its terms 
+	// in the same order (the terms with zeros dropped), so the result is identical to 
+	// (rotation_matrix_z(azimuth)*rotation_matrix_y(elevation))*rotation_matrix_x(roll).
+	// (the commented out version this replaces was for a different order of rotations)
+	static Matrix3x3T rotation_matrix_zyx(T sa, T ca, T se, T ce, T sr, T cr)
+	{
+		const T case_ = ca*se;
+		const T sase = sa*se;
 
-		return (rot_z*rot_y)*rot_x; // Note: This is default execution order of C++, but just for clarity.
+		return Matrix3x3T(
+			ca*ce,	-sa*cr + case_*sr,	 sa*sr + case_*cr,
+			sa*ce,	 ca*cr + sase*sr,	-ca*sr + sase*cr,
+			-se,	 ce*sr,				 ce*cr);
 	}
 
 	// -----------------------------------------------------------------------------------
 
-	const double *getPtr() const
+	const T *getPtr() const
 	{
-		return (double *)v_;
+		return (T *)v_;
 	}
 
 private:
-	double v_[3][3];
+	T v_[3][3];
 };
 
+typedef Matrix3x3T<double> Matrix3x3;
+typedef Matrix3x3T<float> Matrix3x3f;
+
 // ---------------------------------------------------------------------------------------
 
 // 3x3 * 3x1:
-inline Matrix3x1 mtimes(const Matrix3x3 &lhs, const Matrix3x1 &rhs)
+template <typename T>
+inline Matrix3x1T<T> mtimes(const Matrix3x3T<T> &lhs, const Matrix3x1T<T> &rhs)
 {
-	return Matrix3x1(
+	return Matrix3x1T<T>(
 		lhs(0,0)*rhs(0,0) + lhs(0,1)*rhs(1,0) + lhs(0,2)*rhs(2,0),
 		lhs(1,0)*rhs(0,0) + lhs(1,1)*rhs(1,0) + lhs(1,2)*rhs(2,0),
 		lhs(2,0)*rhs(0,0) + lhs(2,1)*rhs(1,0) + lhs(2,2)*rhs(2,0)
 		);
 }
 
-inline Matrix3x1 operator*(const Matrix3x3 &lhs, const Matrix3x1 &rhs)
+template <typename T>
+inline Matrix3x1T<T> operator*(const Matrix3x3T<T> &lhs, const Matrix3x1T<T> &rhs)
 {
 	return mtimes(lhs, rhs);
 }
 
 // 3x3 * 3x3:
-inline Matrix3x3 mtimes(const Matrix3x3 &lhs, const Matrix3x3 &rhs)
+template <typename T>
+inline Matrix3x3T<T> mtimes(const Matrix3x3T<T> &lhs, const Matrix3x3T<T> &rhs)
 {
-	return Matrix3x3(
+	return Matrix3x3T<T>(
 		lhs(0,0)*rhs(0,0) + lhs(0,1)*rhs(1,0) + lhs(0,2)*rhs(2,0),	lhs(0,0)*rhs(0,1) + lhs(0,1)*rhs(1,1) + lhs(0,2)*rhs(2,1),	lhs(0,0)*rhs(0,2) + lhs(0,1)*rhs(1,2) + lhs(0,2)*rhs(2,2),
 		lhs(1,0)*rhs(0,0) + lhs(1,1)*rhs(1,0) + lhs(1,2)*rhs(2,0),	lhs(1,0)*rhs(0,1) + lhs(1,1)*rhs(1,1) + lhs(1,2)*rhs(2,1),	lhs(1,0)*rhs(0,2) + lhs(1,1)*rhs(1,2) + lhs(1,2)*rhs(2,2),
 		lhs(2,0)*rhs(0,0) + lhs(2,1)*rhs(1,0) + lhs(2,2)*rhs(2,0),	lhs(2,0)*rhs(0,1) + lhs(2,1)*rhs(1,1) + lhs(2,2)*rhs(2,1),	lhs(2,0)*rhs(0,2) + lhs(2,1)*rhs(1,2) + lhs(2,2)*rhs(2,2)
 		);
 }
 
-inline Matrix3x3 operator*(const Matrix3x3 &lhs, const Matrix3x3 &rhs)
+template <typename T>
+inline Matrix3x3T<T> operator*(const Matrix3x3T<T> &lhs, const Matrix3x3T<T> &rhs)
 {
 	return mtimes(lhs, rhs);
 }
@@ -356,9 +408,10 @@ inline Matrix3x3 operator*(const Matrix3x3 &lhs, const Matrix3x3 &rhs)
 //}
 
 // 1/3x3:
-inline Matrix3x3 inverse(const Matrix3x3 &v)
+template <typename T>
+inline Matrix3x3T<T> inverse(const Matrix3x3T<T> &v)
 {
-	Matrix3x3 result;
+	Matrix3x3T<T> result;
 
 	result(0, 0) = v(1, 1)*v(2, 2) - v(1, 2)*v(2, 1);
 	result(1, 0) = v(1, 2)*v(2, 0) - v(1, 0)*v(2, 2);
@@ -370,33 +423,135 @@ inline Matrix3x3 inverse(const Matrix3x3 &v)
 	result(1, 2) = v(0, 2)*v(1, 0) - v(0, 0)*v(1, 2);
 	result(2, 2) = v(0, 0)*v(1, 1) - v(0, 1)*v(1, 0);
 
-	const double det = v(0, 0)*result(0, 0) + v(0, 1)*result(1, 0) + v(0, 2)*result(2, 0);
+	const T det = v(0, 0)*result(0, 0) + v(0, 1)*result(1, 0) + v(0, 2)*result(2, 0);
 
-	result *= 1.0/det;
+	result *= (T)1/det;
 
 	return result;
 }
 
+// 3x3':
+// note: this is the inverse of a rotation matrix (orthonormal), use it instead of inverse()
+template <typename T>
+inline Matrix3x3T<T> transpose(const Matrix3x3T<T> &v)
+{
+	return Matrix3x3T<T>(
+		v(0, 0), v(1, 0), v(2, 0),
+		v(0, 1), v(1, 1), v(2, 1),
+		v(0, 2), v(1, 2), v(2, 2));
+}
+
+// ---------------------------------------------------------------------------------------
+
+// Unit quaternion w + x*i + y*j + z*k of a rotation:
+template <typename T>
+struct QuaternionT
+{
+	T w;
+	T x;
+	T y;
+	T z;
+};
+
+typedef QuaternionT<double> Quaternion;
+typedef QuaternionT<float> Quaternionf;
+
+// Rotation matrix of a unit quaternion:
+template <typename T>
+inline Matrix3x3T<T> rotation_matrix(const QuaternionT<T> &q)
+{
+	return Matrix3x3T<T>(
+		1 - 2*(q.y*q.y + q.z*q.z),	2*(q.x*q.y - q.w*q.z),		2*(q.x*q.z + q.w*q.y),
+		2*(q.x*q.y + q.w*q.z),		1 - 2*(q.x*q.x + q.z*q.z),	2*(q.y*q.z - q.w*q.x),
+		2*(q.x*q.z - q.w*q.y),		2*(q.y*q.z + q.w*q.x),		1 - 2*(q.x*q.x + q.y*q.y));
+}
+
+// ---------------------------------------------------------------------------------------
+
+// Rotation matrices (as Matrix3x3T::rotation_matrix_zyx()) or quaternions of the euler 
+// angles (azimuth, elevation, roll in radians) of n sensors at once: the sines and cosines 
+// of a block of sensors are computed in a loop over contiguous arrays (which the compiler 
+// can vectorize), then the rotations are assembled from them. In place is not supported.
+enum { EULER_BLOCK_SIZE = 32 };
+
+template <typename T>
+inline void eulerZyxToRotationMatrices(const Matrix3x1T<T> *angles, int n, Matrix3x3T<T> *rotations)
+{
+	T a[3*EULER_BLOCK_SIZE], s[3*EULER_BLOCK_SIZE], c[3*EULER_BLOCK_SIZE];
+
+	for (int begin = 0; begin < n; begin += EULER_BLOCK_SIZE)
+	{
+		const int m = (n - begin < EULER_BLOCK_SIZE) ? n - begin : EULER_BLOCK_SIZE;
+		for (int i = 0; i < m; ++i)
+		{
+			a[3*i] = angles[begin + i](0, 0);
+			a[3*i + 1] = angles[begin + i](1, 0);
+			a[3*i + 2] = angles[begin + i](2, 0);
+		}
+		for (int k = 0; k < 3*m; ++k)
+		{
+			s[k] = std::sin(a[k]);
+			c[k] = std::cos(a[k]);
+		}
+		for (int i = 0; i < m; ++i)
+			rotations[begin + i] = Matrix3x3T<T>::rotation_matrix_zyx(s[3*i], c[3*i], s[3*i + 1], c[3*i + 1], s[3*i + 2], c[3*i + 2]);
+	}
+}
+
+template <typename T>
+inline void eulerZyxToQuaternions(const Matrix3x1T<T> *angles, int n, QuaternionT<T> *quaternions)
+{
+	T a[3*EULER_BLOCK_SIZE], s[3*EULER_BLOCK_SIZE], c[3*EULER_BLOCK_SIZE];
+
+	for (int begin = 0; begin < n; begin += EULER_BLOCK_SIZE)
+	{
+		const int m = (n - begin < EULER_BLOCK_SIZE) ? n - begin : EULER_BLOCK_SIZE;
+		for (int i = 0; i < m; ++i)
+		{
+			a[3*i] = angles[begin + i](0, 0);
+			a[3*i + 1] = angles[begin + i](1, 0);
+			a[3*i + 2] = angles[begin + i](2, 0);
+		}
+		for (int k = 0; k < 3*m; ++k)
+		{
+			s[k] = std::sin(a[k]*(T)0.5); // (half angles)
+			c[k] = std::cos(a[k]*(T)0.5);
+		}
+		for (int i = 0; i < m; ++i)
+		{
+			const T sa = s[3*i], ca = c[3*i], se = s[3*i + 1], ce = c[3*i + 1], sr = s[3*i + 2], cr = c[3*i + 2];
+			QuaternionT<T> &q = quaternions[begin + i];
+			q.w = ca*ce*cr + sa*se*sr;
+			q.x = ca*ce*sr - sa*se*cr;
+			q.y = ca*se*cr + sa*ce*sr;
+			q.z = sa*ce*cr - ca*se*sr;
+		}
+	}
+}
+
 // ---------------------------------------------------------------------------------------
 // ---------------------------------------------------------------------------------------
 // ---------------------------------------------------------------------------------------
 
-class Matrix4x4; // forward declaration
-Matrix4x4 operator*(const Matrix4x4 &lhs, const Matrix4x4 &rhs); // forward declaration
+template <typename T> class Matrix4x4T; // forward declaration
+template <typename T> Matrix4x4T<T> operator*(const Matrix4x4T<T> &lhs, const Matrix4x4T<T> &rhs); // forward declaration
 
-class Matrix4x4
+template <typename T>
+class Matrix4x4T
 {
 public:
-	Matrix4x4()
+	typedef T Scalar;
+
+	Matrix4x4T()
 	{
 	}
 
-	Matrix4x4
+	Matrix4x4T
 		(
-		double v00, double v01, double v02, double v03,
-		double v10, double v11, double v12, double v13,
-		double v20, double v21, double v22, double v23,
-		double v30, double v31, double v32, double v33
+		T v00, T v01, T v02, T v03,
+		T v10, T v11, T v12, T v13,
+		T v20, T v21, T v22, T v23,
+		T v30, T v31, T v32, T v33
 		)
 	{
 		v_[0][0] = v00; v_[0][1] = v01; v_[0][2] = v02; v_[0][3] = v03;
@@ -407,13 +562,13 @@ public:
 
 	// -----------------------------------------------------------------------------------
 
-	double operator()(int col, int row) const
+	T operator()(int col, int row) const
 	{
 		// (unchecked)
 		return v_[col][row];
 	}
 
-	double &operator()(int col, int row)
+	T &operator()(int col, int row)
 	{
 		// (unchecked)
 		return v_[col][row];
@@ -421,96 +576,102 @@ public:
 
 	// -----------------------------------------------------------------------------------
 
-	static Matrix4x4 identity_matrix()
+	static Matrix4x4T identity_matrix()
 	{
-		return Matrix4x4(1.0, 0.0, 0.0, 0.0, 
-						 0.0, 1.0, 0.0, 0.0, 
-						 0.0, 0.0, 1.0, 0.0, 
-						 0.0, 0.0, 0.0, 1.0);
+		return Matrix4x4T(1, 0, 0, 0,
+						  0, 1, 0, 0,
+						  0, 0, 1, 0,
+						  0, 0, 0, 1);
 	}
 
-	static Matrix4x4 translation_matrix(double x, double y, double z)
+	static Matrix4x4T translation_matrix(T x, T y, T z)
 	{
-		return Matrix4x4(1.0, 0.0, 0.0, x, 
-						 0.0, 1.0, 0.0, y, 
-						 0.0, 0.0, 1.0, z, 
-						 0.0, 0.0, 0.0, 1.0);
+		return Matrix4x4T(1, 0, 0, x,
+						  0, 1, 0, y,
+						  0, 0, 1, z,
+						  0, 0, 0, 1);
 	}
 
-	static Matrix4x4 rotation_matrix_x(double angleRadians)
+	static Matrix4x4T rotation_matrix_x(T angleRadians)
 	{
-		const double cr = cos(angleRadians);
-		const double sr = sin(angleRadians);
+		const T cr = std::cos(angleRadians);
+		const T sr = std::sin(angleRadians);
 
-		return Matrix4x4(1.0, 0.0, 0.0, 0.0, 
-						 0.0,  cr, -sr, 0.0, 
-						 0.0,  sr,  cr, 0.0, 
-						 0.0, 0.0, 0.0, 1.0);
+		return Matrix4x4T(1, 0,   0,  0,
+						  0, cr, -sr, 0,
+						  0, sr,  cr, 0,
+						  0, 0,   0,  1);
 	}
 
-	static Matrix4x4 rotation_matrix_y(double angleRadians)
+	static Matrix4x4T rotation_matrix_y(T angleRadians)
 	{
-		const double cr = cos(angleRadians);
-		const double sr = sin(angleRadians);
+		const T cr = std::cos(angleRadians);
+		const T sr = std::sin(angleRadians);
 
-		return Matrix4x4( cr, 0.0,  sr, 0.0, 
-						 0.0, 1.0, 0.0, 0.0, 
-						 -sr, 0.0,  cr, 0.0, 
-						 0.0, 0.0, 0.0, 1.0);
+		return Matrix4x4T( cr, 0, sr, 0,
+						   0,  1, 0,  0,
+						  -sr, 0, cr, 0,
+						   0,  0, 0,  1);
 	}
 
-	static Matrix4x4 rotation_matrix_z(double angleRadians)
+	static Matrix4x4T rotation_matrix_z(T angleRadians)
 	{
-		const double cr = cos(angleRadians);
-		const double sr = sin(angleRadians);
+		const T cr = std::cos(angleRadians);
+		const T sr = std::sin(angleRadians);
 
-		return Matrix4x4( cr, -sr, 0.0, 0.0, 
-						  sr,  cr, 0.0, 0.0, 
-						 0.0, 0.0, 1.0, 0.0, 
-						 0.0, 0.0, 0.0, 1.0);
+		return Matrix4x4T(cr, -sr, 0, 0,
+						  sr,  cr, 0, 0,
+						  0,   0,  1, 0,
+						  0,   0,  0, 1);
 	}
 
-	static Matrix4x4 rotation_matrix_zyx(double azimuth, double elevation, double roll)
+	static Matrix4x4T rotation_matrix_zyx(T azimuth, T elevation, T roll)
 	{
-		Matrix4x4 rot_z = rotation_matrix_z(azimuth);
-		Matrix4x4 rot_y = rotation_matrix_y(elevation);
-		Matrix4x4 rot_x = rotation_matrix_x(roll);
+		Matrix4x4T rot_z = rotation_matrix_z(azimuth);
+		Matrix4x4T rot_y = rotation_matrix_y(elevation);
+		Matrix4x4T rot_x = rotation_matrix_x(roll);
 
 		return (rot_z*rot_y)*rot_x; // Note: This is default execution order of C++, but just for clarity.
 	}
 
 	// -----------------------------------------------------------------------------------
 
-	const double *getPtr() const
+	const T *getPtr() const
 	{
-		return (double *)v_;
+		return (T *)v_;
 	}
 
 private:
-	double v_[4][4];
+	T v_[4][4];
 };
 
+typedef Matrix4x4T<double> Matrix4x4;
+typedef Matrix4x4T<float> Matrix4x4f;
+
 // ---------------------------------------------------------------------------------------
 
 // 4x4 * 3x1:
-inline Matrix3x1 mtimes(const Matrix4x4 &lhs, const Matrix3x1 &rhs)
+template <typename T>
+inline Matrix3x1T<T> mtimes(const Matrix4x4T<T> &lhs, const Matrix3x1T<T> &rhs)
 {
-	Matrix3x1 result;
+	Matrix3x1T<T> result;
 	result(0, 0) = lhs(0, 0)*rhs(0, 0) + lhs(0, 1)*rhs(1, 0) + lhs(0, 2)*rhs(2, 0) + lhs(0, 3);
 	result(1, 0) = lhs(1, 0)*rhs(0, 0) + lhs(1, 1)*rhs(1, 0) + lhs(1, 2)*rhs(2, 0) + lhs(1, 3);
 	result(2, 0) = lhs(2, 0)*rhs(0, 0) + lhs(2, 1)*rhs(1, 0) + lhs(2, 2)*rhs(2, 0) + lhs(2, 3);
 	return result;
 }
 
-inline Matrix3x1 operator*(const Matrix4x4 &lhs, const Matrix3x1 &rhs)
+template <typename T>
+inline Matrix3x1T<T> operator*(const Matrix4x4T<T> &lhs, const Matrix3x1T<T> &rhs)
 {
 	return mtimes(lhs, rhs);
 }
 
 // 4x4 * 4x4:
-inline Matrix4x4 mtimes(const Matrix4x4 &lhs, const Matrix4x4 &rhs)
+template <typename T>
+inline Matrix4x4T<T> mtimes(const Matrix4x4T<T> &lhs, const Matrix4x4T<T> &rhs)
 {
-	Matrix4x4 result;
+	Matrix4x4T<T> result;
 	for (int r = 0; r < 4; ++r)
 	{
 		for (int c = 0; c < 4; ++c)
@@ -522,16 +683,10 @@ inline Matrix4x4 mtimes(const Matrix4x4 &lhs, const Matrix4x4 &rhs)
 	return result;
 }
 
-inline Matrix4x4 operator*(const Matrix4x4 &lhs, const Matrix4x4 &rhs)
+template <typename T>
+inline Matrix4x4T<T> operator*(const Matrix4x4T<T> &lhs, const Matrix4x4T<T> &rhs)
 {
 	return mtimes(lhs, rhs);
 }
 
 #endif
-
-
-
-
-
-
-
@@ -35,4 +35,8 @@
 // For debugging purposes.
 #define DISABLE_SENDING_DATA 0		// default = 0
 
+// Arduino frame checksum: CRC32 of the payload (see Crc32.hxx) instead of XOR of the 
+// payload bytes (must match the Arduino firmware).
+#define ARDUINO_CRC32_CHECKSUM 0	// default = 0
+
 #endif
\ No newline at end of file
@@ -13,7 +13,7 @@
 #include "AsynchFileWriter.hxx"
 #include "FileWriters.hxx"
 #include "Exceptions.hxx"
-//l2 #include "Crc32.hxx"
+#include "Crc32.hxx"
 
 #include "concat/FileFormats/HeaderAndMetronomeFile.hxx"
 
@@ -120,7 +120,9 @@ ViolinRecordingPlugInEffect::ViolinRecordingPlugInEffect()
 #endif
 
 	comPortReadBuffer_.attach(comPort_, VALID_ARDUINO_FRAMES_BUFFER_SIZE);
-//l2	computeCrc32Table(crcTable256_, 0x04c11db7);
+#if (ARDUINO_CRC32_CHECKSUM != 0)
+	computeCrc32Tables8(crcTables8_, 0x04c11db7);
+#endif
 
 	// (only using lastTrackerFrameInterp_ after filling it)
 
@@ -585,12 +587,21 @@ int ViolinRecordingPlugInEffect::getArduinoDataFromSerialPort(ComPortReadBuffer
 		if (beginBufferArduino[i] == 0xff)
 		{
 			// Compute checksum of payload:
+#if (ARDUINO_CRC32_CHECKSUM != 0)
+			concat::byte payload[16];
+			assert(arduinoPayloadSizeBytes <= 16);
+			for (int k = 0; k < arduinoPayloadSizeBytes; ++k)
+			{
+				payload[k] = beginBufferArduino[i+1+k]; // (may wrap if the buffer isn't mirrored)
+			}
+			const uint32_t computePayloadChecksum = computeCrc32Sliced8(crcTables8_, payload, arduinoPayloadSizeBytes);
+#else
 			uint32_t computePayloadChecksum = 0;
 			for (int k = 0; k < arduinoPayloadSizeBytes; ++k)
 			{
 				computePayloadChecksum ^= beginBufferArduino[i+1+k];
 			}
-//l2		const uint32_t computePayloadChecksum = computeCrc32(crcTable256_, beginBufferArduino.getPtrAt(i+1), arduinoPayloadSizeBytes);
+#endif
 
 			const uint32_t referencePayloadChecksum = beginBufferArduino.getUint32At(i+1+arduinoPayloadSizeBytes);
 //l2		const uint32_t referencePayloadChecksum = beginBufferArduino.getUint32At(i+1+arduinoPayloadSizeBytes);
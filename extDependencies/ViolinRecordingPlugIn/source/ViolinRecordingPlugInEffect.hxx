@@ -373,7 +373,9 @@ private:
 	ArduinoFrame validArduinoFrames_[VALID_ARDUINO_FRAMES_BUFFER_SIZE];
 	int numValidArduinoFrames_;
 	int numArduinoBytesSkipped_; // for log only
-//l2	concat::uint32_t crcTable256_[256];
+#if (ARDUINO_CRC32_CHECKSUM != 0)
+	concat::uint32_t crcTables8_[8*256]; // (see computeCrc32Sliced8())
+#endif
 
 	// Arduino frame count continuity:
 	unsigned int lastArduinoFrameCountCheckContinuity_; // for testing if any frames were dropped (for logging)
@@ -3,6 +3,8 @@
 
 #include <vector>
 #include <cfloat>
+#include <cmath>
+#include <algorithm>
 
 // break point function
 //
@@ -11,23 +13,50 @@
 // 
 // when calculating the surface, this will be also applied
 //
+// get() doesn't modify the BPF, so a BPF that is no longer added to can be shared between
+// threads. It uses a binary search for the segment of x, or, after compile(), a lookup
+// grid which makes it O(1) (same result).
+//
 class BPF
 {
 	private:
+		enum { MAX_GRID_SIZE = 4096 };
+
 		std::vector<double> xpoints;
 		std::vector<double> ypoints;
 		std::vector<double> slopes;
-		int search;
 		double _yMin, _yMax;
+
+		// lookup grid (see compile): gridSegments[c] is segmentIdx() of the start of cell c
+		std::vector<int> gridSegments;
+		double gridScale; // cells per x unit
+
+		// index of the first x point after x (+ DBL_EPSILON), xpoints.size() if none
+		int segmentIdx(double x) const
+		{
+			if (gridSegments.empty())
+				return std::upper_bound(xpoints.begin(), xpoints.end(), x + DBL_EPSILON) - xpoints.begin();
+
+			int i = 0;
+			if (x >= xpoints[0])
+			{
+				int c = int((x - xpoints[0])*gridScale);
+				if (c >= int(gridSegments.size())) c = gridSegments.size() - 1;
+				i = gridSegments[c];
+			}
+			while (i < int(xpoints.size()) && x + DBL_EPSILON >= xpoints[i]) i++;
+			return i;
+		}
 	public:
 		BPF()
-		:search(0)
+		:gridScale(0.)
 		{
 		}
-		double yMin() { return _yMin; }
-		double yMax() { return _yMax; }
+		double yMin() const { return _yMin; }
+		double yMax() const { return _yMax; }
 		void add(double x,double y)
 		{
+			gridSegments.clear(); // (compile again)
 			if (!xpoints.empty())
 			{
 				if (x < xpoints.back()) throw "BPF x values should be consecutive";
@@ -48,7 +77,7 @@ class BPF
 			xpoints.push_back(x);
 			ypoints.push_back(y);
 		}
-		int size(void)
+		int size(void) const
 		{
 			return xpoints.size();
 		}
@@ -117,14 +146,46 @@ class BPF
 			//printf(" surface = %f\n",s);
 			return s;
 		}
-		double get(double x)
+		// Builds the lookup grid used by get(), with cells no wider than the narrowest
+		// segment (up to MAX_GRID_SIZE cells), so finding the segment of x takes at most a
+		// step or two from the segment of its cell, for regular and irregular x points.
+		void compile()
+		{
+			gridSegments.clear();
+			if (xpoints.size() < 2 || xpoints.back() <= xpoints[0]) return;
+
+			const double range = xpoints.back() - xpoints[0];
+			double minWidth = range;
+			for (size_t i = 1; i < xpoints.size(); i++)
+			{
+				const double width = xpoints[i] - xpoints[i-1];
+				if (width > 0. && width < minWidth) minWidth = width;
+			}
+			const int numCells = std::min(int(std::ceil(range/minWidth)), int(MAX_GRID_SIZE));
+			gridScale = numCells/range;
+
+			std::vector<int> segments(numCells);
+			for (int c = 0; c < numCells; c++)
+				segments[c] = std::upper_bound(xpoints.begin(), xpoints.end(), xpoints[0] + c/gridScale + DBL_EPSILON) - xpoints.begin();
+			gridSegments.swap(segments);
+		}
+		bool isCompiled() const
+		{
+			return !gridSegments.empty();
+		}
+		double get(double x) const
 		{
-			if (x < xpoints[search]) search = 0;
 			if (x >= xpoints.back()) return ypoints.back();
-			while (x + DBL_EPSILON >= xpoints[search]) search++;
-			if (search==0) return ypoints[0];
-			search--;
-		  return (x - xpoints[search]) * slopes[search] + ypoints[search];
+			int i = segmentIdx(x);
+			if (i==0) return ypoints[0];
+			if (i==int(xpoints.size())) return ypoints.back(); // (within DBL_EPSILON of the last x)
+			i--;
+			return (x - xpoints[i]) * slopes[i] + ypoints[i];
+		}
+		void get(const double *x, double *y, int n) const
+		{
+			for (int k = 0; k < n; k++)
+				y[k] = get(x[k]);
 		}
 };
 
@@ -5,76 +5,156 @@
 using namespace std;
 
 
+// different frame rate --> 44100/256.=172.265625 vs 240Hz
+//float trackerFR = 240.f; // tracker frame rate
+//float synthFR = 44100.f / 256.f; // synthesis frame rate
+//l = floorf(l * synthFR / trackerFR + .5f);
+//r = floorf(r * synthFR / trackerFR + .5f);
+//d = (int) floorf(d * synthFR / trackerFR + .5f);
+static const int l = DerivativeStream::NEAR_FRAME; // at 240Hz
+static const int r = DerivativeStream::FAR_FRAME; // at 240Hz
+static const int d = SecondDerivativeStream::SPAN; // at 240Hz
+
+static inline int clampIdx(int idx, int nValues)
+{
+	return MIN(MAX(idx, 0), nValues-1);
+}
+
+float computeDerivativeAt(const float *values, int nValues, int frameIdx)
+{
+	float meanr = 0.f;
+	for(int k=l; k<=r; k++)
+		meanr += values[clampIdx(frameIdx+k, nValues)];
+	float meanl = 0.f;
+	for(int k=l; k<=r; k++)
+		meanl += values[clampIdx(frameIdx-k, nValues)];
+	meanr /= float(r-l+1.f);
+	meanl /= float(r-l+1.f);
+	return meanr - meanl;
+}
+
+float computeSecondDerivativeAt(const float *values, int nValues, int frameIdx)
+{
+	return values[clampIdx(frameIdx+d, nValues)] - values[clampIdx(frameIdx-d, nValues)];
+}
+
+void computeDerivative(const float *values, int nValues, float *derivative)
+{
+	// edges (windows clamped):
+	const int interiorBegin=MIN(r, nValues);
+	const int interiorEnd=MAX(nValues-r, interiorBegin);
+	for(int frameIdx=0;frameIdx<interiorBegin;frameIdx++)
+		derivative[frameIdx]=computeDerivativeAt(values, nValues, frameIdx);
+	for(int frameIdx=interiorEnd;frameIdx<nValues;frameIdx++)
+		derivative[frameIdx]=computeDerivativeAt(values, nValues, frameIdx);
+
+	// interior (frames are independent, inner loop has a constant trip count):
+	const float scale=1.f/float(r-l+1.f);
+	for(int frameIdx=interiorBegin;frameIdx<interiorEnd;frameIdx++)
+	{
+		float sum = 0.f;
+		for(int k=l; k<=r; k++)
+			sum += values[frameIdx+k] - values[frameIdx-k];
+		derivative[frameIdx]=sum*scale;
+	}
+}
+
+void computeSecondDerivative(const float *values, int nValues, float *derivative)
+{
+	const int interiorBegin=MIN(d, nValues);
+	const int interiorEnd=MAX(nValues-d, interiorBegin);
+	for(int frameIdx=0;frameIdx<interiorBegin;frameIdx++)
+		derivative[frameIdx]=computeSecondDerivativeAt(values, nValues, frameIdx);
+	for(int frameIdx=interiorEnd;frameIdx<nValues;frameIdx++)
+		derivative[frameIdx]=computeSecondDerivativeAt(values, nValues, frameIdx);
+
+	for(int frameIdx=interiorBegin;frameIdx<interiorEnd;frameIdx++)
+		derivative[frameIdx]=values[frameIdx+d] - values[frameIdx-d];
+}
+
 float *computeDerivative(float *values, int nValues, int inframe)
 {
 	float *derivative=new float[nValues];
-	// compute first derivative
-	int minFrame, maxFrame;
 	if (inframe>=0)
-	{	minFrame=inframe;
-		maxFrame=inframe+1;
-	}
+		derivative[inframe]=computeDerivativeAt(values, nValues, inframe);
 	else
-	{
-		minFrame=0;
-		maxFrame=nValues;
-	}
-	for(int frameIdx=minFrame;frameIdx<maxFrame;frameIdx++)
-	{
-		int k;
-		float meanr = 0.f;
-		// different frame rate --> 44100/256.=172.265625 vs 240Hz
-		int l = 2; // at 240Hz
-		int r = 7; // at 240Hz
-		int aux;
-		//float trackerFR = 240.f; // tracker frame rate
-		//float synthFR = 44100.f / 256.f; // synthesis frame rate
-		//l = floorf(l * synthFR / trackerFR + .5f);
-		//r = floorf(r * synthFR / trackerFR + .5f);
-		for(k=l; k<=r; k++)
-		{	aux=min(k,nValues);
-			meanr += values[ frameIdx + aux];
-		}
-		float meanl = 0.f;
-		for(k=-l; k>=-r; k--)
-		{	aux=max(k,0);
-			meanl += values[ frameIdx + aux];
-		}
-		meanr /= float(r-l+1.f);
-		meanl /= float(r-l+1.f);
-		derivative[frameIdx]= meanr - meanl;
-	}
-
+		computeDerivative(values, nValues, derivative);
 	return derivative;
 }
 
 float *computeSecondDerivative(float *values, int nValues, int inframe)
-{// compute second derivative
+{
 	float *derivative=new float[nValues];
-	int d=3;
-	int minFrame, maxFrame;
 	if (inframe>=0)
-	{	minFrame=inframe;
-		maxFrame=inframe+1;
-	}
+		derivative[inframe]=computeSecondDerivativeAt(values, nValues, inframe);
 	else
+		computeSecondDerivative(values, nValues, derivative);
+	return derivative;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void DerivativeStream::reset()
+{
+	for (int i=0;i<HISTORY_SIZE;i++)
+		history_[i]=0.f;
+	numPushed_=0;
+	sumRight_=0.0;
+	sumLeft_=0.0;
+}
+
+bool DerivativeStream::push(float value, float *derivative)
+{
+	if (numPushed_==0)
 	{
-		minFrame=0;
-		maxFrame=nValues;
-	}
-	for(int frameIdx=minFrame;frameIdx<maxFrame;frameIdx++)
-	{ 
-		//int d = 4; // at 240 Hz
-		//float trackerFR = 240.f; // tracker frame rate
-		//float synthFR = 44100.f / 256.f; // synthesis frame rate
-		//d = (int) floorf(d * synthFR / trackerFR + .5f);
-		
-		int b=frameIdx-d;
-		int e=frameIdx+d;
-		if(b<0) b=0;
-		if(e>=nValues)e=nValues-1;
-		derivative[frameIdx] = values[e] - values[b];
+		// frames before the first one are equal to it:
+		for (int i=0;i<HISTORY_SIZE;i++)
+			history_[i]=value;
+		sumRight_=(r-l+1)*(double)value;
+		sumLeft_=sumRight_;
 	}
-	return derivative;
+
+	// newest frame m enters the right window (m-r+l-1 leaves), for the frame DELAY back the
+	// left window is m-2r..m-r-l (m-r-l enters, m-2r-1 leaves):
+	const int m=numPushed_;
+	const int mask=HISTORY_SIZE-1;
+	sumRight_+=value-history_[(m-(r-l+1))&mask];
+	sumLeft_+=history_[(m-r-l)&mask]-history_[(m-2*r-1)&mask];
+	history_[m&mask]=value;
+	numPushed_++;
+	if (numPushed_>=DELAY+HISTORY_SIZE)
+		numPushed_-=HISTORY_SIZE; // (same ring positions, never overflows)
+
+	if (m<DELAY)
+		return false;
+	*derivative=(float)((sumRight_-sumLeft_)/(r-l+1));
+	return true;
+}
+
+void SecondDerivativeStream::reset()
+{
+	for (int i=0;i<HISTORY_SIZE;i++)
+		history_[i]=0.f;
+	numPushed_=0;
 }
 
+bool SecondDerivativeStream::push(float value, float *derivative)
+{
+	if (numPushed_==0)
+	{
+		for (int i=0;i<HISTORY_SIZE;i++)
+			history_[i]=value;
+	}
+
+	const int m=numPushed_;
+	const int mask=HISTORY_SIZE-1;
+	history_[m&mask]=value;
+	numPushed_++;
+	if (numPushed_>=DELAY+HISTORY_SIZE)
+		numPushed_-=HISTORY_SIZE; // (same ring positions, never overflows)
+
+	if (m<DELAY)
+		return false;
+	*derivative=value-history_[(m-2*d)&mask];
+	return true;
+}
@@ -4,7 +4,63 @@
 #define MIN(a,b) ((a)<(b)?(a):(b))
 #define MAX(a,b) ((a)<(b)?(b):(a))
 
+// Frame derivatives of descriptor sequences at 240 Hz (not scaled by the frame rate):
+// - derivative: mean of values[n+2..n+7] minus mean of values[n-7..n-2]
+// - second derivative: values[n+3] - values[n-3] (usually of the derivative)
+// Indices outside the sequence are clamped to its first/last value.
+
+// Whole sequence, into a caller-provided buffer of nValues (must not overlap values). The
+// interior (all but the first and last few frames) is a fixed-length loop the compiler
+// can vectorize, for long recorded sequences.
+void computeDerivative(const float *values, int nValues, float *derivative);
+void computeSecondDerivative(const float *values, int nValues, float *derivative);
+
+// Single frame:
+float computeDerivativeAt(const float *values, int nValues, int frameIdx);
+float computeSecondDerivativeAt(const float *values, int nValues, int frameIdx);
+
+// (old interface: allocates a new[] array of nValues, of which only element inframe is set
+// if inframe >= 0, else all)
 float *computeDerivative(float *values, int nValues, int inframe);
 float *computeSecondDerivative(float *values, int nValues, int inframe);
 
-#endif 
\ No newline at end of file
+// Streaming versions for real-time use: one value is pushed per frame and, as the windows
+// look ahead, the result for a frame is available DELAY frames later (push() returns false
+// until then). Window sums are updated as frames enter and leave them, so a frame costs the
+// same regardless of window length. Frames before the first are taken equal to it, as in
+// the whole sequence version (the end of a stream is not known, so it isn't clamped).
+class DerivativeStream
+{
+public:
+	enum { NEAR_FRAME = 2, FAR_FRAME = 7, DELAY = FAR_FRAME };
+
+	DerivativeStream() { reset(); }
+	void reset();
+	bool push(float value, float *derivative); // derivative of frame pushed DELAY frames ago
+
+private:
+	enum { HISTORY_SIZE = 16 }; // (power of two > 2*FAR_FRAME)
+
+	float history_[HISTORY_SIZE];
+	int numPushed_;
+	double sumRight_; // of the newest FAR_FRAME-NEAR_FRAME+1 values
+	double sumLeft_; // of the values at 2*FAR_FRAME..FAR_FRAME+NEAR_FRAME frames back
+};
+
+class SecondDerivativeStream
+{
+public:
+	enum { SPAN = 3, DELAY = SPAN };
+
+	SecondDerivativeStream() { reset(); }
+	void reset();
+	bool push(float value, float *derivative); // second derivative of frame pushed DELAY frames ago
+
+private:
+	enum { HISTORY_SIZE = 8 }; // (power of two > 2*SPAN)
+
+	float history_[HISTORY_SIZE];
+	int numPushed_;
+};
+
+#endif